@@ -1,11 +1,27 @@
 #!/bin/bash
 # ══════════════════════════════════════════════════
 #  PRIMUS AI — Database Loader
-#  Usage: bash load_db.sh
+#  Usage: bash load_db.sh [--fresh]
+#
+#  With primus_ingest built, the SQL is upserted into the
+#  existing database: only new and changed entries are written
+#  and the assistant can keep running. --fresh (or no
+#  primus_ingest) builds a new database beside it and renames
+#  it into place. A running assistant picks up either within
+#  --reload-ms (or at once on SIGHUP).
 # ══════════════════════════════════════════════════
 
 DB="/home/pi/primus/ml/knowledge.db"
 SQL="/home/pi/primus/ml/seed_knowledge_v3.sql"
+# Optional answer pre-rendering (needs espeak-ng + primus_prerender);
+# PRERENDER_LIMIT=0 renders every answer
+PRERENDER="/home/pi/primus/AI/primus_prerender"
+AUDIO="$(dirname "$DB")/answer_audio.bin"
+PRERENDER_LIMIT="${PRERENDER_LIMIT:-500}"
+# Compiled keyword index, mapped at startup instead of scanning the table
+SNAPSHOT="/home/pi/primus/AI/primus_snapshot"
+SNAP="$(dirname "$DB")/knowledge.snap"
+INGEST="/home/pi/primus/AI/primus_ingest"
 
 echo "══════════════════════════════════════════════════"
 echo "  📚 PRIMUS AI — Database Loader v3.0"
@@ -17,11 +33,19 @@ if [ -f "$DB" ]; then
     echo "✅ Old DB backed up to knowledge.db.bak"
 fi
 
-# Drop and recreate
-rm -f "$DB"
-echo "🔨 Creating fresh database..."
+if [ -x "$INGEST" ] && [ "$1" != "--fresh" ]; then
+    # FTS follows the changed rows through its triggers; PRAGMA
+    # optimize refreshes the planner statistics
+    echo "📥 Upserting entries..."
+    "$INGEST" "$DB" "$SQL" || exit 1
+else
+    # Build beside the live file so a running assistant never sees
+    # it half loaded
+    NEW="${DB}.new"
+    rm -f "$NEW" "$NEW-wal" "$NEW-shm"
+    echo "🔨 Creating fresh database..."
 
-sqlite3 "$DB" << 'SQL'
+    sqlite3 "$NEW" << 'SQL'
 PRAGMA encoding = "UTF-8";
 PRAGMA journal_mode = WAL;
 PRAGMA synchronous = NORMAL;
@@ -40,11 +64,51 @@ CREATE INDEX idx_category ON knowledge(category);
 CREATE INDEX idx_cat_q    ON knowledge(category, question);
 SQL
 
-echo "📥 Loading entries..."
-sqlite3 "$DB" < "$SQL"
+    echo "📥 Loading entries..."
+    sqlite3 "$NEW" < "$SQL"
 
-echo "⚡ Optimizing..."
-sqlite3 "$DB" "ANALYZE; VACUUM;"
+    echo "🔎 Building FTS5 index..."
+    # M* keeps Devanagari matras/virama inside tokens (must match hindi_ai.cpp)
+    sqlite3 "$NEW" << 'SQL'
+CREATE VIRTUAL TABLE IF NOT EXISTS knowledge_fts
+USING fts5(question, answer, category, content='knowledge', content_rowid='id',
+           tokenize="unicode61 remove_diacritics 0 categories 'L* N* Co M*'");
+
+CREATE TRIGGER IF NOT EXISTS knowledge_fts_ai AFTER INSERT ON knowledge BEGIN
+    INSERT INTO knowledge_fts(rowid, question, answer, category)
+    VALUES (new.id, new.question, new.answer, new.category);
+END;
+CREATE TRIGGER IF NOT EXISTS knowledge_fts_ad AFTER DELETE ON knowledge BEGIN
+    INSERT INTO knowledge_fts(knowledge_fts, rowid, question, answer, category)
+    VALUES ('delete', old.id, old.question, old.answer, old.category);
+END;
+CREATE TRIGGER IF NOT EXISTS knowledge_fts_au AFTER UPDATE ON knowledge BEGIN
+    INSERT INTO knowledge_fts(knowledge_fts, rowid, question, answer, category)
+    VALUES ('delete', old.id, old.question, old.answer, old.category);
+    INSERT INTO knowledge_fts(rowid, question, answer, category)
+    VALUES (new.id, new.question, new.answer, new.category);
+END;
+
+INSERT INTO knowledge_fts(knowledge_fts) VALUES('rebuild');
+INSERT INTO knowledge_fts(knowledge_fts) VALUES('optimize');
+SQL
+
+    echo "⚡ Optimizing..."
+    sqlite3 "$NEW" "ANALYZE; VACUUM; PRAGMA wal_checkpoint(TRUNCATE);" > /dev/null
+    rm -f "$NEW-wal" "$NEW-shm"
+
+    # The live file's -wal and -shm stay: the assistant is reading
+    # through them. Its log is folded into it and emptied instead, as
+    # the new file will be opened beside the same -wal and must find
+    # nothing there to replay
+    if [ -f "$DB" ] && ! sqlite3 "$DB" ".timeout 5000" "PRAGMA wal_checkpoint(TRUNCATE);" | grep -q '^0|'; then
+        echo "❌ $DB stayed busy, the fresh database is left at $NEW"
+        exit 1
+    fi
+    # One rename in the same directory: the assistant sees a new inode
+    # and reloads
+    mv -f "$NEW" "$DB"
+fi
 
 COUNT=$(sqlite3 "$DB" "SELECT COUNT(*) FROM knowledge;")
 echo ""
@@ -52,3 +116,15 @@ echo "════════════════════════
 echo "  ✅ Done! $COUNT entries loaded"
 echo "══════════════════════════════════════════════════"
 sqlite3 "$DB" "SELECT category, COUNT(*) as n FROM knowledge GROUP BY category ORDER BY n DESC;"
+
+if [ -x "$SNAPSHOT" ]; then
+    echo ""
+    echo "🗜️  Compiling knowledge snapshot..."
+    "$SNAPSHOT" "$DB" "$SNAP"
+fi
+
+if [ -x "$PRERENDER" ] && command -v espeak-ng >/dev/null; then
+    echo ""
+    echo "🔊 Pre-rendering answer audio..."
+    "$PRERENDER" "$DB" "$AUDIO" --adpcm --limit "$PRERENDER_LIMIT" -j "$(nproc)"
+fi
@@ -0,0 +1,123 @@
+#!/usr/bin/env python3
+"""
+PRIMUS AI v2.0 — IPC client
+Talks to `hindi_ai --serve SOCKET` (frame layout: src/ipc.h)
+
+    python3 primus_ipc.py "भारत की राजधानी क्या है"
+    python3 primus_ipc.py --speak "नमस्ते"
+    python3 primus_ipc.py --session kitchen "मोदी कौन हैं" "उनकी पार्टी"
+    echo "मदद" | python3 primus_ipc.py -
+"""
+
+import socket
+import struct
+import sys
+import time
+from collections import namedtuple
+
+DEFAULT_SOCKET = "/tmp/primus_ai.sock"
+
+MAGIC  = 0x31515250            # "PRQ1"
+# length, magic, type, flags, id, answerId, 3x timing, sessionLen, reserved
+HEADER = struct.Struct("<IIHHQqIIIHH")
+QUERY, REPLY, ERROR = 1, 2, 3
+SPEAK  = 1
+
+Reply = namedtuple("Reply", "id text answer_id queue_us compute_us total_us session")
+
+
+class PrimusClient:
+    def __init__(self, path=DEFAULT_SOCKET, wait=0.0):
+        """Connects to a running server; retries for up to `wait` seconds
+        so a freshly started server has time to load its database."""
+        deadline = time.monotonic() + wait
+        while True:
+            try:
+                self.sock = socket.socket(socket.AF_UNIX, socket.SOCK_STREAM)
+                self.sock.connect(path)
+                break
+            except (FileNotFoundError, ConnectionRefusedError):
+                self.sock.close()
+                if time.monotonic() >= deadline:
+                    raise
+                time.sleep(0.1)
+        self.next_id = 1
+
+    def close(self):
+        self.sock.close()
+
+    def send(self, text, speak=False, session=""):
+        """Queues a query without waiting; returns its request id.
+        Queries with the same session share conversation context
+        (pronouns, follow-ups); "" = one context per connection."""
+        rid  = self.next_id
+        self.next_id += 1
+        sid  = session.encode("utf-8")
+        body = sid + text.encode("utf-8")
+        self.sock.sendall(HEADER.pack(HEADER.size - 4 + len(body), MAGIC, QUERY,
+                                      SPEAK if speak else 0, rid, -1, 0, 0, 0,
+                                      len(sid), 0) + body)
+        return rid
+
+    def receive(self):
+        head = self._read(HEADER.size)
+        (length, magic, mtype, _, rid, answer_id,
+         q_us, c_us, t_us, sid_len, _) = HEADER.unpack(head)
+        if magic != MAGIC:
+            raise ConnectionError("not a PRIMUS server")
+        body = self._read(length - (HEADER.size - 4))
+        sid  = body[:sid_len].decode("utf-8", "replace")
+        text = body[sid_len:].decode("utf-8", "replace")
+        if mtype == ERROR:
+            raise RuntimeError(text)
+        return Reply(rid, text, answer_id, q_us, c_us, t_us, sid)
+
+    def ask(self, text, speak=False, session=""):
+        rid = self.send(text, speak, session)
+        reply = self.receive()
+        if reply.id != rid:
+            raise ConnectionError(f"reply {reply.id} for request {rid}")
+        return reply
+
+    def _read(self, n):
+        buf = bytearray()
+        while len(buf) < n:
+            chunk = self.sock.recv(n - len(buf))
+            if not chunk:
+                raise ConnectionError("server closed the connection")
+            buf += chunk
+        return bytes(buf)
+
+
+def main(argv):
+    path, speak, session, queries = DEFAULT_SOCKET, False, "", []
+    args = iter(argv)
+    for a in args:
+        if a == "--socket":
+            path = next(args)
+        elif a == "--session":
+            session = next(args)
+        elif a == "--speak":
+            speak = True
+        elif a == "-":
+            queries += [l.strip() for l in sys.stdin if l.strip()]
+        else:
+            queries.append(a)
+    if not queries:
+        print(__doc__.strip(), file=sys.stderr)
+        return 2
+
+    client = PrimusClient(path)
+    for text in queries:
+        t0 = time.monotonic()
+        r  = client.ask(text, speak, session)
+        rtt = (time.monotonic() - t0) * 1e6
+        print(f"#{r.id} [answer {r.answer_id}] queue {r.queue_us} us, compute "
+              f"{r.compute_us} us, server {r.total_us} us, round trip {rtt:.0f} us")
+        print(r.text)
+    client.close()
+    return 0
+
+
+if __name__ == "__main__":
+    sys.exit(main(sys.argv[1:]))
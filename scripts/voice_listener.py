@@ -14,9 +14,13 @@ import time
 import threading
 from vosk import Model, KaldiRecognizer
 
+from primus_ipc import PrimusClient
+
 # ─── CONFIG ────────────────────────────────────────────────────────────────────
 MODEL_PATH = "/home/pi/primus/AI/model-hi"
 AI_BINARY  = "./hindi_ai"
+AI_SOCKET  = "/tmp/primus_ai.sock"
+AI_SESSION = "room-1"        # conversation context; one per room / speaker
 DEVICE_ID  = 1
 SAMPLERATE = 48000
 BLOCKSIZE  = 8000
@@ -46,20 +50,23 @@ wake_timer  = None
 
 # ─── START C++ AI ──────────────────────────────────────────────────────────────
 
+# Server mode: answers come back as length-prefixed frames, so multi-line
+# responses (e.g. the help text) can no longer desync a readline protocol.
+# Other tools can connect to the same socket while the listener runs.
 try:
-    cpp = subprocess.Popen(
-        [AI_BINARY],
-        stdin=subprocess.PIPE,
-        stdout=subprocess.PIPE,
-        stderr=subprocess.PIPE,
-        text=True,
-        bufsize=1
-    )
+    cpp = subprocess.Popen([AI_BINARY, "--serve", AI_SOCKET])
     print(f"✅ C++ AI started (PID {cpp.pid})")
 except FileNotFoundError:
     print(f"❌ AI binary not found: {AI_BINARY}")
     sys.exit(1)
 
+try:
+    ai = PrimusClient(AI_SOCKET, wait=30.0)
+except OSError as e:
+    print(f"❌ Cannot connect to {AI_SOCKET}: {e}")
+    cpp.terminate()
+    sys.exit(1)
+
 # ─── HELPERS ───────────────────────────────────────────────────────────────────
 
 def is_wake_word(text: str) -> bool:
@@ -81,11 +88,9 @@ def deactivate_wake():
 
 def send_to_ai(text: str) -> str:
     try:
-        cpp.stdin.write(text + "\n")
-        cpp.stdin.flush()
-        response = cpp.stdout.readline().strip()
-        return response or "क्षमा कीजिए, कोई उत्तर नहीं मिला।"
-    except BrokenPipeError:
+        reply = ai.ask(text, speak=True, session=AI_SESSION)
+        return reply.text.strip() or "क्षमा कीजिए, कोई उत्तर नहीं मिला।"
+    except ConnectionError:
         return "AI बंद हो गया है।"
     except Exception as e:
         return f"त्रुटि: {e}"
@@ -0,0 +1,227 @@
+/*
+ * ============================================================
+ *  PRIMUS AI - Pre-rendered Answer Audio
+ *  mmap'ed blob store keyed by knowledge.id
+ * ============================================================
+ */
+
+#include "answer_audio.h"
+#include "dsp_chain.h"
+
+#include <algorithm>
+#include <cstdio>
+#include <cstring>
+#include <unistd.h>
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+
+using namespace std;
+
+/* ===== FILE FORMAT ===== */
+
+struct FileHeader {
+    char     magic[8];          // "PRIMUSAA"
+    uint32_t format;
+    uint32_t dspVersion;
+    uint32_t rate;
+    uint32_t encoding;
+    float    gain;
+    int32_t  speed;
+    int32_t  pitch;
+    uint32_t reserved;
+    uint64_t count;
+};
+
+struct AnswerAudio::Entry {
+    int64_t  id;
+    uint64_t textHash;
+    uint64_t offset;            // into the blob area
+    uint32_t samples;
+    uint32_t bytes;
+};
+
+static const uint32_t FILE_FORMAT = 1;
+
+/* ================================================================
+   IMA ADPCM — 4 bits per sample, one stream per answer
+================================================================ */
+
+static const int16_t STEPS[89] = {
+    7, 8, 9, 10, 11, 12, 13, 14, 16, 17, 19, 21, 23, 25, 28, 31, 34, 37, 41, 45,
+    50, 55, 60, 66, 73, 80, 88, 97, 107, 118, 130, 143, 157, 173, 190, 209, 230,
+    253, 279, 307, 337, 371, 408, 449, 494, 544, 598, 658, 724, 796, 876, 963,
+    1060, 1166, 1282, 1411, 1552, 1707, 1878, 2066, 2272, 2499, 2749, 3024, 3327,
+    3660, 4026, 4428, 4871, 5358, 5894, 6484, 7132, 7845, 8630, 9493, 10442,
+    11487, 12635, 13899, 15289, 16818, 18500, 20350, 22385, 24623, 27086, 29794,
+    32767
+};
+static const int8_t INDEX_ADJUST[8] = { -1, -1, -1, -1, 2, 4, 6, 8 };
+
+struct ImaState {
+    int predictor = 0;
+    int index     = 0;
+
+    // Applies one code; the encoder runs this too so both stay in step
+    int16_t step(int code){
+        int s    = STEPS[index];
+        int diff = s >> 3;
+        if(code & 4) diff += s;
+        if(code & 2) diff += s >> 1;
+        if(code & 1) diff += s >> 2;
+        predictor += (code & 8) ? -diff : diff;
+        predictor  = max(-32768, min(32767, predictor));
+        index      = max(0, min(88, index + INDEX_ADJUST[code & 7]));
+        return (int16_t)predictor;
+    }
+};
+
+static vector<unsigned char> imaEncode(const vector<int16_t>& pcm){
+    vector<unsigned char> out((pcm.size() + 1) / 2, 0);
+    ImaState st;
+    for(size_t i = 0; i < pcm.size(); i++){
+        int delta = pcm[i] - st.predictor;
+        int code  = 0;
+        if(delta < 0){ code = 8; delta = -delta; }
+        int s = STEPS[st.index];
+        if(delta >= s)     { code |= 4; delta -= s; }
+        if(delta >= s / 2) { code |= 2; delta -= s / 2; }
+        if(delta >= s / 4) { code |= 1; }
+        st.step(code);
+        out[i / 2] |= (i & 1) ? code << 4 : code;
+    }
+    return out;
+}
+
+static void imaDecode(const unsigned char* in, size_t samples, int16_t* out){
+    ImaState st;
+    for(size_t i = 0; i < samples; i++){
+        int code = (i & 1) ? in[i / 2] >> 4 : in[i / 2] & 15;
+        out[i] = st.step(code);
+    }
+}
+
+/* ================================================================
+   READER
+================================================================ */
+
+AnswerAudio::~AnswerAudio(){
+    if(map) munmap(map, mapLen);
+}
+
+bool AnswerAudio::open(const string& path){
+    int fd = ::open(path.c_str(), O_RDONLY | O_CLOEXEC);
+    if(fd < 0) return false;
+
+    struct stat st;
+    if(fstat(fd, &st) != 0 || (size_t)st.st_size < sizeof(FileHeader)){
+        ::close(fd);
+        return false;
+    }
+    void* base = mmap(nullptr, st.st_size, PROT_READ, MAP_SHARED, fd, 0);
+    ::close(fd);
+    if(base == MAP_FAILED) return false;
+    map    = base;
+    mapLen = st.st_size;
+
+    FileHeader h;
+    memcpy(&h, base, sizeof(h));
+    size_t indexEnd = sizeof(FileHeader) + h.count * sizeof(Entry);
+    // Audio from another DSP_VERSION would not match live synthesis
+    if(memcmp(h.magic, "PRIMUSAA", 8) != 0 || h.format != FILE_FORMAT ||
+       h.count > mapLen / sizeof(Entry) || indexEnd > mapLen ||
+       h.encoding > IMA_ADPCM || h.dspVersion != (uint32_t)DSP_VERSION)
+    {
+        munmap(map, mapLen);
+        map = nullptr;
+        return false;
+    }
+
+    index      = (const Entry*)((const char*)base + sizeof(FileHeader));
+    entries    = h.count;
+    blobs      = (const unsigned char*)base + indexEnd;
+    blobLen    = mapLen - indexEnd;
+    encoding   = (Encoding)h.encoding;
+    sampleRate = h.rate;
+    hdrVoice   = { h.gain, h.speed, h.pitch };
+    return true;
+}
+
+shared_ptr<const CachedPhrase> AnswerAudio::find(long long id, const string& answer) const {
+    if(!map) return nullptr;
+
+    const Entry* end = index + entries;
+    const Entry* e = lower_bound(index, end, id,
+                                 [](const Entry& a, long long v){ return a.id < v; });
+    if(e == end || e->id != id || e->textHash != phraseHash(answer)) return nullptr;
+    if(e->offset > blobLen || e->bytes > blobLen - e->offset) return nullptr;
+
+    auto p = make_shared<CachedPhrase>();
+    p->rate    = sampleRate;
+    p->samples = e->samples;
+    const unsigned char* blob = blobs + e->offset;
+
+    if(encoding == PCM16){
+        if((size_t)e->samples * 2 > e->bytes) return nullptr;
+        p->pcm  = (const int16_t*)blob;    // blobs are 8-byte aligned
+        p->keep = shared_from_this();
+    } else {
+        if(((size_t)e->samples + 1) / 2 > e->bytes) return nullptr;
+        p->owned.resize(e->samples);
+        imaDecode(blob, e->samples, p->owned.data());
+        p->pcm = p->owned.data();
+    }
+    return p;
+}
+
+/* ================================================================
+   WRITER (primus_prerender)
+================================================================ */
+
+bool AnswerAudio::write(const string& path, const AnswerVoice& voice, int rate,
+                        vector<Rendered>& items, Encoding enc)
+{
+    sort(items.begin(), items.end(),
+         [](const Rendered& a, const Rendered& b){ return a.id < b.id; });
+
+    vector<vector<unsigned char>> data(items.size());
+    vector<Entry> idx(items.size());
+    uint64_t offset = 0;
+    for(size_t i = 0; i < items.size(); i++){
+        auto& pcm = items[i].pcm;
+        if(enc == PCM16){
+            data[i].resize(pcm.size() * sizeof(int16_t));
+            memcpy(data[i].data(), pcm.data(), data[i].size());
+        } else {
+            data[i] = imaEncode(pcm);
+        }
+        data[i].resize((data[i].size() + 7) & ~size_t(7), 0);
+        idx[i] = { items[i].id, items[i].textHash, offset,
+                   (uint32_t)pcm.size(), (uint32_t)data[i].size() };
+        offset += data[i].size();
+    }
+
+    FileHeader h = {};
+    memcpy(h.magic, "PRIMUSAA", 8);
+    h.format     = FILE_FORMAT;
+    h.dspVersion = DSP_VERSION;
+    h.rate       = rate;
+    h.encoding   = enc;
+    h.gain       = voice.gain;
+    h.speed      = voice.speed;
+    h.pitch      = voice.pitch;
+    h.count      = items.size();
+
+    string tmp = path + ".tmp";
+    FILE* f = fopen(tmp.c_str(), "wb");
+    if(!f) return false;
+    bool ok = fwrite(&h, sizeof(h), 1, f) == 1 &&
+              (idx.empty() || fwrite(idx.data(), sizeof(Entry), idx.size(), f) == idx.size());
+    for(auto& d : data)
+        ok = ok && (d.empty() || fwrite(d.data(), 1, d.size(), f) == d.size());
+    ok = (fclose(f) == 0) && ok;
+
+    if(ok && rename(tmp.c_str(), path.c_str()) == 0) return true;
+    unlink(tmp.c_str());
+    return false;
+}
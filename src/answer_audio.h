@@ -0,0 +1,68 @@
+#pragma once
+#include <string>
+#include <vector>
+#include <memory>
+#include <cstdint>
+#include <cstddef>
+
+#include "phrase_cache.h"
+
+/*
+ * Pre-rendered answer audio, built offline by primus_prerender.
+ *
+ * One file, mmap'ed read-only:
+ *   header | index sorted by knowledge.id | audio blobs
+ * Each index entry carries a hash of the answer text it was rendered
+ * from, so an answer edited after the build is synthesized live
+ * instead of playing stale audio. Blobs are int16 PCM or IMA ADPCM
+ * (4 bits/sample, decoded on lookup).
+ */
+
+struct AnswerVoice {
+    float gain  = 1.0f;
+    int   speed = 130;
+    int   pitch = 22;
+    bool operator==(const AnswerVoice& o) const {
+        return gain == o.gain && speed == o.speed && pitch == o.pitch;
+    }
+};
+
+class AnswerAudio : public std::enable_shared_from_this<AnswerAudio> {
+public:
+    enum Encoding : uint32_t { PCM16 = 0, IMA_ADPCM = 1 };
+
+    struct Rendered {
+        long long            id;
+        uint64_t             textHash;    // phraseHash(answer)
+        std::vector<int16_t> pcm;
+    };
+
+    ~AnswerAudio();
+
+    // False if missing, corrupt, or rendered by another DSP_VERSION
+    bool open(const std::string& path);
+
+    const AnswerVoice& voice() const { return hdrVoice; }
+    int    rate()  const { return sampleRate; }
+    size_t count() const { return entries; }
+
+    // Audio for this answer, or null if absent / text changed
+    std::shared_ptr<const CachedPhrase> find(long long id, const std::string& answer) const;
+
+    // Sorts items by id; writes via a temp file + rename
+    static bool write(const std::string& path, const AnswerVoice& voice, int rate,
+                      std::vector<Rendered>& items, Encoding enc);
+
+private:
+    struct Entry;
+
+    void*        map     = nullptr;
+    size_t       mapLen  = 0;
+    const Entry* index   = nullptr;
+    size_t       entries = 0;
+    const unsigned char* blobs = nullptr;
+    size_t       blobLen = 0;
+    Encoding     encoding   = PCM16;
+    int          sampleRate = 0;
+    AnswerVoice  hdrVoice;
+};
@@ -0,0 +1,68 @@
+/*
+ * ============================================================
+ *  PRIMUS AI - Answer Cache
+ *  Normalized query → knowledge row, LRU, dropped on DB change
+ * ============================================================
+ */
+
+#include "answer_cache.h"
+
+using namespace std;
+
+AnswerCache::AnswerCache(size_t maxEntries) : capacity(maxEntries) {}
+
+void AnswerCache::setCapacity(size_t maxEntries){
+    lock_guard<mutex> g(lock);
+    capacity = maxEntries;
+    while(lru.size() > capacity){
+        index.erase(lru.back().query);
+        lru.pop_back();
+    }
+}
+
+bool AnswerCache::find(const string& query, Result& out, uint64_t& ticket){
+    lock_guard<mutex> g(lock);
+    ticket = generation;
+    auto it = index.find(query);
+    if(it == index.end()){
+        counts.misses++;
+        return false;
+    }
+    lru.splice(lru.begin(), lru, it->second);
+    out = it->second->result;
+    counts.hits++;
+    return true;
+}
+
+void AnswerCache::insert(const string& query, const Result& r, uint64_t ticket){
+    lock_guard<mutex> g(lock);
+    if(ticket != generation || capacity == 0) return;   // searched an older DB
+
+    auto it = index.find(query);
+    if(it != index.end()){
+        it->second->result = r;
+        lru.splice(lru.begin(), lru, it->second);
+        return;
+    }
+    lru.push_front({ query, r });
+    index[query] = lru.begin();
+    if(lru.size() > capacity){
+        index.erase(lru.back().query);
+        lru.pop_back();
+    }
+}
+
+void AnswerCache::invalidate(){
+    lock_guard<mutex> g(lock);
+    generation++;
+    counts.invalidations++;
+    lru.clear();
+    index.clear();
+}
+
+AnswerCacheStats AnswerCache::stats() const {
+    lock_guard<mutex> g(lock);
+    AnswerCacheStats s = counts;
+    s.entries = lru.size();
+    return s;
+}
@@ -0,0 +1,63 @@
+#pragma once
+#include <string>
+#include <list>
+#include <unordered_map>
+#include <mutex>
+#include <cstdint>
+#include <cstddef>
+
+/*
+ * Outcome of the knowledge search (FTS → correction → category) by
+ * normalized query, i.e. after preprocess and applyContext. "Nothing
+ * found" is cached too. Holds row ids, not answers: a hit costs one
+ * primary-key lookup instead of the whole search.
+ *
+ * invalidate() empties the cache when the database changes. Searches
+ * that were already running then finish, but their insert() carries
+ * the generation from before and is dropped.
+ */
+
+struct AnswerCacheStats {
+    size_t hits          = 0;
+    size_t misses        = 0;
+    size_t invalidations = 0;
+    size_t entries       = 0;
+
+    double hitRate() const {
+        return hits + misses ? double(hits) / (hits + misses) : 0.0;
+    }
+};
+
+class AnswerCache {
+public:
+    struct Result {
+        long long id    = -1;   // knowledge.id, -1 = nothing found
+        double    score = 0;    // of the search that found it
+    };
+
+    explicit AnswerCache(size_t maxEntries = 1024);
+
+    // 0 disables the cache (every find misses, inserts are dropped)
+    void setCapacity(size_t maxEntries);
+
+    // On a miss, ticket receives what insert() needs
+    bool find(const std::string& query, Result& out, uint64_t& ticket);
+    void insert(const std::string& query, const Result& r, uint64_t ticket);
+    void invalidate();
+
+    AnswerCacheStats stats() const;
+
+private:
+    struct Slot {
+        std::string query;
+        Result      result;
+    };
+
+    size_t   capacity;
+    uint64_t generation = 0;
+
+    mutable std::mutex lock;
+    std::list<Slot> lru;                    // front = most recent
+    std::unordered_map<std::string, std::list<Slot>::iterator> index;
+    AnswerCacheStats counts;
+};
@@ -0,0 +1,118 @@
+/*
+ * ============================================================
+ *  PRIMUS AI - Audio Sinks
+ *  aplay pipe / WAV file / stdout / null
+ * ============================================================
+ */
+
+#include "audio_sink.h"
+
+#include <csignal>
+#include <cstring>
+#include <unistd.h>
+#include <fcntl.h>
+#include <sys/wait.h>
+
+using namespace std;
+
+static bool writeAll(int fd, const void* buf, size_t len){
+    const char* p = (const char*)buf;
+    while(len > 0){
+        ssize_t n = ::write(fd, p, len);
+        if(n <= 0) return false;
+        p   += n;
+        len -= n;
+    }
+    return true;
+}
+
+/* ===== APLAY ===== */
+
+bool AplaySink::open(int sampleRate){
+    close();
+    Subprocess p;
+    bool ok = spawnWriter({ "aplay", "-q", "-t", "raw", "-f", "S16_LE",
+                            "-r", to_string(sampleRate), "-c", "1" }, p);
+    lock_guard<mutex> g(pidLock);
+    player = p;
+    return ok;
+}
+
+bool AplaySink::write(const int16_t* pcm, size_t samples){
+    if(!player.running()) return false;
+    return writeAll(player.fd, pcm, samples * sizeof(int16_t));
+}
+
+void AplaySink::close(){
+    if(!player.running()) return;
+    ::close(player.fd);                    // EOF → aplay drains and exits
+    player.fd = -1;
+
+    // Wait without reaping, so interrupt() can never signal a
+    // recycled pid; forget the pid, then reap
+    pid_t pid = player.pid;
+    siginfo_t info;
+    waitid(P_PID, pid, &info, WEXITED | WNOWAIT);
+    {
+        lock_guard<mutex> g(pidLock);
+        player = Subprocess();
+    }
+    waitpid(pid, nullptr, 0);
+}
+
+void AplaySink::interrupt(){
+    lock_guard<mutex> g(pidLock);
+    if(player.running()) kill(player.pid, SIGTERM);
+}
+
+/* ===== FILE / STDOUT ===== */
+
+static void wavHeader(unsigned char h[44], int rate, uint32_t dataBytes){
+    auto put32 = [&](int at, uint32_t v){ for(int i = 0; i < 4; i++) h[at+i] = v >> (8*i); };
+    auto put16 = [&](int at, uint16_t v){ h[at] = v; h[at+1] = v >> 8; };
+    memcpy(h, "RIFF", 4);      put32(4, 36 + dataBytes);
+    memcpy(h + 8, "WAVEfmt ", 8);
+    put32(16, 16); put16(20, 1); put16(22, 1);
+    put32(24, rate); put32(28, rate * 2); put16(32, 2); put16(34, 16);
+    memcpy(h + 36, "data", 4); put32(40, dataBytes);
+}
+
+bool FileSink::open(int sampleRate){
+    close();
+    rate      = sampleRate;
+    dataBytes = 0;
+    if(path == "-"){
+        fd = STDOUT_FILENO;
+        return true;
+    }
+    fd = ::open(path.c_str(), O_WRONLY | O_CREAT | O_TRUNC | O_CLOEXEC, 0644);
+    if(fd < 0) return false;
+    unsigned char h[44];
+    wavHeader(h, rate, 0);             // sizes patched in close()
+    return writeAll(fd, h, sizeof(h));
+}
+
+bool FileSink::write(const int16_t* pcm, size_t samples){
+    if(fd < 0) return false;
+    dataBytes += samples * sizeof(int16_t);
+    return writeAll(fd, pcm, samples * sizeof(int16_t));
+}
+
+void FileSink::close(){
+    if(fd < 0) return;
+    if(fd != STDOUT_FILENO){
+        unsigned char h[44];
+        wavHeader(h, rate, dataBytes);
+        if(pwrite(fd, h, sizeof(h), 0) != (ssize_t)sizeof(h)) {}
+        ::close(fd);
+    }
+    fd = -1;
+}
+
+/* ===== FACTORY ===== */
+
+unique_ptr<AudioSink> makeAudioSink(const string& spec){
+    if(spec.empty() || spec == "aplay") return make_unique<AplaySink>();
+    if(spec == "null")                  return make_unique<NullSink>();
+    return make_unique<FileSink>(spec);
+}
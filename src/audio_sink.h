@@ -0,0 +1,90 @@
+#pragma once
+#include <string>
+#include <memory>
+#include <vector>
+#include <cstdint>
+#include <cstddef>
+#include <mutex>
+
+#include "subprocess.h"
+
+/*
+ * Where processed PCM (S16_LE mono) goes.
+ * open() is called before the first block and close() after the
+ * last one; close() returns once playback is done. All calls come
+ * from the speech thread except interrupt(), which may be called from
+ * any thread to make a blocked write() return and drop queued audio.
+ */
+
+class AudioSink {
+public:
+    virtual ~AudioSink() = default;
+    virtual bool open(int sampleRate) = 0;
+    virtual bool write(const int16_t* pcm, size_t samples) = 0;
+    virtual void close() = 0;
+    virtual void interrupt() {}
+};
+
+// aplay reading raw PCM from a pipe. Writes after aplay dies need
+// SIGPIPE ignored, which main() does once for the process
+class AplaySink : public AudioSink {
+public:
+    ~AplaySink() override { close(); }
+    bool open(int sampleRate) override;
+    bool write(const int16_t* pcm, size_t samples) override;
+    void close() override;
+    void interrupt() override;     // kills aplay mid-buffer
+
+private:
+    Subprocess player;
+    std::mutex pidLock;            // player.pid vs. interrupt()
+};
+
+// WAV file, or raw PCM on stdout when path is "-"
+class FileSink : public AudioSink {
+public:
+    explicit FileSink(const std::string& path) : path(path) {}
+    ~FileSink() override { close(); }
+    bool open(int sampleRate) override;
+    bool write(const int16_t* pcm, size_t samples) override;
+    void close() override;
+
+private:
+    std::string path;
+    int         fd         = -1;
+    size_t      dataBytes  = 0;
+    int         rate       = 0;
+};
+
+// Discards audio, counts samples — for headless runs and benchmarks
+class NullSink : public AudioSink {
+public:
+    bool open(int) override { return true; }
+    bool write(const int16_t*, size_t n) override { samples += n; return true; }
+    void close() override {}
+
+    size_t samples = 0;
+};
+
+// Keeps everything written until the owner takes it — for offline
+// rendering. The TTS worker closes and reopens the sink whenever its
+// queue runs dry, which can happen mid-answer, so open() keeps what
+// is already there; clear audio between answers
+class BufferSink : public AudioSink {
+public:
+    bool open(int sampleRate) override {
+        rate = sampleRate;
+        return true;
+    }
+    bool write(const int16_t* pcm, size_t n) override {
+        audio.insert(audio.end(), pcm, pcm + n);
+        return true;
+    }
+    void close() override {}
+
+    int                  rate = 0;
+    std::vector<int16_t> audio;
+};
+
+// "aplay" (default), "null", "-" (stdout) or a .wav path
+std::unique_ptr<AudioSink> makeAudioSink(const std::string& spec);
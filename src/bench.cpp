@@ -0,0 +1,1626 @@
+/*
+ * ============================================================
+ *  PRIMUS AI v2.0 — Benchmarks
+ *  Usage: ./primus_bench [suite...]     (no args = all suites)
+ *  Suites: enhancer dsp simd concurrency answers snapshot intents math
+ *          relevance search scale trace reload
+ *  concurrency, answers, snapshot, relevance, search, scale, trace and
+ *  reload read $PRIMUS_DB (default knowledge.db); scale also reads
+ *  $PRIMUS_SCALE, the row counts to try (default 10000,100000)
+ *  Output is one "name metric value" line per result, always in the
+ *  same order; `make bench` keeps it in bench_output.txt
+ *  (--rss-of DB is the scale suite measuring itself in a new process)
+ * ============================================================
+ */
+
+#include "enhancer.h"
+#include "dsp_chain.h"
+#include "dsp_kernels.h"
+#include "hindi_ai.h"
+#include "intent_router.h"
+#include "hindi_math.h"
+#include "trace.h"
+#include "knowledge_generator.h"
+#include "subprocess.h"
+
+#include <iostream>
+#include <iomanip>
+#include <string>
+#include <vector>
+#include <chrono>
+#include <algorithm>
+#include <cctype>
+#include <cmath>
+#include <random>
+#include <cfloat>
+#include <cstdlib>
+#include <thread>
+#include <atomic>
+#include <fstream>
+#include <sstream>
+#include <cstring>
+#include <unordered_map>
+#include <map>
+#include <functional>
+#include <unistd.h>
+
+using namespace std;
+using Clock = chrono::steady_clock;
+
+/* ===== HELPERS ===== */
+
+static double nsSince(Clock::time_point t0, size_t ops){
+    return chrono::duration<double, nano>(Clock::now() - t0).count() / ops;
+}
+
+static void report(const string& name, const string& metric, double value){
+    cout << left << setw(32) << name << " "
+         << setw(14) << metric << " "
+         << fixed << setprecision(1) << value << "\n";
+}
+
+// Nearest rank; v is sorted
+static double percentile(const vector<double>& v, double q){
+    if(v.empty()) return 0;
+    size_t rank = max<size_t>(1, (size_t)ceil(q * v.size()));
+    return v[min(rank, v.size()) - 1];
+}
+
+static bool wanted(const vector<string>& suites, const string& s){
+    return suites.empty() || find(suites.begin(), suites.end(), s) != suites.end();
+}
+
+/* ================================================================
+   ENHANCER — Aho–Corasick rewrite vs. the old find/replace loops
+================================================================ */
+
+// Typical Vosk hi transcripts: lowercase, no punctuation, English
+// terms sometimes left in Latin script
+static const vector<string> TRANSCRIPTS = {
+    "भारत के प्रधानमंत्री कौन है",
+    "इंडिया की राजधानी क्या है",
+    "pm modi kaun hai",
+    "बीजेपी की स्थापना कब हुई",
+    "up का मुख्यमंत्री कौन है",
+    "आईपीसी की धारा 302 क्या है",
+    "इसरो ने चंद्रयान कब भेजा",
+    "gdp of india kya hai",
+    "supreme court के मुख्य न्यायाधीश कौन हैं",
+    "गंगा नदी कहाँ से निकलती है",
+    "अमिताभ बच्चन की पहली फिल्म कौन सी थी",
+    "computer ka avishkar kisne kiya",
+    "artificial intelligence क्या होता है",
+    "जवाहरलाल नेहरु कहाँ पैदा हुए",
+    "mp की राजधानी भोपाल है क्या",
+    "आप मुझे संविधान के बारे में बताइए"
+};
+
+static string legacyPreprocess(const Enhancer& e, const string& input){
+    string s = input;
+    transform(s.begin(), s.end(), s.begin(),
+              [](unsigned char c){ return tolower(c); });
+    for(auto& [from, to] : e.getSynonyms()){
+        size_t pos;
+        while((pos = s.find(from)) != string::npos)
+            s.replace(pos, from.length(), to);
+    }
+    for(auto& [abbr, full] : e.getShortForms()){
+        size_t pos;
+        while((pos = s.find(abbr)) != string::npos)
+            s.replace(pos, abbr.length(), full);
+    }
+    string out;
+    for(unsigned char c : s)
+        if(isalnum(c) || c >= 128 || c == ' ') out += (char)c;
+    return out;
+}
+
+// What preprocess() must make of these. The first three are where it
+// parts from the old loops on purpose: they rewrote keys inside words
+// ("un" and "ai" in "kaun hai", "up" in "supreme"). The rest pin the
+// synonym → short-form chain resolved at compile time
+static const pair<const char*, const char*> ENHANCER_EXPECTED[] = {
+    { "pm modi kaun hai",              "प्रधानमंत्री modi kaun hai" },
+    { "gdp of india kya hai",          "सकल घरेलू उत्पाद of भारत kya hai" },
+    { "supreme court के मुख्य न्यायाधीश कौन हैं",
+                                       "सर्वोच्च न्यायालय के मुख्य न्यायाधीश कौन हैं" },
+    { "ipc की धारा 302",               "भारतीय दंड संहिता की धारा 302" },
+    { "आईपीसी की धारा 302 क्या है",    "भारतीय दंड संहिता की धारा 302 क्या है" },
+};
+
+// False if a transcript outside ENHANCER_EXPECTED differs from the old
+// loops, or any expected rewrite is not produced
+static bool benchEnhancer(){
+    Enhancer enhancer;
+    const int ROUNDS = 2000;
+    size_t ops = ROUNDS * TRANSCRIPTS.size();
+    size_t sink = 0;
+
+    auto t0 = Clock::now();
+    for(int r = 0; r < ROUNDS; r++)
+        for(auto& t : TRANSCRIPTS) sink += legacyPreprocess(enhancer, t).size();
+    double legacyNs = nsSince(t0, ops);
+
+    t0 = Clock::now();
+    for(int r = 0; r < ROUNDS; r++)
+        for(auto& t : TRANSCRIPTS) sink += enhancer.preprocess(t).size();
+    double acNs = nsSince(t0, ops);
+
+    int differs = 0, unexpected = 0;
+    for(auto& t : TRANSCRIPTS){
+        if(legacyPreprocess(enhancer, t) == enhancer.preprocess(t)) continue;
+        differs++;
+        auto known = find_if(begin(ENHANCER_EXPECTED), end(ENHANCER_EXPECTED),
+                             [&](auto& e){ return t == e.first; });
+        if(known == end(ENHANCER_EXPECTED)) unexpected++;
+    }
+    int wrong = 0;
+    for(auto& [in, want] : ENHANCER_EXPECTED)
+        if(enhancer.preprocess(in) != want){
+            cerr << "enhancer: \"" << in << "\" → \"" << enhancer.preprocess(in)
+                 << "\", expected \"" << want << "\"\n";
+            wrong++;
+        }
+
+    report("enhancer.legacy_loop",  "ns/query", legacyNs);
+    report("enhancer.aho_corasick", "ns/query", acNs);
+    report("enhancer.speedup",      "x",        legacyNs / acNs);
+    report("enhancer.outputs_differ", "count",  differs);
+    report("enhancer.unexpected",   "count",    unexpected);
+    report("enhancer.wrong_rewrite", "count",   wrong);
+    if(sink == 0) cerr << "";
+    return unexpected == 0 && wrong == 0;
+}
+
+/* ================================================================
+   DSP — block VoiceChain vs. the old whole-buffer chain
+================================================================ */
+
+// Reference: the chain as processWav ran it, one full-length
+// vector<double> per stage
+namespace legacy {
+
+static vector<double> litter(const vector<double>& in, int w = 8, double th = 0.04){
+    vector<double> out = in;
+    int n = in.size();
+    for(int i = w; i < n - w; i++){
+        if(fabs(in[i]) < th) continue;
+        double l = 0, r = 0;
+        for(int j = 1; j <= w; j++){ l += fabs(in[i-j]); r += fabs(in[i+j]); }
+        if(l / w < th * 0.5 && r / w < th * 0.5)
+            out[i] = (in[i-1] + in[i+1]) * 0.5;
+    }
+    return out;
+}
+
+static vector<double> gaussian(const vector<double>& in, int radius = 2){
+    int n = in.size();
+    vector<double> out = in, k(2*radius+1);
+    double sigma = radius / 2.0, sum = 0;
+    for(int i = -radius; i <= radius; i++){ k[i+radius] = exp(-(i*i)/(2.0*sigma*sigma)); sum += k[i+radius]; }
+    for(auto& v : k) v /= sum;
+    for(int i = radius; i < n - radius; i++){
+        double v = 0;
+        for(int j = -radius; j <= radius; j++) v += in[i+j] * k[j+radius];
+        out[i] = v;
+    }
+    return out;
+}
+
+static vector<double> bass(const vector<double>& in, double amount = 0.28){
+    vector<double> lp = in, out(in.size());
+    for(size_t i = 1; i < in.size(); i++) lp[i] = 0.15 * in[i] + 0.85 * lp[i-1];
+    for(size_t i = 0; i < in.size(); i++) out[i] = in[i] + amount * lp[i];
+    return out;
+}
+
+static vector<double> gate(const vector<double>& in, double th = 0.012){
+    vector<double> out = in;
+    for(auto& v : out) if(fabs(v) < th) v = 0.0;
+    return out;
+}
+
+static vector<double> normalize(const vector<double>& in, double target){
+    double peak = 0;
+    for(double v : in) peak = max(peak, fabs(v));
+    if(peak < 1e-9) return in;
+    vector<double> out(in.size());
+    for(size_t i = 0; i < in.size(); i++) out[i] = in[i] * target / peak;
+    return out;
+}
+
+static vector<double> limit(const vector<double>& in, double drive = 1.8){
+    vector<double> out(in.size());
+    for(size_t i = 0; i < in.size(); i++) out[i] = tanh(drive * in[i]) / tanh(drive);
+    return out;
+}
+
+static vector<double> fade(const vector<double>& in, int ms = 15){
+    vector<double> out = in;
+    int f = min((22050 * ms) / 1000, (int)in.size() / 4);
+    for(int i = 0; i < f; i++){ out[i] *= (double)i / f; out[out.size()-1-i] *= (double)i / f; }
+    return out;
+}
+
+static vector<double> chain(vector<double> s){
+    s = litter(s); s = gaussian(s); s = bass(s); s = gate(s);
+    s = normalize(s, 0.90); s = limit(s); s = normalize(s, 0.92);
+    return fade(s);
+}
+
+} // namespace legacy
+
+// Voiced syllables at ~3.5/s with pauses, hiss and isolated clicks,
+// quantized to 16 bit like espeak-ng output
+static vector<float> speechLike(double seconds, unsigned seed){
+    mt19937 rng(seed);
+    normal_distribution<double> hiss(0.0, 0.003);
+    size_t n = seconds * 22050;
+    vector<float> out(n);
+    for(size_t i = 0; i < n; i++){
+        double t   = i / 22050.0;
+        double syl = max(0.0, sin(2 * M_PI * 3.5 * t));
+        double env = fmod(t, 1.2) < 0.9 ? syl * syl : 0.0;
+        double f0  = 110 + 20 * sin(2 * M_PI * 0.5 * t);
+        double v   = 0;
+        for(int h = 1; h <= 6; h++) v += sin(2 * M_PI * f0 * h * t) / h;
+        double x = 0.35 * env * v + hiss(rng);
+        if(i % 5000 == 2500 && env < 0.01) x += 0.08;
+        out[i] = round(max(-1.0, min(1.0, x)) * 32767) / 32768.0;
+    }
+    return out;
+}
+
+// Block chain, 256-sample blocks as TTS feeds it
+static vector<float> blockChain(VoiceChain& chain, const vector<float>& input){
+    size_t n = input.size();
+    vector<float> out, block;
+    out.reserve(n);
+    chain.reset();
+    for(size_t i = 0; i < n; i += 256){
+        block.assign(input.begin() + i, input.begin() + min(n, i + 256));
+        size_t k = chain.process(block.data(), block.size());
+        out.insert(out.end(), block.begin(), block.begin() + k);
+    }
+    chain.flush(out);
+    return out;
+}
+
+// Max and RMS |block - reference| in 16-bit steps; false on a length
+// mismatch
+static bool dspError(const vector<float>& out, const vector<double>& ref,
+                     double& maxLsb, double& rmsLsb){
+    double maxErr = 0, sq = 0;
+    for(size_t i = 0; i < out.size() && i < ref.size(); i++){
+        double e = fabs(out[i] - ref[i]);
+        maxErr = max(maxErr, e);
+        sq    += e * e;
+    }
+    maxLsb = maxErr * 32768;
+    rmsLsb = ref.empty() ? 0 : sqrt(sq / ref.size()) * 32768;
+    return out.size() == ref.size();
+}
+
+// The look-ahead normalize only differs from the old whole-clip one
+// when the loudest sample comes after the first 400 ms: then it ramps
+// onto the new peak instead of knowing it up front. An early peak must
+// match to float rounding; the late-peak bench signal must stay within
+// the error measured when the block chain went in (331 / 87 lsb16)
+static const double DSP_EARLY_MAX_LSB = 1.0;
+static const double DSP_LATE_MAX_LSB  = 400.0;
+static const double DSP_LATE_RMS_LSB  = 100.0;
+
+static bool benchDsp(){
+    const int ROUNDS = 20;
+    vector<float> input = speechLike(3.0, 7);
+    size_t n = input.size();
+
+    // Reference output and timing
+    vector<double> ref;
+    auto t0 = Clock::now();
+    for(int r = 0; r < ROUNDS; r++)
+        ref = legacy::chain(vector<double>(input.begin(), input.end()));
+    double legacyNs = nsSince(t0, ROUNDS * n);
+
+    VoiceChain chain;
+    vector<float> out;
+    t0 = Clock::now();
+    for(int r = 0; r < ROUNDS; r++) out = blockChain(chain, input);
+    double blockNs = nsSince(t0, ROUNDS * n);
+
+    double maxErr, rmsErr;
+    bool lengthOk = dspError(out, ref, maxErr, rmsErr);
+    bool lateOk   = lengthOk && maxErr <= DSP_LATE_MAX_LSB && rmsErr <= DSP_LATE_RMS_LSB;
+
+    // Same signal at half level after the first 300 ms, so its
+    // loudest sample is early
+    vector<float> early = input;
+    for(size_t i = 22050 * 3 / 10; i < n; i++) early[i] *= 0.5f;
+    vector<double> earlyRef = legacy::chain(vector<double>(early.begin(), early.end()));
+    double earlyMax, earlyRms;
+    bool earlyOk = dspError(blockChain(chain, early), earlyRef, earlyMax, earlyRms) &&
+                   earlyMax <= DSP_EARLY_MAX_LSB;
+
+    report("dsp.legacy_chain",   "ns/sample", legacyNs);
+    report("dsp.block_chain",    "ns/sample", blockNs);
+    report("dsp.speedup",        "x",         legacyNs / blockNs);
+    report("dsp.length_match",   "bool",      lengthOk);
+    report("dsp.max_abs_err",    "lsb16",     maxErr);
+    report("dsp.rms_err",        "lsb16",     rmsErr);
+    report("dsp.late_peak",      "ok",        lateOk);
+    report("dsp.early_max_err",  "lsb16",     earlyMax);
+    report("dsp.early_peak",     "ok",        earlyOk);
+    // Old chain: input + 9 full-length double vectors per utterance;
+    // block chain: the 400 ms look-ahead FIFO plus one block
+    report("dsp.legacy_alloc",   "KiB",       10.0 * n * sizeof(double) / 1024);
+    report("dsp.block_state",    "KiB",       (8820 + 256) * sizeof(float) / 1024.0);
+    return lateOk && earlyOk;
+}
+
+/* ================================================================
+   SIMD — every kernel variant against the scalar reference
+   err is max |variant - scalar| in float epsilons at 1.0;
+   returns false if any kernel is outside its tolerance
+================================================================ */
+
+static bool benchSimd(){
+    const size_t N = 1 << 16;
+    const int ROUNDS = 200;
+
+    mt19937 rng(11);
+    uniform_real_distribution<float> wide(-1.2f, 1.2f), unit(0.2f, 1.0f);
+    vector<float> x(N + 4), gain(N);
+    vector<int16_t> s16(N);
+    for(auto& v : x)    v = wide(rng);
+    for(auto& v : gain) v = unit(rng);
+    for(size_t i = 0; i < N; i++) s16[i] = (int16_t)(rng() & 0xffff);
+    x[N / 3] = -1.19f;                     // peak away from the ends
+    const float K[3] = { 0.4026f, 0.2442f, 0.0545f };
+
+    auto errOf = [](const vector<float>& a, const vector<float>& b){
+        double e = 0;
+        for(size_t i = 0; i < a.size(); i++) e = max(e, (double)fabs(a[i] - b[i]));
+        return e / FLT_EPSILON;
+    };
+
+    // One run of each kernel into out; timed ROUNDS times
+    struct Case { string name; double tol; };
+    const vector<Case> cases = {
+        { "s16_to_float", 0 }, { "float_to_s16", 0 }, { "peak_abs", 0 },
+        { "gate", 0 }, { "gauss5", 1 }, { "soft_limit", 4 },
+    };
+    // gate works in place, so its timing includes refilling the input
+    vector<int16_t> pcm(N);
+    auto run = [&](const DspKernels& k, int c, vector<float>& out, bool check){
+        out.resize(N);
+        switch(c){
+        case 0: k.s16ToFloat(s16.data(), out.data(), N); break;
+        case 1: k.floatToS16(x.data(), pcm.data(), N); break;
+        case 2: out[0] = k.peakAbs(x.data(), N); break;
+        case 3: copy(x.begin(), x.begin() + N, out.begin());
+                k.gate(out.data(), N, 0.3f); break;
+        case 4: k.gauss5(x.data() + 2, out.data(), N, K); break;
+        case 5: k.softLimit(x.data(), gain.data(), out.data(), N, 1.8f, 0.9f); break;
+        }
+        if(check && c == 1) copy(pcm.begin(), pcm.end(), out.begin());
+    };
+
+    bool ok = true;
+    const DspKernels* scalar = availableDspKernels().front();
+    vector<float> ref, got;
+    for(const DspKernels* k : availableDspKernels()){
+        for(int c = 0; c < (int)cases.size(); c++){
+            string name = string("simd.") + k->name + "." + cases[c].name;
+            run(*scalar, c, ref, true);
+            run(*k, c, got, true);
+            double err = errOf(ref, got);
+            bool pass = err <= cases[c].tol;
+            ok = ok && pass;
+
+            auto t0 = Clock::now();
+            for(int r = 0; r < ROUNDS; r++) run(*k, c, got, false);
+            double ns = nsSince(t0, (size_t)ROUNDS * N);
+
+            report(name, "Msamples/s", 1e3 / ns);
+            report(name, "err_eps",    err);
+            report(name, "ok",         pass);
+        }
+    }
+    report("simd.selected." + string(dspKernels().name), "bool", 1);
+    return ok;
+}
+
+/* ================================================================
+   CONCURRENCY — generateResponse from N threads on one HindiAI
+   Every query gets a fresh Session so answers don't depend on which
+   thread ran what before; each answer id must match the 1-thread run
+================================================================ */
+
+// Every 9th knowledge question; false if there is no database
+static bool loadQueries(const string& suite, string& dbPath, vector<string>& queries){
+    const char* env = getenv("PRIMUS_DB");
+    dbPath = env ? env : "knowledge.db";
+    if(!ifstream(dbPath)){
+        cerr << suite << ": " << dbPath << " not found, skipped\n";
+        return false;
+    }
+    sqlite3* db = nullptr;
+    if(sqlite3_open_v2(dbPath.c_str(), &db, SQLITE_OPEN_READONLY, nullptr) == SQLITE_OK){
+        sqlite3_stmt* st = nullptr;
+        sqlite3_prepare_v2(db, "SELECT question FROM knowledge ORDER BY id;", -1, &st, nullptr);
+        for(int row = 0; st && sqlite3_step(st) == SQLITE_ROW; row++)
+            if(row % 9 == 0) queries.push_back((const char*)sqlite3_column_text(st, 0));
+        sqlite3_finalize(st);
+    }
+    sqlite3_close(db);
+    return !queries.empty();
+}
+
+static bool benchConcurrency(){
+    string dbPath;
+    vector<string> queries;
+    if(!loadQueries("concurrency", dbPath, queries)) return true;
+
+    // Measures the search itself, not answer cache hits
+    HindiAI ai(dbPath);
+    ai.setAnswerCacheSize(0);
+    const size_t TOTAL = 4000;
+
+    vector<long long> expected(queries.size());
+    for(size_t i = 0; i < queries.size(); i++){
+        Session s;
+        ai.generateResponse(queries[i], s);
+        expected[i] = s.answerId;
+    }
+
+    unsigned cores = max(1u, thread::hardware_concurrency());
+    vector<int> counts = { 1, 2, 4 };
+    if(cores > 4) counts.push_back(cores);
+
+    bool   ok = true;
+    double base = 0;
+    for(int threads : counts){
+        atomic<size_t> next{0};
+        atomic<int>    wrong{0};
+        auto work = [&]{
+            for(size_t n; (n = next++) < TOTAL; ){
+                size_t i = n % queries.size();
+                Session s;
+                ai.generateResponse(queries[i], s);
+                if(s.answerId != expected[i]) wrong++;
+            }
+        };
+        auto t0 = Clock::now();
+        vector<thread> pool;
+        for(int t = 0; t < threads; t++) pool.emplace_back(work);
+        for(auto& t : pool) t.join();
+        double qps = TOTAL / chrono::duration<double>(Clock::now() - t0).count();
+        if(threads == 1) base = qps;
+
+        string name = "concurrency.threads_" + to_string(threads);
+        report(name, "queries/s", qps);
+        report(name, "speedup",   qps / base);
+        report(name, "mismatches", wrong);
+        ok = ok && wrong == 0;
+    }
+    report("concurrency.cores",   "count", cores);
+    report("concurrency.readers", "count", ai.readerCount());
+    return ok;
+}
+
+/* ================================================================
+   ANSWERS — same questions cold (full search) and again (cache hit),
+   then one cached row changed by another connection: the next answer
+   must be the new one
+================================================================ */
+
+// VACUUM INTO a fresh file, then edit applied to the copy
+static bool copyKnowledge(const string& from, const string& to, const string& edit){
+    unlink(to.c_str());
+    sqlite3* db = nullptr;
+    string sql = "VACUUM INTO '" + to + "';";
+    bool ok = sqlite3_open_v2(from.c_str(), &db, SQLITE_OPEN_READONLY, nullptr) == SQLITE_OK &&
+              sqlite3_exec(db, sql.c_str(), 0,0,0) == SQLITE_OK;
+    sqlite3_close(db);
+    db = nullptr;
+    ok = ok && sqlite3_open(to.c_str(), &db) == SQLITE_OK &&
+         sqlite3_exec(db, edit.c_str(), 0,0,0) == SQLITE_OK;
+    sqlite3_close(db);
+    return ok;
+}
+
+static bool benchAnswers(){
+    string seedPath;
+    vector<string> queries;
+    if(!loadQueries("answers", seedPath, queries)) return true;
+
+    // A private copy: this suite edits it
+    string dbPath = seedPath + ".answers.db";
+    if(!copyKnowledge(seedPath, dbPath, "")){
+        cerr << "answers: cannot write " << dbPath << ", skipped\n";
+        return true;
+    }
+
+    bool fresh;
+    {
+        HindiAI ai(dbPath);
+        ai.setAnswerCacheSize(queries.size());
+
+        double us[2];
+        int    differs = 0;
+        vector<long long> first(queries.size());
+        for(int pass = 0; pass < 2; pass++){
+            auto t0 = Clock::now();
+            for(size_t i = 0; i < queries.size(); i++){
+                Session s;
+                ai.generateResponse(queries[i], s);
+                if(pass == 0) first[i] = s.answerId;
+                else if(s.answerId != first[i]) differs++;
+            }
+            us[pass] = nsSince(t0, queries.size()) / 1000;
+        }
+        AnswerCacheStats st = ai.answerCacheStats();
+
+        // No reload watcher here: only data_version can drop the entry
+        const string mark = "बदला हुआ उत्तर";
+        long long id = first[0];
+        sqlite3* db = nullptr;
+        string edit = "UPDATE knowledge SET answer = '" + mark + "' WHERE id = " + to_string(id) + ";";
+        bool edited = id >= 0 && sqlite3_open(dbPath.c_str(), &db) == SQLITE_OK &&
+                      sqlite3_exec(db, edit.c_str(), 0,0,0) == SQLITE_OK;
+        sqlite3_close(db);
+        Session s;
+        fresh = edited && ai.generateResponse(queries[0], s).find(mark) != string::npos &&
+                ai.answerCacheStats().invalidations > st.invalidations;
+
+        report("answers.cold",          "us/query", us[0]);
+        report("answers.cached",        "us/query", us[1]);
+        report("answers.speedup",       "x",        us[0] / us[1]);
+        report("answers.hit_rate",      "%",        st.hitRate() * 100);
+        report("answers.outputs_differ", "count",   differs);
+        report("answers.after_edit",    "fresh",    fresh);
+        fresh = fresh && differs == 0;
+    }
+
+    for(const string& f : { dbPath, dbPath + "-wal", dbPath + "-shm" })
+        unlink(f.c_str());
+    return fresh;
+}
+
+/* ================================================================
+   SNAPSHOT — startup from SQLite vs. a mapped snapshot, and both
+   must find the same rows
+================================================================ */
+
+static bool benchSnapshot(){
+    string dbPath;
+    vector<string> queries;
+    if(!loadQueries("snapshot", dbPath, queries)) return true;
+
+    string snapPath = dbPath + ".bench.snap";
+    sqlite3* db = nullptr;
+    Enhancer enhancer;
+    bool compiled = sqlite3_open(dbPath.c_str(), &db) == SQLITE_OK &&
+                    KnowledgeSnapshot::compile(db, snapPath,
+                                               [&](const string& q){ return enhancer.preprocess(q); },
+                                               enhancer.fingerprint());
+    sqlite3_close(db);
+    if(!compiled){
+        cerr << "snapshot: cannot write " << snapPath << ", skipped\n";
+        return true;
+    }
+
+    // Best of 5, so the page cache is warm for both
+    const int RUNS = 5;
+    double ms[2] = { 1e9, 1e9 };
+    bool   mapped = true;
+    for(int run = 0; run < RUNS; run++){
+        for(int mode = 0; mode < 2; mode++){
+            auto t0 = Clock::now();
+            HindiAI ai(dbPath, mode ? snapPath : "");
+            ms[mode] = min(ms[mode], chrono::duration<double, milli>(Clock::now() - t0).count());
+            if(mode) mapped = mapped && ai.isSnapshotMapped();
+        }
+    }
+
+    HindiAI built(dbPath), fromSnap(dbPath, snapPath);
+    built.setAnswerCacheSize(0);
+    fromSnap.setAnswerCacheSize(0);
+    int differs = 0;
+    for(auto& q : queries){
+        Session a, b;
+        built.generateResponse(q, a);
+        fromSnap.generateResponse(q, b);
+        if(a.answerId != b.answerId) differs++;
+    }
+
+    ifstream f(snapPath, ios::binary | ios::ate);
+    report("snapshot.file",           "KiB", f.tellg() / 1024.0);
+    report("snapshot.startup_sqlite", "ms",  ms[0]);
+    report("snapshot.startup_mapped", "ms",  ms[1]);
+    report("snapshot.speedup",        "x",   ms[0] / ms[1]);
+    report("snapshot.mapped",         "bool", mapped);
+    report("snapshot.outputs_differ", "count", differs);
+    unlink(snapPath.c_str());
+    return mapped && differs == 0;
+}
+
+/* ================================================================
+   INTENTS — compiled router vs. the old contains() chain on a
+   labelled corpus of transcripts
+================================================================ */
+
+static const vector<pair<Intent, string>> INTENT_CORPUS = {
+    { Intent::Greeting,  "नमस्ते" },
+    { Intent::Greeting,  "हेलो primus" },
+    { Intent::Greeting,  "hello कैसे हो" },
+    { Intent::Greeting,  "नमस्कार बॉस" },
+    { Intent::Time,      "अभी समय क्या है" },
+    { Intent::Time,      "टाइम बताओ" },
+    { Intent::Time,      "what is the time" },
+    { Intent::Time,      "कितने बजे हैं" },
+    { Intent::Date,      "आज की तारीख क्या है" },
+    { Intent::Date,      "आज दिनांक क्या है" },
+    { Intent::Date,      "today's date" },
+    { Intent::Math,      "25 और 30 का जोड़" },
+    { Intent::Math,      "25 और 30 जोड़ो" },
+    { Intent::Math,      "100 में से 45 घटाओ" },
+    { Intent::Math,      "12 को 8 से गुणा करो" },
+    { Intent::Math,      "144 को 12 से भाग दो" },
+    { Intent::Math,      "7 plus 5" },
+    { Intent::Math,      "9 minus 4" },
+    { Intent::Math,      "20 / 4" },
+    { Intent::Math,      "calculate 6 * 7" },
+    { Intent::Help,      "मदद" },
+    { Intent::Help,      "मुझे मदद चाहिए" },
+    { Intent::Help,      "help" },
+    { Intent::FollowUp,  "और बताओ" },
+    { Intent::FollowUp,  "इसके बारे में विस्तार से बताओ" },
+    { Intent::FollowUp,  "आगे बताओ" },
+    // Knowledge questions that merely contain a trigger as a substring
+    { Intent::Knowledge, "भागलपुर किस राज्य में है" },
+    { Intent::Knowledge, "विदेश विभाग का काम क्या है" },
+    { Intent::Knowledge, "शिक्षा विभाग किसके अधीन है" },
+    { Intent::Knowledge, "भागीरथी नदी कहाँ से निकलती है" },
+    { Intent::Knowledge, "विभाजन कब हुआ था" },
+    { Intent::Knowledge, "गुणात्मक शोध क्या है" },
+    { Intent::Knowledge, "समयसीमा का अर्थ क्या है" },
+    { Intent::Knowledge, "असमय वर्षा से क्या नुकसान होता है" },
+    { Intent::Knowledge, "they सब कौन हैं" },
+    { Intent::Knowledge, "sometimes का हिंदी अर्थ" },
+    { Intent::Knowledge, "अपडेट कैसे करें" },
+    { Intent::Knowledge, "मददगार पौधे कौन से हैं" },
+    { Intent::Knowledge, "विस्तारवाद क्या है" },
+    { Intent::Knowledge, "हायर सेकेंडरी परीक्षा कब होती है" },
+    { Intent::Knowledge, "भारत की राजधानी क्या है" },
+    { Intent::Knowledge, "प्रधानमंत्री कौन है" },
+    { Intent::Knowledge, "गंगा नदी कहाँ से निकलती है" },
+    { Intent::Knowledge, "आईपीसी की धारा 302 क्या है" },
+    { Intent::Knowledge, "अमिताभ बच्चन की पहली फिल्म कौन सी थी" },
+    { Intent::Knowledge, "artificial intelligence क्या होता है" },
+};
+
+// main.cpp's if/else chain before the router, plus the follow-up
+// check generateResponse used to make on its own
+static Intent legacyRoute(const string& text){
+    auto has = [&](const char* w){ return text.find(w) != string::npos; };
+    if(has("hello") || has("hey") || has("नमस्ते") || has("हाय"))          return Intent::Greeting;
+    if(has("समय") || has("टाइम") || has("time"))                           return Intent::Time;
+    if(has("तारीख") || has("दिनांक") || has("डेट") || has("date"))        return Intent::Date;
+    if(has("जोड़") || has("घटाओ") || has("गुणा") || has("भाग") || has("calculate"))
+                                                                              return Intent::Math;
+    if(has("मदद") || has("help"))                                           return Intent::Help;
+    if(has("और बताओ") || has("विस्तार"))                                   return Intent::FollowUp;
+    return Intent::Knowledge;
+}
+
+static bool benchIntents(){
+    IntentRouter router;
+    const int ROUNDS = 2000;
+    size_t ops = ROUNDS * INTENT_CORPUS.size();
+    size_t sink = 0;
+
+    auto t0 = Clock::now();
+    for(int r = 0; r < ROUNDS; r++)
+        for(auto& [want, text] : INTENT_CORPUS) sink += (int)legacyRoute(text);
+    double legacyNs = nsSince(t0, ops);
+
+    t0 = Clock::now();
+    for(int r = 0; r < ROUNDS; r++)
+        for(auto& [want, text] : INTENT_CORPUS) sink += (int)router.route(text).intent;
+    double routerNs = nsSince(t0, ops);
+
+    int legacyOk = 0, routerOk = 0;
+    for(auto& [want, text] : INTENT_CORPUS){
+        legacyOk += legacyRoute(text) == want;
+        Intent got = router.route(text).intent;
+        if(got == want) routerOk++;
+        else cerr << "intents: \"" << text << "\" → " << intentName(got)
+                  << ", expected " << intentName(want) << "\n";
+    }
+
+    double n = INTENT_CORPUS.size();
+    report("intents.legacy_chain",    "ns/query", legacyNs);
+    report("intents.router",          "ns/query", routerNs);
+    report("intents.legacy_accuracy", "%",        legacyOk * 100 / n);
+    report("intents.router_accuracy", "%",        routerOk * 100 / n);
+    report("intents.corpus",          "count",    n);
+    if(sink == 0) cerr << "";
+    return routerOk == (int)INTENT_CORPUS.size();
+}
+
+/* ================================================================
+   MATH — arithmetic engine vs. the old operator-substring + stod
+   evaluator on a table of spoken expressions
+================================================================ */
+
+struct MathCase {
+    const char* text;
+    MathStatus  status;
+    double      value;
+};
+
+static const MathCase MATH_CORPUS[] = {
+    // What the old evaluator handled
+    { "25 और 30 का जोड़",              MathStatus::Ok, 55 },
+    { "25 और 30 जोड़ो",                MathStatus::Ok, 55 },
+    { "100 में से 45 घटाओ",            MathStatus::Ok, 55 },
+    { "12 को 8 से गुणा करो",            MathStatus::Ok, 96 },
+    { "144 को 12 से भाग दो",            MathStatus::Ok, 12 },
+    { "7 plus 5",                      MathStatus::Ok, 12 },
+    { "9 minus 4",                     MathStatus::Ok, 5 },
+    // Precedence, parentheses, powers, percentages
+    { "calculate 6 * 7",               MathStatus::Ok, 42 },
+    { "20 / 4",                        MathStatus::Ok, 5 },
+    { "2 + 3 * 4",                     MathStatus::Ok, 14 },
+    { "(2 + 3) * 4",                   MathStatus::Ok, 20 },
+    { "10 - 4 - 3",                    MathStatus::Ok, 3 },
+    { "2 की घात 10",                    MathStatus::Ok, 1024 },
+    { "2 ^ 3 ^ 2",                     MathStatus::Ok, 512 },
+    { "200 का 15 प्रतिशत",              MathStatus::Ok, 30 },
+    { "what is 15 percent of 200",     MathStatus::Ok, 30 },
+    { "10 का वर्ग",                     MathStatus::Ok, 100 },
+    { "3 का घन",                        MathStatus::Ok, 27 },
+    { "16 का वर्गमूल",                  MathStatus::Ok, 4 },
+    { "square root of 81",             MathStatus::Ok, 9 },
+    { "5 squared plus 1",              MathStatus::Ok, 26 },
+    { "10 भाग 4",                       MathStatus::Ok, 2.5 },
+    // Number words and Devanagari digits, as Vosk writes them
+    { "दो और दो कितने होते हैं",        MathStatus::Ok, 4 },
+    { "पच्चीस और तीस का जोड़ कितना होता है", MathStatus::Ok, 55 },
+    { "दो की घात दस",                   MathStatus::Ok, 1024 },
+    { "दस बटा दो",                      MathStatus::Ok, 5 },
+    { "नवासी जोड़ ग्यारह",               MathStatus::Ok, 100 },
+    { "छियानवे को बारह से भाग दो",       MathStatus::Ok, 8 },
+    { "अड़तालीस में से अट्ठाईस घटाओ",     MathStatus::Ok, 20 },
+    { "सौ और चालीस का अंतर",            MathStatus::Ok, 60 },
+    { "5, 10 और 15 का योग",             MathStatus::Ok, 30 },
+    { "2, 3 और 4 का गुणनफल",            MathStatus::Ok, 24 },
+    { "पाँच लाख पच्चीस हज़ार तीन सौ बीस में से पच्चीस हज़ार घटाओ", MathStatus::Ok, 500320 },
+    { "एक करोड़ भाग सौ",                 MathStatus::Ok, 100000 },
+    { "दो हज़ार करोड़ भाग एक करोड़",      MathStatus::Ok, 2000 },
+    { "साढ़े तीन गुणा दो",               MathStatus::Ok, 7 },
+    { "डेढ़ सौ जोड़ पचास",               MathStatus::Ok, 200 },
+    { "ढाई सौ का दस प्रतिशत",            MathStatus::Ok, 25 },
+    { "सवा सौ गुणा चार",                MathStatus::Ok, 500 },
+    { "पौने दो गुणा चार",                MathStatus::Ok, 7 },
+    { "तीन दशमलव पाँच गुणा दो",          MathStatus::Ok, 7 },
+    { "माइनस पाँच गुणा तीन",             MathStatus::Ok, -15 },
+    { "१२ गुणा ८",                      MathStatus::Ok, 96 },
+    { "१,००,००० भाग १००",               MathStatus::Ok, 1000 },
+    { "twenty five times four",        MathStatus::Ok, 100 },
+    { "ninety nine plus one",          MathStatus::Ok, 100 },
+    // Errors
+    { "10 भाग 0",                       MathStatus::DivideByZero, 0 },
+    { "10 को 0 से भाग दो",              MathStatus::DivideByZero, 0 },
+    { "10 की घात 400",                  MathStatus::OutOfRange, 0 },
+    { "(-4) का वर्गमूल",                MathStatus::OutOfRange, 0 },
+    // Not arithmetic: must reach the knowledge base
+    { "भारत की राजधानी क्या है",        MathStatus::NotMath, 0 },
+    { "आईपीसी की धारा 302 क्या है",      MathStatus::NotMath, 0 },
+    { "1947",                          MathStatus::NotMath, 0 },
+    { "दो हज़ार",                       MathStatus::NotMath, 0 },
+    { "भाग मिल्खा भाग",                 MathStatus::NotMath, 0 },
+    { "विभाग क्या है",                  MathStatus::NotMath, 0 },
+    { "1 प्रतिशत को दशमलव में बताओ",     MathStatus::NotMath, 0 },
+    { "एक और एक ग्यारह",                MathStatus::NotMath, 0 },
+    { "25 30",                         MathStatus::NotMath, 0 },
+    { "5 +",                           MathStatus::NotMath, 0 },
+};
+
+// main.cpp's evaluator before the engine: operator by substring,
+// the first two tokens stod() accepts as operands
+static MathCase legacyMath(const string& input){
+    char op = 0;
+    auto has = [&](const char* w){ return input.find(w) != string::npos; };
+    if(has("जोड़") || has("plus") || has("+"))           op = '+';
+    else if(has("घटाओ") || has("minus") || has("-"))     op = '-';
+    else if(has("गुणा") || has("multiply") || has("*"))  op = '*';
+    else if(has("भाग") || has("divide") || has("/"))     op = '/';
+    if(!op) return { "", MathStatus::NotMath, 0 };
+
+    istringstream ss(input);
+    string token;
+    vector<double> nums;
+    while(ss >> token){
+        try { nums.push_back(stod(token)); } catch(...) {}
+    }
+    if(nums.size() < 2) return { "", MathStatus::NotMath, 0 };
+
+    double a = nums[0], b = nums[1];
+    switch(op){
+        case '+': return { "", MathStatus::Ok, a + b };
+        case '-': return { "", MathStatus::Ok, a - b };
+        case '*': return { "", MathStatus::Ok, a * b };
+    }
+    if(b == 0) return { "", MathStatus::DivideByZero, 0 };
+    return { "", MathStatus::Ok, a / b };
+}
+
+static bool sameOutcome(const MathCase& want, MathStatus status, double value){
+    return status == want.status &&
+           (status != MathStatus::Ok || fabs(value - want.value) < 1e-9);
+}
+
+static bool benchMath(){
+    const int ROUNDS = 2000;
+    size_t n = sizeof(MATH_CORPUS) / sizeof(MATH_CORPUS[0]);
+    size_t ops = ROUNDS * n;
+    double sink = 0;
+
+    auto t0 = Clock::now();
+    for(int r = 0; r < ROUNDS; r++)
+        for(auto& c : MATH_CORPUS) sink += legacyMath(c.text).value;
+    double legacyNs = nsSince(t0, ops);
+
+    t0 = Clock::now();
+    for(int r = 0; r < ROUNDS; r++)
+        for(auto& c : MATH_CORPUS) sink += evaluateArithmetic(c.text).value;
+    double engineNs = nsSince(t0, ops);
+
+    int legacyOk = 0, engineOk = 0;
+    for(auto& c : MATH_CORPUS){
+        MathCase old = legacyMath(c.text);
+        legacyOk += sameOutcome(c, old.status, old.value);
+        MathResult got = evaluateArithmetic(c.text);
+        if(sameOutcome(c, got.status, got.value)) engineOk++;
+        else cerr << "math: \"" << c.text << "\" → status " << (int)got.status
+                  << " value " << got.value << ", expected status " << (int)c.status
+                  << " value " << c.value << "\n";
+    }
+
+    report("math.legacy",          "ns/query", legacyNs);
+    report("math.engine",          "ns/query", engineNs);
+    report("math.legacy_accuracy", "%",        legacyOk * 100.0 / n);
+    report("math.engine_accuracy", "%",        engineOk * 100.0 / n);
+    report("math.corpus",          "count",    n);
+    if(sink == 0) cerr << "";
+    return engineOk == (int)n;
+}
+
+/* ================================================================
+   RELEVANCE — BM25 keyword scoring vs. the old substring scorer on
+   paraphrases of the seed questions, and on questions the knowledge
+   base cannot answer
+================================================================ */
+
+// How people reword a question; applied at the end of the text
+static const pair<const char*, const char*> REWORDINGS[] = {
+    { " क्या है",   " किसे कहते हैं" },
+    { " क्या था",   " क्या होता था" },
+    { " कौन है",    " कौन हैं" },
+    { " कौन था",    " कौन थे" },
+    { " कहाँ है",   " कहाँ पर स्थित है" },
+    { " कब हुआ",    " कब हुआ था" },
+    { " कब बनी",    " कब बनी थी" },
+    { " कितना है",  " कितना होता है" },
+};
+
+static const vector<string> UNANSWERABLE = {
+    "मेरी कार की चाबी कहाँ है",
+    "कल बारिश होगी क्या",
+    "पिज़्ज़ा कैसे बनाते हैं",
+    "मेरे दोस्त का जन्मदिन कब है",
+    "बिटकॉइन की कीमत कितनी है",
+    "आज शेयर बाजार कैसा रहा",
+    "सबसे अच्छा मोबाइल कौन सा है",
+    "मुझे नींद क्यों नहीं आती",
+    "तुम्हारा पसंदीदा रंग कौन सा है",
+    "दिल्ली से आगरा की ट्रेन कब है",
+    "फुटबॉल विश्व कप 2030 कहाँ होगा",
+    "मेरा बिजली का बिल कितना है",
+    "पड़ोसी का कुत्ता क्यों भौंकता है",
+    "आलू का भाव क्या है",
+    "इस गाने का नाम क्या है",
+    "मेरी बहन कहाँ गई",
+    "अगला चंद्र ग्रहण कब है",
+    "ओलंपिक 2036 कहाँ होंगे",
+    "मेरा फोन कहाँ रखा है",
+    "सबसे सस्ता हवाई टिकट कौन सा है",
+    "बच्चों के लिए अच्छी कहानी सुनाओ",
+    "आज रात खाने में क्या बनाऊँ",
+    "मेरी ईमेल का पासवर्ड क्या है",
+    "पानी की टंकी कब भरेगी",
+    "गाड़ी का टायर कैसे बदलें",
+};
+
+// The old scorer over every question: +10 if the question contains
+// the whole query, +2 per token of 2+ bytes found as a substring
+static long long legacyKeyword(const vector<pair<long long, string>>& questions,
+                               const string& query, const vector<string>& tokens){
+    long long best = -1;
+    int bestScore = 0;
+    for(auto& [id, q] : questions){
+        int score = q.find(query) != string::npos ? 10 : 0;
+        for(auto& tok : tokens)
+            if(tok.size() >= 2 && q.find(tok) != string::npos) score += 2;
+        if(score > bestScore){ bestScore = score; best = id; }
+    }
+    return best;
+}
+
+static bool benchRelevance(){
+    string dbPath;
+    vector<string> seeds;
+    if(!loadQueries("relevance", dbPath, seeds)) return true;
+
+    HindiAI ai(dbPath);
+    Enhancer enhancer;
+
+    // Answers by id, and by question for the seeds
+    vector<pair<long long, string>> questions;
+    unordered_map<long long, string> answerOf;
+    unordered_map<string, string>    seedAnswer;
+    sqlite3* db = nullptr;
+    sqlite3_open_v2(dbPath.c_str(), &db, SQLITE_OPEN_READONLY, nullptr);
+    sqlite3_stmt* st = nullptr;
+    sqlite3_prepare_v2(db, "SELECT id, question, answer FROM knowledge ORDER BY id;",
+                       -1, &st, nullptr);
+    while(st && sqlite3_step(st) == SQLITE_ROW){
+        long long id = sqlite3_column_int64(st, 0);
+        string q = (const char*)sqlite3_column_text(st, 1);
+        string a = (const char*)sqlite3_column_text(st, 2);
+        questions.push_back({ id, q });
+        answerOf[id] = a;
+        seedAnswer.emplace(q, a);
+    }
+    sqlite3_finalize(st);
+    sqlite3_close(db);
+    for(auto& [id, q] : questions)
+        transform(q.begin(), q.end(), q.begin(), [](unsigned char c){ return tolower(c); });
+
+    // Paraphrases: reworded endings, question phrase moved to the
+    // front ("क्या है भारत की राजधानी"), and a spoken lead-in
+    struct Probe { string query; string answer; };
+    vector<Probe> probes;
+    for(auto& q : seeds){
+        const string& answer = seedAnswer[q];
+        for(auto& [from, to] : REWORDINGS){
+            size_t n = strlen(from);
+            if(q.size() > n && q.compare(q.size() - n, n, from) == 0){
+                probes.push_back({ q.substr(0, q.size() - n) + to, answer });
+                probes.push_back({ string(from + 1) + " " + q.substr(0, q.size() - n), answer });
+                break;
+            }
+        }
+        probes.push_back({ "ज़रा बताइए " + q, answer });
+    }
+    for(auto& p : probes) p.query = enhancer.preprocess(p.query);
+
+    vector<string> misses;
+    for(auto& q : UNANSWERABLE) misses.push_back(enhancer.preprocess(q));
+
+    vector<vector<string>> probeTokens, missTokens;
+    for(auto& p : probes) probeTokens.push_back(ai.scoringTokens(p.query));
+    for(auto& q : misses) missTokens.push_back(ai.scoringTokens(q));
+
+    // Latency over the paraphrases
+    double sink = 0;
+    auto t0 = Clock::now();
+    for(size_t i = 0; i < probes.size(); i++)
+        sink += legacyKeyword(questions, probes[i].query, probeTokens[i]);
+    double legacyUs = nsSince(t0, probes.size()) / 1000;
+
+    t0 = Clock::now();
+    for(size_t i = 0; i < probes.size(); i++)
+        sink += ai.matchKeywords(probes[i].query).id;
+    double bm25Us = nsSince(t0, probes.size()) / 1000;
+
+    // Top-1: the best row carries the expected answer (duplicate
+    // questions share answers, so compare those)
+    int legacyTop = 0, legacyAnswered = 0, legacyFalse = 0;
+    vector<KeywordHit> hits;
+    for(size_t i = 0; i < probes.size(); i++){
+        long long id = legacyKeyword(questions, probes[i].query, probeTokens[i]);
+        legacyAnswered += id >= 0;
+        legacyTop      += id >= 0 && answerOf[id] == probes[i].answer;
+        hits.push_back(ai.matchKeywords(probes[i].query));
+    }
+    vector<KeywordHit> missHits;
+    for(size_t i = 0; i < misses.size(); i++){
+        legacyFalse += legacyKeyword(questions, misses[i], missTokens[i]) >= 0;
+        missHits.push_back(ai.matchKeywords(misses[i]));
+    }
+
+    double n = probes.size(), m = misses.size();
+    auto right = [&](size_t i){ return hits[i].id >= 0 && answerOf[hits[i].id] == probes[i].answer; };
+    int bm25Top = 0;
+    for(size_t i = 0; i < probes.size(); i++) bm25Top += right(i);
+
+    report("relevance.legacy_scan",     "us/query", legacyUs);
+    report("relevance.bm25",            "us/query", bm25Us);
+    report("relevance.legacy_top1",     "%",        legacyTop * 100 / n);
+    report("relevance.bm25_top1",       "%",        bm25Top * 100 / n);
+    report("relevance.legacy_wrong",    "%",        (legacyAnswered - legacyTop) * 100 / n);
+    report("relevance.legacy_false",    "%",        legacyFalse * 100 / m);
+
+    // What the confidence threshold trades: paraphrases still answered
+    // correctly, wrong answers given, unanswerable questions answered
+    double chosen = ai.getMinConfidence();
+    vector<double> sweep = { 0.3, 0.4, 0.5, 0.6, 0.7 };
+    if(find(sweep.begin(), sweep.end(), chosen) == sweep.end()) sweep.push_back(chosen);
+    sort(sweep.begin(), sweep.end());
+
+    bool ok = true;
+    for(double thr : sweep){
+        int correct = 0, wrong = 0, falseHits = 0;
+        for(size_t i = 0; i < probes.size(); i++){
+            if(hits[i].confidence < thr) continue;
+            if(right(i)) correct++;
+            else         wrong++;
+        }
+        for(auto& h : missHits) falseHits += h.id >= 0 && h.confidence >= thr;
+
+        ostringstream name;
+        name << "relevance.bm25@" << fixed << setprecision(2) << thr
+             << (thr == chosen ? "*" : "");
+        report(name.str() + "_correct", "%", correct * 100 / n);
+        report(name.str() + "_wrong",   "%", wrong * 100 / n);
+        report(name.str() + "_false",   "%", falseHits * 100 / m);
+        if(thr == chosen) ok = bm25Top >= legacyTop && falseHits <= legacyFalse;
+    }
+    report("relevance.paraphrases",  "count", n);
+    report("relevance.unanswerable", "count", m);
+    if(sink == 0) cerr << "";
+    return ok;
+}
+
+/* ================================================================
+   SEARCH — each search path over four query sets derived from the
+   knowledge table (as loaded from the seed SQL): questions as stored,
+   paraphrased, with Vosk-style transcription errors, and questions
+   it cannot answer. The sets are the same on every run, so
+   bench_output.txt diffs across changes show only real movement.
+================================================================ */
+
+// Single edits Vosk hi makes: nukta dropped, chandrabindu heard as
+// anusvara, long and short vowels swapped, two words run together
+static const pair<const char*, const char*> STT_ERRORS[] = {
+    { "़", "" },
+    { "ँ", "ं" },
+    { "ी", "ि" },
+    { "ि", "ी" },
+    { "ू", "ु" },
+    { "ु", "ू" },
+    { "े", "ै" },
+    { "ै", "े" },
+    { " ", "" },
+};
+
+// One or two edits at places drawn from rng. Only raw mt19937 output
+// is used: distributions differ between standard libraries
+static string sttCorrupt(string q, mt19937& rng){
+    for(int edits = 1 + rng() % 2; edits > 0; edits--){
+        vector<pair<size_t, size_t>> spots;
+        for(size_t e = 0; e < sizeof(STT_ERRORS) / sizeof(STT_ERRORS[0]); e++){
+            const char* from = STT_ERRORS[e].first;
+            for(size_t at = q.find(from); at != string::npos; at = q.find(from, at + 1))
+                spots.push_back({ at, e });
+        }
+        if(spots.empty()) break;
+        auto [at, e] = spots[rng() % spots.size()];
+        q.replace(at, strlen(STT_ERRORS[e].first), STT_ERRORS[e].second);
+    }
+    return q;
+}
+
+static void benchSearch(){
+    string dbPath;
+    vector<string> seeds;
+    if(!loadQueries("search", dbPath, seeds)) return;
+
+    unordered_map<long long, string> answerOf;
+    unordered_map<string, string>    seedAnswer;
+    sqlite3* db = nullptr;
+    sqlite3_open_v2(dbPath.c_str(), &db, SQLITE_OPEN_READONLY, nullptr);
+    sqlite3_stmt* st = nullptr;
+    sqlite3_prepare_v2(db, "SELECT id, question, answer FROM knowledge;", -1, &st, nullptr);
+    while(st && sqlite3_step(st) == SQLITE_ROW){
+        string a = (const char*)sqlite3_column_text(st, 2);
+        answerOf[sqlite3_column_int64(st, 0)] = a;
+        seedAnswer.emplace((const char*)sqlite3_column_text(st, 1), a);
+    }
+    sqlite3_finalize(st);
+    sqlite3_close(db);
+
+    HindiAI      ai(dbPath);
+    Enhancer     enhancer;
+    Intelligence brain;
+    ai.setAnswerCacheSize(0);
+
+    // raw goes to the pipeline, query (preprocessed) to single paths;
+    // answer "" = nothing in the table answers it
+    struct Probe { string raw, query, topic, answer; };
+    struct QuerySet { const char* name; vector<Probe> probes; };
+    vector<QuerySet> sets = { { "exact", {} }, { "paraphrase", {} },
+                              { "stt", {} },   { "unanswerable", {} } };
+    auto add = [&](QuerySet& set, const string& raw, const string& answer){
+        string q     = enhancer.preprocess(raw);
+        string topic = brain.detectTopic(q);
+        set.probes.push_back({ raw, q, topic == "सामान्य" ? "" : topic, answer });
+    };
+
+    mt19937 rng(2024);
+    for(auto& q : seeds){
+        const string& answer = seedAnswer[q];
+        add(sets[0], q, answer);
+        for(auto& [from, to] : REWORDINGS){
+            size_t n = strlen(from);
+            if(q.size() > n && q.compare(q.size() - n, n, from) == 0){
+                add(sets[1], q.substr(0, q.size() - n) + to, answer);
+                add(sets[1], string(from + 1) + " " + q.substr(0, q.size() - n), answer);
+                break;
+            }
+        }
+        add(sets[1], "ज़रा बताइए " + q, answer);
+        string heard = sttCorrupt(q, rng);
+        if(heard != q) add(sets[2], heard, answer);
+    }
+    for(auto& q : UNANSWERABLE) add(sets[3], q, "");
+
+    // The pipeline is what the assistant answers with; corrected is
+    // the pipeline with --autocorrect
+    struct Path { const char* name; function<long long(const Probe&)> find; };
+    auto pipeline = [&](const Probe& p){
+        Session s;
+        ai.generateResponse(p.raw, s);
+        return s.answerId;
+    };
+    vector<Path> paths = {
+        { "fts",       [&](const Probe& p){ return ai.searchOnly(SearchPath::Fts, p.query); } },
+        { "keyword",   [&](const Probe& p){ return ai.searchOnly(SearchPath::Keyword, p.query); } },
+        { "category",  [&](const Probe& p){ return ai.searchOnly(SearchPath::Category, p.query, p.topic); } },
+        { "pipeline",  pipeline },
+        { "corrected", pipeline },
+    };
+
+    for(auto& p : sets[0].probes) pipeline(p);   // warm the page cache
+
+    for(auto& path : paths){
+        streambuf* err = nullptr;
+        if(string(path.name) == "corrected"){
+            CorrectionOptions c;
+            c.enabled = true;
+            ai.setCorrection(c);
+            err = cerr.rdbuf(nullptr);           // one [autocorrect] line per rewrite
+        }
+        for(auto& set : sets){
+            vector<double> us;
+            size_t right = 0, answered = 0;
+            auto t0 = Clock::now();
+            for(auto& p : set.probes){
+                auto q0 = Clock::now();
+                long long id = path.find(p);
+                us.push_back(chrono::duration<double, micro>(Clock::now() - q0).count());
+                answered += id >= 0;
+                right    += id >= 0 && answerOf[id] == p.answer;
+            }
+            double secs = chrono::duration<double>(Clock::now() - t0).count();
+            sort(us.begin(), us.end());
+
+            size_t n = set.probes.size();
+            string name = string("search.") + path.name + "." + set.name;
+            report(name, "queries/s", n / secs);
+            report(name, "p50 us",    percentile(us, 0.50));
+            report(name, "p95 us",    percentile(us, 0.95));
+            report(name, "p99 us",    percentile(us, 0.99));
+            if(set.probes[0].answer.empty()){
+                report(name, "false %", answered * 100.0 / n);
+            } else {
+                report(name, "top1 %",  right * 100.0 / n);
+                report(name, "wrong %", (answered - right) * 100.0 / n);
+            }
+        }
+        if(err){
+            cerr.rdbuf(err);
+            cerr.clear();
+        }
+    }
+    for(auto& set : sets) report(string("search.") + set.name, "count", set.probes.size());
+}
+
+/* ================================================================
+   SCALE — the seed database grown to 10k, 100k (1M) rows with
+   generated entries: load time, first startup (FTS indexing), later
+   startups from SQLite and from a snapshot, resident memory, and
+   latency per search path. "growth" is the exponent against the
+   size before: 1 = linear, above 1 = super-linear.
+================================================================ */
+
+static double rssMiB(){
+    ifstream f("/proc/self/status");
+    string line;
+    while(getline(f, line))
+        if(line.compare(0, 6, "VmRSS:") == 0) return atof(line.c_str() + 6) / 1024;
+    return 0;
+}
+
+// What opening dbPath adds to a fresh process. Measured here it would
+// reuse the heap earlier HindiAI instances freed and read near zero
+static double startupRssMiB(const string& dbPath){
+    Subprocess p;
+    if(!spawnReader({ "/proc/self/exe", "--rss-of", dbPath }, p)) return 0;
+    string out;
+    char buf[64];
+    ssize_t k;
+    while((k = read(p.fd, buf, sizeof buf)) > 0) out.append(buf, k);
+    finish(p);
+    return atof(out.c_str());
+}
+
+static string rowLabel(size_t n){
+    if(n % 1000000 == 0) return to_string(n / 1000000) + "M";
+    if(n % 1000 == 0)    return to_string(n / 1000) + "k";
+    return to_string(n);
+}
+
+static void benchScale(){
+    string seedPath;
+    vector<string> seeds;
+    if(!loadQueries("scale", seedPath, seeds)) return;
+
+    vector<size_t> sizes;
+    const char* env = getenv("PRIMUS_SCALE");
+    stringstream list(env ? env : "10000,100000");
+    for(string n; getline(list, n, ','); )
+        if(atoll(n.c_str()) > 0) sizes.push_back(strtoull(n.c_str(), nullptr, 10));
+    sort(sizes.begin(), sizes.end());
+
+    sqlite3* seedDb = nullptr;
+    sqlite3_open_v2(seedPath.c_str(), &seedDb, SQLITE_OPEN_READONLY, nullptr);
+    KnowledgeGenerator gen(seedDb);
+    sqlite3_close(seedDb);
+    Enhancer enhancer;
+
+    // Growth against the previous size, by (name suffix, metric)
+    map<pair<string, string>, double> previous;
+    size_t previousRows = 0;
+
+    for(size_t rows : sizes){
+        string dbPath = seedPath + ".scale.db", snapPath = dbPath + ".snap";
+        string label  = "scale." + rowLabel(rows);
+        map<pair<string, string>, double> now;
+        auto put = [&](const string& part, const string& metric, double v){
+            report(label + part, metric, v);
+            now[{ part, metric }] = v;
+            auto was = previous.find({ part, metric });
+            if(was != previous.end() && was->second > 0 && v > 0)
+                report(label + part, metric.substr(0, metric.find(' ')) + " growth",
+                       log(v / was->second) / log((double)rows / previousRows));
+        };
+
+        auto t0 = Clock::now();
+        size_t added = 0;
+        if(!generateKnowledge(seedPath, dbPath, rows, &added)){
+            cerr << "scale: cannot write " << dbPath << ", skipped\n";
+            continue;
+        }
+        put("", "load s", chrono::duration<double>(Clock::now() - t0).count());
+        ifstream f(dbPath, ios::binary | ios::ate);
+        report(label, "db MiB", f.tellg() / 1048576.0);
+
+        // The first open builds the FTS index, later ones only the
+        // keyword index (or map it from a snapshot)
+        t0 = Clock::now();
+        { HindiAI first(dbPath); }
+        put("", "index s", chrono::duration<double>(Clock::now() - t0).count());
+
+        sqlite3* db = nullptr;
+        bool compiled = sqlite3_open(dbPath.c_str(), &db) == SQLITE_OK &&
+                        KnowledgeSnapshot::compile(db, snapPath,
+                                                   [&](const string& q){ return enhancer.preprocess(q); },
+                                                   enhancer.fingerprint());
+        sqlite3_close(db);
+        if(compiled){
+            t0 = Clock::now();
+            HindiAI mapped(dbPath, snapPath);
+            put("", "snap ms", chrono::duration<double, milli>(Clock::now() - t0).count());
+        }
+
+        t0 = Clock::now();
+        HindiAI ai(dbPath);
+        put("", "startup ms", chrono::duration<double, milli>(Clock::now() - t0).count());
+        put("", "rss MiB", startupRssMiB(dbPath));
+        ai.setAnswerCacheSize(0);
+
+        // Seed questions, a spread of generated ones, and the unanswerable
+        struct Probe { string raw, query, answer; };
+        vector<Probe> sets[3];
+        const char* setNames[] = { "seed", "generated", "unanswerable" };
+        sqlite3_open_v2(dbPath.c_str(), &db, SQLITE_OPEN_READONLY, nullptr);
+        sqlite3_stmt* byQuestion = nullptr;
+        sqlite3_stmt* byId       = nullptr;
+        sqlite3_prepare_v2(db, "SELECT answer FROM knowledge WHERE question = ? ORDER BY id LIMIT 1;",
+                           -1, &byQuestion, nullptr);
+        sqlite3_prepare_v2(db, "SELECT answer FROM knowledge WHERE id = ?;", -1, &byId, nullptr);
+        for(auto& q : seeds){
+            sqlite3_bind_text(byQuestion, 1, q.c_str(), -1, SQLITE_TRANSIENT);
+            if(sqlite3_step(byQuestion) == SQLITE_ROW)
+                sets[0].push_back({ q, enhancer.preprocess(q),
+                                    (const char*)sqlite3_column_text(byQuestion, 0) });
+            sqlite3_reset(byQuestion);
+        }
+        for(size_t i = 0; added && i < seeds.size(); i++){
+            GeneratedRow g = gen.row(i * added / seeds.size());
+            sets[1].push_back({ g.question, enhancer.preprocess(g.question), g.answer });
+        }
+        for(auto& q : UNANSWERABLE) sets[2].push_back({ q, enhancer.preprocess(q), "" });
+
+        auto answerOf = [&](long long id){
+            string a;
+            sqlite3_bind_int64(byId, 1, id);
+            if(sqlite3_step(byId) == SQLITE_ROW) a = (const char*)sqlite3_column_text(byId, 0);
+            sqlite3_reset(byId);
+            return a;
+        };
+
+        for(string path : { "fts", "keyword", "pipeline" }){
+            for(int set = 0; set < 3; set++){
+                if(sets[set].empty()) continue;
+                vector<double>    us;
+                vector<long long> ids;
+                for(auto& p : sets[set]){
+                    auto q0 = Clock::now();
+                    long long id;
+                    if(path == "fts")          id = ai.searchOnly(SearchPath::Fts, p.query);
+                    else if(path == "keyword") id = ai.searchOnly(SearchPath::Keyword, p.query);
+                    else {
+                        Session s;
+                        ai.generateResponse(p.raw, s);
+                        id = s.answerId;
+                    }
+                    us.push_back(chrono::duration<double, micro>(Clock::now() - q0).count());
+                    ids.push_back(id);
+                }
+                sort(us.begin(), us.end());
+                string part = "." + path + "." + setNames[set];
+                put(part, "p50 us", percentile(us, 0.50));
+                put(part, "p99 us", percentile(us, 0.99));
+                if(path != "pipeline") continue;
+
+                size_t right = 0, answered = 0;
+                for(size_t i = 0; i < ids.size(); i++){
+                    answered += ids[i] >= 0;
+                    right    += ids[i] >= 0 && answerOf(ids[i]) == sets[set][i].answer;
+                }
+                if(set == 2) report(label + part, "false %", answered * 100.0 / ids.size());
+                else         report(label + part, "top1 %",  right * 100.0 / ids.size());
+            }
+        }
+        sqlite3_finalize(byQuestion);
+        sqlite3_finalize(byId);
+        sqlite3_close(db);
+
+        for(const char* ext : { "", "-wal", "-shm" }) unlink((dbPath + ext).c_str());
+        unlink(snapPath.c_str());
+        previous     = move(now);
+        previousRows = rows;
+    }
+}
+
+/* ================================================================
+   TRACE — what a span costs off and on, whether the histogram
+   percentiles land where they should, and the search with tracing
+   on vs. off
+================================================================ */
+
+static const TraceStage BENCH_SPAN("bench.span");
+static const TraceStage BENCH_KNOWN("bench.known");
+
+static bool benchTrace(){
+    const size_t N = 2000000;
+    volatile uint64_t sink = 0;
+
+    auto loop = [&](bool span){
+        auto t0 = Clock::now();
+        for(size_t i = 0; i < N; i++){
+            if(span){ TraceSpan s(BENCH_SPAN); sink = sink + i; }
+            else    { sink = sink + i; }
+        }
+        return nsSince(t0, N);
+    };
+    double bare = loop(false);
+    traceEnable(false);
+    double off = loop(true);
+    traceEnable(true);
+    double on = loop(true);
+
+    // 1..10000 us evenly: p50 5000, p95 9500, p99 9900
+    for(uint64_t us = 1; us <= 10000; us++) traceRecord(BENCH_KNOWN, 0, us * 1000);
+    traceEnable(false);
+
+    report("trace.span_off", "ns/span", off - bare);
+    report("trace.span_on",  "ns/span", on - bare);
+
+    bool ok = true;
+    for(auto& st : traceStats()){
+        if(string(st.stage) != BENCH_KNOWN.name()) continue;
+        double want[] = { 5000, 9500, 9900 }, got[] = { st.p50Us, st.p95Us, st.p99Us };
+        const char* name[] = { "trace.p50_error", "trace.p95_error", "trace.p99_error" };
+        for(int i = 0; i < 3; i++){
+            double err = fabs(got[i] - want[i]) * 100 / want[i];
+            report(name[i], "%", err);
+            ok = ok && err < 20;                 // 4 buckets per octave: ≤ ~12%
+        }
+    }
+
+    string base = "/tmp/primus_bench_trace." + to_string(getpid());
+    bool dumped = traceDumpJson(base + ".stages.json") && traceDumpChrome(base + ".chrome.json");
+    unlink((base + ".stages.json").c_str());
+    unlink((base + ".chrome.json").c_str());
+    report("trace.dumps_written", "count", dumped ? 2 : 0);
+    ok = ok && dumped;
+
+    string dbPath;
+    vector<string> queries;
+    if(!loadQueries("trace", dbPath, queries)) return ok;
+
+    // Full search every time; the same queries off, on, off again
+    HindiAI ai(dbPath);
+    ai.setAnswerCacheSize(0);
+    auto pass = [&]{
+        auto t0 = Clock::now();
+        for(auto& q : queries){
+            Session s;
+            ai.generateResponse(q, s);
+        }
+        return nsSince(t0, queries.size()) / 1000;
+    };
+    pass();                                      // warm the page cache
+    double offUs = pass();
+    traceEnable(true);
+    double onUs = pass();
+    traceEnable(false);
+    offUs = min(offUs, pass());
+    report("trace.search_off", "us/query", offUs);
+    report("trace.search_on",  "us/query", onUs);
+    for(auto& st : traceStats()){
+        if(strncmp(st.stage, "ai.", 3) != 0) continue;
+        report(string("trace.") + st.stage + "_p50", "us", st.p50Us);
+        report(string("trace.") + st.stage + "_p99", "us", st.p99Us);
+    }
+    if(sink == 0) cerr << "";
+    return ok;
+}
+
+/* ================================================================
+   RELOAD — query latency while the knowledge base is rebuilt and
+   swapped underneath: rows changed in place, then the whole file
+   replaced. Answers after each swap must come from the new data
+================================================================ */
+
+static bool benchReload(){
+    string seedPath;
+    vector<string> queries;
+    if(!loadQueries("reload", seedPath, queries)) return true;
+
+    // A private copy: this suite edits and replaces it
+    string dbPath = seedPath + ".reload.db", nextPath = dbPath + ".next";
+    if(!copyKnowledge(seedPath, dbPath, "")){
+        cerr << "reload: cannot write " << dbPath << ", skipped\n";
+        return true;
+    }
+
+    HindiAI ai(dbPath);
+    ai.setAnswerCacheSize(0);
+    Session probe;
+    ai.generateResponse(queries[0], probe);
+    long long id = probe.answerId;
+
+    // The replacement is written before the clock starts
+    string edit = "UPDATE knowledge SET answer = 'नई फ़ाइल का उत्तर' WHERE id = " + to_string(id) + ";";
+    bool replaced = copyKnowledge(seedPath, nextPath, edit);
+    auto answers = [&](const string& mark){
+        Session s;
+        return ai.generateResponse(queries[0], s).find(mark) != string::npos;
+    };
+
+    // One client asking every millisecond, far busier than speech;
+    // latencies by phase. The rebuild runs niced into the gaps
+    atomic<int> phase{0};
+    vector<double> us[2];
+    thread client([&]{
+        for(size_t n = 0; phase < 2; n++){
+            int p = phase;
+            Session s;
+            auto t0 = Clock::now();
+            ai.generateResponse(queries[n % queries.size()], s);
+            us[p].push_back(chrono::duration<double, micro>(Clock::now() - t0).count());
+            this_thread::sleep_for(chrono::milliseconds(1));
+        }
+    });
+    this_thread::sleep_for(chrono::milliseconds(500));
+    phase = 1;
+
+    // In place, as primus_ingest does it: the version moves
+    sqlite3* db = nullptr;
+    edit = "UPDATE knowledge SET answer = answer || ' (संशोधित)' "
+           "WHERE id % 25 = 0 OR id = " + to_string(id) + ";";
+    bool edited = sqlite3_open(dbPath.c_str(), &db) == SQLITE_OK &&
+                  sqlite3_exec(db, edit.c_str(), 0,0,0) == SQLITE_OK;
+    sqlite3_close(db);
+    bool inPlace = edited && ai.reload();
+    double inPlaceMs = ai.reloadStats().lastMs;
+    bool sawEdit = answers("(संशोधित)");
+
+    // Replaced, as load_db.sh --fresh does it: another inode at the path
+    unlink((dbPath + "-wal").c_str());           // the new file must not inherit them
+    unlink((dbPath + "-shm").c_str());
+    replaced = replaced && rename(nextPath.c_str(), dbPath.c_str()) == 0 && ai.reload();
+    double replacedMs = ai.reloadStats().lastMs;
+    bool sawFile = answers("नई फ़ाइल का उत्तर");
+
+    this_thread::sleep_for(chrono::milliseconds(100));
+    phase = 2;
+    client.join();
+
+    const char* name[] = { "reload.steady", "reload.swapping" };
+    for(int p = 0; p < 2; p++){
+        sort(us[p].begin(), us[p].end());
+        if(us[p].empty()) continue;
+        report(name[p], "queries", us[p].size());
+        report(name[p], "p50 us",  percentile(us[p], 0.50));
+        report(name[p], "p99 us",  percentile(us[p], 0.99));
+        report(name[p], "max us",  us[p].back());
+    }
+    ReloadStats rs = ai.reloadStats();
+    report("reload.in_place", "ms",   inPlaceMs);
+    report("reload.in_place", "fresh", inPlace && sawEdit);
+    report("reload.replaced", "ms",   replacedMs);
+    report("reload.replaced", "fresh", replaced && sawFile);
+    report("reload.failures", "count", rs.failures);
+
+    for(const string& f : { dbPath, dbPath + "-wal", dbPath + "-shm", nextPath })
+        unlink(f.c_str());
+    return inPlace && sawEdit && replaced && sawFile && rs.failures == 0;
+}
+
+/* ===== MAIN ===== */
+
+int main(int argc, char** argv){
+    if(argc == 3 && string(argv[1]) == "--rss-of"){
+        double before = rssMiB();
+        HindiAI ai(argv[2]);
+        cout << rssMiB() - before << "\n";
+        return 0;
+    }
+
+    vector<string> suites(argv + 1, argv + argc);
+    bool ok = true;
+
+    if(wanted(suites, "enhancer")) ok = benchEnhancer() && ok;
+    if(wanted(suites, "dsp"))      ok = benchDsp() && ok;
+    if(wanted(suites, "simd"))     ok = benchSimd() && ok;
+    if(wanted(suites, "concurrency")) ok = benchConcurrency() && ok;
+    if(wanted(suites, "answers"))     ok = benchAnswers() && ok;
+    if(wanted(suites, "snapshot"))    ok = benchSnapshot() && ok;
+    if(wanted(suites, "intents"))     ok = benchIntents() && ok;
+    if(wanted(suites, "math"))        ok = benchMath() && ok;
+    if(wanted(suites, "relevance"))   ok = benchRelevance() && ok;
+    if(wanted(suites, "search"))      benchSearch();
+    if(wanted(suites, "scale"))       benchScale();
+    if(wanted(suites, "trace"))       ok = benchTrace() && ok;
+    if(wanted(suites, "reload"))      ok = benchReload() && ok;
+
+    return ok ? 0 : 1;
+}
@@ -0,0 +1,290 @@
+/*
+ * ============================================================
+ *  PRIMUS AI v2.0 — Block DSP Chain
+ *  Same voice as the old whole-buffer chain, in fixed blocks:
+ *
+ *   0. Litter Smoother   — running |x| sums either side
+ *   1. Gaussian Smooth   — 5-tap, sigma 1
+ *   2. Bass Boost        — one-pole low-pass mixed back in
+ *   3. Noise Gate        — |x| < 0.012 → 0
+ *   4. Normalize         — look-ahead peak hold, ramped gain
+ *   5. Soft Limiter      — tanh
+ *   6. Normalize         — constant: the limiter input peaks at
+ *                          0.90, so its output peak is known
+ *   7. Fade In/Out       — 15 ms
+ * ============================================================
+ */
+
+#include "dsp_chain.h"
+#include "dsp_kernels.h"
+
+#include <cmath>
+#include <algorithm>
+
+using namespace std;
+
+#define SAMPLE_RATE 22050
+
+/* ===== CONSTANTS (same values the old chain used) ===== */
+
+static const double LITTER_THRESHOLD = 0.04;
+static const double BASS_ALPHA       = 0.15;
+static const double BASS_AMOUNT      = 0.28;
+static const double GATE_THRESHOLD   = 0.012;
+static const double LEVEL_TARGET     = 0.90;
+static const double LIMIT_DRIVE      = 1.8;
+static const double FINAL_TARGET     = 0.92;
+static const size_t FADE_SAMPLES     = (SAMPLE_RATE * 15) / 1000;
+
+// Gaussian kernel, radius 2, sigma = radius / 2
+static const double G0 = 1.0;
+static const double G1 = exp(-0.5);
+static const double G2 = exp(-2.0);
+static const double GSUM = G0 + 2*G1 + 2*G2;
+static const double K0 = G0 / GSUM, K1 = G1 / GSUM, K2 = G2 / GSUM;
+
+/* ================================================================
+   VOICE FRONT — litter → gaussian → bass → gate
+================================================================ */
+
+void VoiceFront::reset(){
+    raw.clear();
+    lit.clear();
+    rawBase = litBase = 0;
+    total = litNext = outNext = 0;
+    leftSum = rightSum = 0;
+    lp = 0;
+}
+
+// Litter outputs for [litNext, end). Interior samples need W samples
+// of context either side; the first and last W pass through.
+void VoiceFront::litterUpTo(long long end, bool final){
+    const double quiet = W * LITTER_THRESHOLD * 0.5;
+
+    for(long long j = litNext; j < end; j++){
+        float x = rawAt(j);
+        float y = x;
+
+        bool interior = j >= W && (!final || j < total - W);
+        if(interior){
+            if(j == W){
+                leftSum = rightSum = 0;
+                for(int k = 1; k <= W; k++){
+                    leftSum  += fabs(rawAt(j - k));
+                    rightSum += fabs(rawAt(j + k));
+                }
+            } else {
+                leftSum  += fabs(rawAt(j - 1)) - fabs(rawAt(j - 1 - W));
+                rightSum += fabs(rawAt(j + W)) - fabs(x);
+            }
+            // Isolated spike: loud sample, silence both sides
+            if(fabs(x) >= LITTER_THRESHOLD && leftSum < quiet && rightSum < quiet)
+                y = (rawAt(j - 1) + rawAt(j + 1)) * 0.5f;
+        }
+        lit.push_back(y);
+    }
+    if(end > litNext) litNext = end;
+}
+
+// Outputs [outNext, end) into dst. Interior samples get the gaussian;
+// the first and last R keep the litter value, as the old chain did.
+void VoiceFront::finishUpTo(long long end, bool final, float* dst){
+    static const float K[3] = { (float)K0, (float)K1, (float)K2 };
+    const DspKernels& k = dspKernels();
+
+    size_t n = end - outNext;
+    smooth.resize(n);
+    long long a = max(outNext, (long long)R);
+    long long b = final ? min(end, total - R) : end;
+    for(long long i = outNext; i < end; i++)
+        if(i < a || i >= b) smooth[i - outNext] = litAt(i);
+    if(b > a)
+        k.gauss5(&lit[a - litBase], &smooth[a - outNext], b - a, K);
+
+    for(size_t j = 0; j < n; j++){
+        double g = smooth[j];
+        lp = (outNext + (long long)j == 0) ? g : BASS_ALPHA * g + (1.0 - BASS_ALPHA) * lp;
+        dst[j] = (float)(g + BASS_AMOUNT * lp);
+    }
+    k.gate(dst, n, GATE_THRESHOLD);
+    outNext = end;
+}
+
+// Keep only the context the next call needs
+void VoiceFront::trim(){
+    long long keepRaw = max(rawBase, litNext - W - 1);
+    raw.erase(raw.begin(), raw.begin() + (keepRaw - rawBase));
+    rawBase = keepRaw;
+
+    long long keepLit = max(litBase, outNext - R);
+    lit.erase(lit.begin(), lit.begin() + (keepLit - litBase));
+    litBase = keepLit;
+}
+
+size_t VoiceFront::process(float* buf, size_t n){
+    raw.insert(raw.end(), buf, buf + n);
+    total += n;
+
+    litterUpTo(total - W, false);
+
+    size_t w = max(0LL, litNext - R - outNext);
+    finishUpTo(outNext + w, false, buf);
+
+    trim();
+    return w;
+}
+
+void VoiceFront::flush(vector<float>& out){
+    litterUpTo(total, true);
+    size_t base = out.size();
+    out.resize(base + (total - outNext));
+    finishUpTo(total, true, out.data() + base);
+    reset();
+}
+
+/* ================================================================
+   VOICE LEVEL — look-ahead normalize → limiter → gain → fade
+
+   Every sample waits `lookahead` samples in a ring buffer. When a new
+   peak enters, the gain ramps linearly from its current value to
+   0.90 / peak over exactly that distance, so the peak leaves at
+   0.90 and the gain never steps. With the peak inside the first
+   window this is identical to the old global normalize.
+================================================================ */
+
+VoiceLevel::VoiceLevel(size_t la)
+    : lookahead(max(la, 4 * FADE_SAMPLES)), ring(lookahead + CHUNK), gains(CHUNK) {}
+
+void VoiceLevel::reset(){
+    ramps.clear();
+    inPos = outPos = 0;
+    peak      = 0;
+    floorGain = 1.0;
+    started   = false;
+    fadeIn    = 0;
+}
+
+double VoiceLevel::gainFor(double p) const {
+    return p < 1e-9 ? 1.0 : LEVEL_TARGET / p;
+}
+
+double VoiceLevel::gainPeek(long long i) const {
+    double g = floorGain;
+    for(auto& r : ramps)
+        g = min(g, r.at(i));
+    return g;
+}
+
+// Output positions only move forward, so finished ramps fold into
+// floorGain
+double VoiceLevel::gainAt(long long i){
+    while(!ramps.empty() && ramps.front().end < i){
+        floorGain = min(floorGain, ramps.front().to);
+        ramps.pop_front();
+    }
+    return ramps.empty() ? floorGain : gainPeek(i);
+}
+
+// Limiter + fade for the next n held samples (n <= CHUNK)
+void VoiceLevel::emit(float* out, size_t n){
+    static const float POST = FINAL_TARGET / tanh(LIMIT_DRIVE * LEVEL_TARGET);
+
+    for(size_t j = 0; j < n; j++){
+        gains[j] = gainAt(outPos + j);
+        out[j]   = slot(outPos + j);
+    }
+    dspKernels().softLimit(out, gains.data(), out, n, LIMIT_DRIVE, POST);
+
+    for(size_t j = 0; j < n && (size_t)(outPos + j) < fadeIn; j++)
+        out[j] *= (float)(outPos + j) / fadeIn;
+    outPos += n;
+}
+
+// Takes n <= CHUNK samples, writes the ones that leave the look-ahead
+size_t VoiceLevel::step(const float* in, size_t n, float* out){
+    // Most blocks hold no new peak: no ramps to add, just store them
+    if(started && dspKernels().peakAbs(in, n) <= peak){
+        for(size_t k = 0; k < n; k++) slot(inPos + k) = in[k];
+        inPos += n;
+    } else {
+        for(size_t k = 0; k < n; k++){
+            float x = in[k];
+            long long pos = inPos++;
+            slot(pos) = x;
+
+            if(fabs(x) > peak){
+                peak = fabs(x);
+                if(started){
+                    long long start = pos - (long long)lookahead;
+                    ramps.push_back({ start, pos, gainPeek(start), gainFor(peak) });
+                }
+            }
+            if(!started && pos == (long long)lookahead){
+                started   = true;
+                floorGain = gainFor(peak);
+                fadeIn    = FADE_SAMPLES;
+            }
+        }
+    }
+
+    long long ready = inPos - (long long)lookahead - outPos;
+    if(ready <= 0) return 0;
+    emit(out, ready);
+    return ready;
+}
+
+size_t VoiceLevel::process(float* buf, size_t n){
+    // Outputs never overtake inputs, so buf can hold both
+    size_t w = 0;
+    for(size_t off = 0; off < n; off += CHUNK)
+        w += step(buf + off, min(CHUNK, n - off), buf + w);
+    return w;
+}
+
+void VoiceLevel::flush(vector<float>& out){
+    long long n = inPos;
+    if(!started){
+        floorGain = gainFor(peak);
+        fadeIn    = min(FADE_SAMPLES, (size_t)n / 4);
+    }
+    size_t fadeOut = fadeIn > 0 ? fadeIn : min(FADE_SAMPLES, (size_t)n / 4);
+
+    size_t    base  = out.size();
+    long long first = outPos;
+    out.resize(base + (inPos - outPos));
+    for(size_t at = base; outPos < inPos; ){
+        size_t k = min((long long)CHUNK, inPos - outPos);
+        emit(out.data() + at, k);
+        at += k;
+    }
+
+    for(size_t t = 0; t < fadeOut; t++){
+        long long idx = n - 1 - (long long)t;
+        if(idx >= first)
+            out[base + (idx - first)] *= (float)t / fadeOut;
+    }
+    reset();
+}
+
+/* ================================================================
+   VOICE CHAIN
+================================================================ */
+
+void VoiceChain::reset(){
+    front.reset();
+    level.reset();
+    tail.clear();
+}
+
+size_t VoiceChain::process(float* buf, size_t n){
+    size_t m = front.process(buf, n);
+    return level.process(buf, m);
+}
+
+void VoiceChain::flush(vector<float>& out){
+    tail.clear();
+    front.flush(tail);
+    size_t k = level.process(tail.data(), tail.size());
+    out.insert(out.end(), tail.begin(), tail.begin() + k);
+    level.flush(out);
+}
@@ -0,0 +1,104 @@
+#pragma once
+#include <vector>
+#include <deque>
+#include <cstddef>
+#include <limits>
+
+/*
+ * Block-based voice DSP chain for TTS.
+ *
+ * Samples are float in [-1, 1]. Each stage keeps only the state it
+ * needs and works on the caller's block in place; stages with
+ * look-ahead hold samples back, so process() returns how many
+ * finished samples are now at the front of the block and flush()
+ * hands out the rest at the end of an utterance.
+ *
+ *   VoiceFront  litter smoother → gaussian → bass boost → noise gate
+ *               (one fused loop, 10 samples latency)
+ *   VoiceLevel  look-ahead peak normalize → tanh limiter →
+ *               final gain → fade in/out
+ */
+
+// Bump whenever the chain's output changes; it is part of the
+// phrase cache key, so stale cached audio is never replayed
+static const int DSP_VERSION = 1;
+
+class VoiceFront {
+public:
+    void   reset();
+    size_t process(float* buf, size_t n);
+    void   flush(std::vector<float>& out);
+
+private:
+    static const int W = 8;     // litter window
+    static const int R = 2;     // gaussian radius
+
+    std::vector<float> raw;     // raw[k]  = input sample rawBase + k
+    std::vector<float> lit;     // lit[k]  = litter output litBase + k
+    std::vector<float> smooth;  // gaussian output for one block
+    long long rawBase = 0, litBase = 0;
+    long long total   = 0;      // input samples seen
+    long long litNext = 0;      // next litter output to compute
+    long long outNext = 0;      // next gaussian/bass/gate output
+    double    leftSum = 0, rightSum = 0;   // Σ|raw| either side of litNext
+    double    lp      = 0;      // bass low-pass state
+
+    float rawAt(long long i) const { return raw[i - rawBase]; }
+    float litAt(long long i) const { return lit[i - litBase]; }
+
+    void  litterUpTo(long long end, bool final);
+    void  finishUpTo(long long end, bool final, float* dst);
+    void  trim();
+};
+
+class VoiceLevel {
+public:
+    explicit VoiceLevel(size_t lookahead = 8820);   // 400 ms @ 22050
+    void   reset();
+    size_t process(float* buf, size_t n);
+    void   flush(std::vector<float>& out);
+
+private:
+    static const size_t CHUNK = 256;   // samples moved per step
+
+    struct Ramp {                  // linear gain ramp ending on a peak
+        long long start, end;
+        double    from, to;
+        double at(long long i) const {
+            if(i < start) return std::numeric_limits<double>::infinity();
+            if(i >= end)  return to;
+            return from + (to - from) * double(i - start) / double(end - start);
+        }
+    };
+
+    size_t             lookahead;
+    std::vector<float> ring;       // held samples, ring[outPos % size] = next out
+    std::vector<float> gains;      // per-sample gain for one step
+    std::deque<Ramp>   ramps;
+    long long inPos   = 0;         // index of the next input sample
+    long long outPos  = 0;         // index of the next output sample
+    double    peak    = 0;
+    double    floorGain = 1.0;
+    bool      started = false;     // first sample emitted
+    size_t    fadeIn  = 0;
+
+    double gainFor(double p) const;
+    double gainAt(long long i);
+    double gainPeek(long long i) const;
+    size_t step(const float* in, size_t n, float* out);
+    void   emit(float* out, size_t n);
+    float& slot(long long i) { return ring[i % ring.size()]; }
+};
+
+class VoiceChain {
+public:
+    void   reset();
+    // Processes in place; returns finished samples at the front of buf
+    size_t process(float* buf, size_t n);
+    void   flush(std::vector<float>& out);
+
+private:
+    VoiceFront front;
+    VoiceLevel level;
+    std::vector<float> tail;
+};
@@ -0,0 +1,422 @@
+/*
+ * ============================================================
+ *  PRIMUS AI - DSP Kernels
+ *  scalar reference / SSE2 / AVX2 / NEON, picked at runtime
+ * ============================================================
+ */
+
+#include "dsp_kernels.h"
+
+#include <cmath>
+#include <cstdlib>
+#include <cstring>
+#include <algorithm>
+
+#if defined(__x86_64__)
+  #include <immintrin.h>
+  #define PRIMUS_X86 1
+#elif defined(__ARM_NEON) || defined(__aarch64__)
+  #include <arm_neon.h>
+  #define PRIMUS_NEON 1
+#endif
+
+using namespace std;
+
+/* ================================================================
+   SCALAR — the reference every other variant is checked against
+================================================================ */
+
+static void s16ToFloatScalar(const int16_t* in, float* out, size_t n){
+    for(size_t i = 0; i < n; i++) out[i] = in[i] / 32768.0f;
+}
+
+static void floatToS16Scalar(const float* in, int16_t* out, size_t n){
+    for(size_t i = 0; i < n; i++){
+        float v = max(-1.0f, min(1.0f, in[i]));
+        out[i] = static_cast<int16_t>(v * 32767);
+    }
+}
+
+static float peakAbsScalar(const float* x, size_t n){
+    float p = 0;
+    for(size_t i = 0; i < n; i++) p = max(p, fabsf(x[i]));
+    return p;
+}
+
+static void gateScalar(float* x, size_t n, float th){
+    for(size_t i = 0; i < n; i++) if(fabsf(x[i]) < th) x[i] = 0.0f;
+}
+
+static void gauss5Scalar(const float* in, float* out, size_t n, const float k[3]){
+    for(size_t i = 0; i < n; i++){
+        const float* c = in + i;
+        out[i] = k[2] * (c[-2] + c[2]) + k[1] * (c[-1] + c[1]) + k[0] * c[0];
+    }
+}
+
+static void softLimitScalar(const float* x, const float* g, float* out,
+                            size_t n, float drive, float post){
+    for(size_t i = 0; i < n; i++) out[i] = post * tanhf(drive * g[i] * x[i]);
+}
+
+static const DspKernels SCALAR = {
+    "scalar",
+    s16ToFloatScalar, floatToS16Scalar, peakAbsScalar,
+    gateScalar, gauss5Scalar, softLimitScalar,
+};
+
+/* ===== RATIONAL TANH =====
+   tanh(x) ≈ x·P(x²)/Q(x²), |x| clamped to 7.9 where it rounds to 1.
+   The vector variants use this form; the scalar copy handles tails
+   so a block gives the same result however it is split. */
+
+static const float TANH_CLAMP = 7.90531110763549805f;
+static const float TA1  =  4.89352455891786e-03f, TA3  =  6.37261928875436e-04f,
+                   TA5  =  1.48572235717979e-05f, TA7  =  5.12229709037114e-08f,
+                   TA9  = -8.60467152213735e-11f, TA11 =  2.00018790482477e-13f,
+                   TA13 = -2.76076847742355e-16f;
+static const float TB0  =  4.89352518554385e-03f, TB2  =  2.26843463243900e-03f,
+                   TB4  =  1.18534705686654e-04f, TB6  =  1.19825839466702e-06f;
+
+[[maybe_unused]] static inline float tanhRational(float x){
+    x = max(-TANH_CLAMP, min(TANH_CLAMP, x));
+    float x2 = x * x;
+    float p = TA13;
+    p = p * x2 + TA11; p = p * x2 + TA9; p = p * x2 + TA7;
+    p = p * x2 + TA5;  p = p * x2 + TA3; p = p * x2 + TA1;
+    float q = TB6;
+    q = q * x2 + TB4;  q = q * x2 + TB2; q = q * x2 + TB0;
+    return x * p / q;
+}
+
+/* ================================================================
+   SSE2 / AVX2
+================================================================ */
+
+#ifdef PRIMUS_X86
+
+static void s16ToFloatSse2(const int16_t* in, float* out, size_t n){
+    const __m128 scale = _mm_set1_ps(1.0f / 32768);
+    size_t i = 0;
+    for(; i + 8 <= n; i += 8){
+        __m128i v  = _mm_loadu_si128((const __m128i*)(in + i));
+        __m128i lo = _mm_srai_epi32(_mm_unpacklo_epi16(v, v), 16);
+        __m128i hi = _mm_srai_epi32(_mm_unpackhi_epi16(v, v), 16);
+        _mm_storeu_ps(out + i,     _mm_mul_ps(_mm_cvtepi32_ps(lo), scale));
+        _mm_storeu_ps(out + i + 4, _mm_mul_ps(_mm_cvtepi32_ps(hi), scale));
+    }
+    s16ToFloatScalar(in + i, out + i, n - i);
+}
+
+static void floatToS16Sse2(const float* in, int16_t* out, size_t n){
+    const __m128 lo = _mm_set1_ps(-1.0f), hi = _mm_set1_ps(1.0f);
+    const __m128 full = _mm_set1_ps(32767.0f);
+    size_t i = 0;
+    for(; i + 8 <= n; i += 8){
+        __m128 a = _mm_min_ps(_mm_max_ps(_mm_loadu_ps(in + i),     lo), hi);
+        __m128 b = _mm_min_ps(_mm_max_ps(_mm_loadu_ps(in + i + 4), lo), hi);
+        __m128i ia = _mm_cvttps_epi32(_mm_mul_ps(a, full));
+        __m128i ib = _mm_cvttps_epi32(_mm_mul_ps(b, full));
+        _mm_storeu_si128((__m128i*)(out + i), _mm_packs_epi32(ia, ib));
+    }
+    floatToS16Scalar(in + i, out + i, n - i);
+}
+
+static float peakAbsSse2(const float* x, size_t n){
+    const __m128 mask = _mm_castsi128_ps(_mm_set1_epi32(0x7fffffff));
+    __m128 m = _mm_setzero_ps();
+    size_t i = 0;
+    for(; i + 4 <= n; i += 4)
+        m = _mm_max_ps(m, _mm_and_ps(_mm_loadu_ps(x + i), mask));
+    m = _mm_max_ps(m, _mm_shuffle_ps(m, m, _MM_SHUFFLE(1, 0, 3, 2)));
+    m = _mm_max_ps(m, _mm_shuffle_ps(m, m, _MM_SHUFFLE(2, 3, 0, 1)));
+    return max(_mm_cvtss_f32(m), peakAbsScalar(x + i, n - i));
+}
+
+static void gateSse2(float* x, size_t n, float th){
+    const __m128 mask = _mm_castsi128_ps(_mm_set1_epi32(0x7fffffff));
+    const __m128 t    = _mm_set1_ps(th);
+    size_t i = 0;
+    for(; i + 4 <= n; i += 4){
+        __m128 v = _mm_loadu_ps(x + i);
+        __m128 keep = _mm_cmpge_ps(_mm_and_ps(v, mask), t);
+        _mm_storeu_ps(x + i, _mm_and_ps(v, keep));
+    }
+    gateScalar(x + i, n - i, th);
+}
+
+static void gauss5Sse2(const float* in, float* out, size_t n, const float k[3]){
+    const __m128 k0 = _mm_set1_ps(k[0]), k1 = _mm_set1_ps(k[1]), k2 = _mm_set1_ps(k[2]);
+    size_t i = 0;
+    for(; i + 4 <= n; i += 4){
+        const float* c = in + i;
+        __m128 outer = _mm_add_ps(_mm_loadu_ps(c - 2), _mm_loadu_ps(c + 2));
+        __m128 inner = _mm_add_ps(_mm_loadu_ps(c - 1), _mm_loadu_ps(c + 1));
+        __m128 v = _mm_add_ps(_mm_add_ps(_mm_mul_ps(k2, outer), _mm_mul_ps(k1, inner)),
+                              _mm_mul_ps(k0, _mm_loadu_ps(c)));
+        _mm_storeu_ps(out + i, v);
+    }
+    gauss5Scalar(in + i, out + i, n - i, k);
+}
+
+static inline __m128 tanhSse2(__m128 x){
+    x = _mm_max_ps(_mm_set1_ps(-TANH_CLAMP), _mm_min_ps(_mm_set1_ps(TANH_CLAMP), x));
+    __m128 x2 = _mm_mul_ps(x, x);
+    __m128 p = _mm_set1_ps(TA13);
+    for(float a : { TA11, TA9, TA7, TA5, TA3, TA1 })
+        p = _mm_add_ps(_mm_mul_ps(p, x2), _mm_set1_ps(a));
+    __m128 q = _mm_set1_ps(TB6);
+    for(float b : { TB4, TB2, TB0 })
+        q = _mm_add_ps(_mm_mul_ps(q, x2), _mm_set1_ps(b));
+    return _mm_div_ps(_mm_mul_ps(x, p), q);
+}
+
+static void softLimitSse2(const float* x, const float* g, float* out,
+                          size_t n, float drive, float post){
+    const __m128 d = _mm_set1_ps(drive), s = _mm_set1_ps(post);
+    size_t i = 0;
+    for(; i + 4 <= n; i += 4){
+        __m128 v = _mm_mul_ps(_mm_mul_ps(d, _mm_loadu_ps(g + i)), _mm_loadu_ps(x + i));
+        _mm_storeu_ps(out + i, _mm_mul_ps(s, tanhSse2(v)));
+    }
+    for(; i < n; i++) out[i] = post * tanhRational(drive * g[i] * x[i]);
+}
+
+static const DspKernels SSE2 = {
+    "sse2",
+    s16ToFloatSse2, floatToS16Sse2, peakAbsSse2,
+    gateSse2, gauss5Sse2, softLimitSse2,
+};
+
+// AVX2 code is compiled per function so the binary still runs on
+// CPUs without it; dspKernels() only selects it after a CPUID check.
+#define AVX2_FN __attribute__((target("avx2")))
+
+AVX2_FN static void s16ToFloatAvx2(const int16_t* in, float* out, size_t n){
+    const __m256 scale = _mm256_set1_ps(1.0f / 32768);
+    size_t i = 0;
+    for(; i + 8 <= n; i += 8){
+        __m256i v = _mm256_cvtepi16_epi32(_mm_loadu_si128((const __m128i*)(in + i)));
+        _mm256_storeu_ps(out + i, _mm256_mul_ps(_mm256_cvtepi32_ps(v), scale));
+    }
+    s16ToFloatScalar(in + i, out + i, n - i);
+}
+
+AVX2_FN static void floatToS16Avx2(const float* in, int16_t* out, size_t n){
+    const __m256 lo = _mm256_set1_ps(-1.0f), hi = _mm256_set1_ps(1.0f);
+    const __m256 full = _mm256_set1_ps(32767.0f);
+    size_t i = 0;
+    for(; i + 16 <= n; i += 16){
+        __m256 a = _mm256_min_ps(_mm256_max_ps(_mm256_loadu_ps(in + i),     lo), hi);
+        __m256 b = _mm256_min_ps(_mm256_max_ps(_mm256_loadu_ps(in + i + 8), lo), hi);
+        __m256i p = _mm256_packs_epi32(_mm256_cvttps_epi32(_mm256_mul_ps(a, full)),
+                                       _mm256_cvttps_epi32(_mm256_mul_ps(b, full)));
+        // packs works per 128-bit lane; put the quarters back in order
+        _mm256_storeu_si256((__m256i*)(out + i), _mm256_permute4x64_epi64(p, 0xD8));
+    }
+    floatToS16Sse2(in + i, out + i, n - i);
+}
+
+AVX2_FN static float peakAbsAvx2(const float* x, size_t n){
+    const __m256 mask = _mm256_castsi256_ps(_mm256_set1_epi32(0x7fffffff));
+    __m256 m = _mm256_setzero_ps();
+    size_t i = 0;
+    for(; i + 8 <= n; i += 8)
+        m = _mm256_max_ps(m, _mm256_and_ps(_mm256_loadu_ps(x + i), mask));
+    __m128 h = _mm_max_ps(_mm256_castps256_ps128(m), _mm256_extractf128_ps(m, 1));
+    h = _mm_max_ps(h, _mm_shuffle_ps(h, h, _MM_SHUFFLE(1, 0, 3, 2)));
+    h = _mm_max_ps(h, _mm_shuffle_ps(h, h, _MM_SHUFFLE(2, 3, 0, 1)));
+    return max(_mm_cvtss_f32(h), peakAbsScalar(x + i, n - i));
+}
+
+AVX2_FN static void gateAvx2(float* x, size_t n, float th){
+    const __m256 mask = _mm256_castsi256_ps(_mm256_set1_epi32(0x7fffffff));
+    const __m256 t    = _mm256_set1_ps(th);
+    size_t i = 0;
+    for(; i + 8 <= n; i += 8){
+        __m256 v = _mm256_loadu_ps(x + i);
+        __m256 keep = _mm256_cmp_ps(_mm256_and_ps(v, mask), t, _CMP_GE_OQ);
+        _mm256_storeu_ps(x + i, _mm256_and_ps(v, keep));
+    }
+    gateScalar(x + i, n - i, th);
+}
+
+AVX2_FN static void gauss5Avx2(const float* in, float* out, size_t n, const float k[3]){
+    const __m256 k0 = _mm256_set1_ps(k[0]), k1 = _mm256_set1_ps(k[1]), k2 = _mm256_set1_ps(k[2]);
+    size_t i = 0;
+    for(; i + 8 <= n; i += 8){
+        const float* c = in + i;
+        __m256 outer = _mm256_add_ps(_mm256_loadu_ps(c - 2), _mm256_loadu_ps(c + 2));
+        __m256 inner = _mm256_add_ps(_mm256_loadu_ps(c - 1), _mm256_loadu_ps(c + 1));
+        __m256 v = _mm256_add_ps(_mm256_add_ps(_mm256_mul_ps(k2, outer), _mm256_mul_ps(k1, inner)),
+                                 _mm256_mul_ps(k0, _mm256_loadu_ps(c)));
+        _mm256_storeu_ps(out + i, v);
+    }
+    gauss5Scalar(in + i, out + i, n - i, k);
+}
+
+AVX2_FN static inline __m256 tanhAvx2(__m256 x){
+    x = _mm256_max_ps(_mm256_set1_ps(-TANH_CLAMP), _mm256_min_ps(_mm256_set1_ps(TANH_CLAMP), x));
+    __m256 x2 = _mm256_mul_ps(x, x);
+    __m256 p = _mm256_set1_ps(TA13);
+    for(float a : { TA11, TA9, TA7, TA5, TA3, TA1 })
+        p = _mm256_add_ps(_mm256_mul_ps(p, x2), _mm256_set1_ps(a));
+    __m256 q = _mm256_set1_ps(TB6);
+    for(float b : { TB4, TB2, TB0 })
+        q = _mm256_add_ps(_mm256_mul_ps(q, x2), _mm256_set1_ps(b));
+    return _mm256_div_ps(_mm256_mul_ps(x, p), q);
+}
+
+AVX2_FN static void softLimitAvx2(const float* x, const float* g, float* out,
+                                  size_t n, float drive, float post){
+    const __m256 d = _mm256_set1_ps(drive), s = _mm256_set1_ps(post);
+    size_t i = 0;
+    for(; i + 8 <= n; i += 8){
+        __m256 v = _mm256_mul_ps(_mm256_mul_ps(d, _mm256_loadu_ps(g + i)), _mm256_loadu_ps(x + i));
+        _mm256_storeu_ps(out + i, _mm256_mul_ps(s, tanhAvx2(v)));
+    }
+    for(; i < n; i++) out[i] = post * tanhRational(drive * g[i] * x[i]);
+}
+
+static const DspKernels AVX2 = {
+    "avx2",
+    s16ToFloatAvx2, floatToS16Avx2, peakAbsAvx2,
+    gateAvx2, gauss5Avx2, softLimitAvx2,
+};
+
+#endif // PRIMUS_X86
+
+/* ================================================================
+   NEON — Raspberry Pi (aarch64, or armv7 built with -mfpu=neon)
+================================================================ */
+
+#ifdef PRIMUS_NEON
+
+static void s16ToFloatNeon(const int16_t* in, float* out, size_t n){
+    const float scale = 1.0f / 32768;
+    size_t i = 0;
+    for(; i + 8 <= n; i += 8){
+        int16x8_t v = vld1q_s16(in + i);
+        vst1q_f32(out + i,     vmulq_n_f32(vcvtq_f32_s32(vmovl_s16(vget_low_s16(v))),  scale));
+        vst1q_f32(out + i + 4, vmulq_n_f32(vcvtq_f32_s32(vmovl_s16(vget_high_s16(v))), scale));
+    }
+    s16ToFloatScalar(in + i, out + i, n - i);
+}
+
+static void floatToS16Neon(const float* in, int16_t* out, size_t n){
+    const float32x4_t lo = vdupq_n_f32(-1.0f), hi = vdupq_n_f32(1.0f);
+    size_t i = 0;
+    for(; i + 8 <= n; i += 8){
+        float32x4_t a = vminq_f32(vmaxq_f32(vld1q_f32(in + i),     lo), hi);
+        float32x4_t b = vminq_f32(vmaxq_f32(vld1q_f32(in + i + 4), lo), hi);
+        // vcvtq_s32_f32 truncates toward zero, like the scalar cast
+        int32x4_t ia = vcvtq_s32_f32(vmulq_n_f32(a, 32767.0f));
+        int32x4_t ib = vcvtq_s32_f32(vmulq_n_f32(b, 32767.0f));
+        vst1q_s16(out + i, vcombine_s16(vqmovn_s32(ia), vqmovn_s32(ib)));
+    }
+    floatToS16Scalar(in + i, out + i, n - i);
+}
+
+static float peakAbsNeon(const float* x, size_t n){
+    float32x4_t m = vdupq_n_f32(0);
+    size_t i = 0;
+    for(; i + 4 <= n; i += 4)
+        m = vmaxq_f32(m, vabsq_f32(vld1q_f32(x + i)));
+    float32x2_t h = vpmax_f32(vget_low_f32(m), vget_high_f32(m));
+    h = vpmax_f32(h, h);
+    return max(vget_lane_f32(h, 0), peakAbsScalar(x + i, n - i));
+}
+
+static void gateNeon(float* x, size_t n, float th){
+    const float32x4_t t = vdupq_n_f32(th);
+    size_t i = 0;
+    for(; i + 4 <= n; i += 4){
+        float32x4_t v = vld1q_f32(x + i);
+        uint32x4_t keep = vcgeq_f32(vabsq_f32(v), t);
+        vst1q_f32(x + i, vreinterpretq_f32_u32(vandq_u32(vreinterpretq_u32_f32(v), keep)));
+    }
+    gateScalar(x + i, n - i, th);
+}
+
+// vmul + vadd rather than vmla so no lane is fused differently
+static void gauss5Neon(const float* in, float* out, size_t n, const float k[3]){
+    size_t i = 0;
+    for(; i + 4 <= n; i += 4){
+        const float* c = in + i;
+        float32x4_t outer = vaddq_f32(vld1q_f32(c - 2), vld1q_f32(c + 2));
+        float32x4_t inner = vaddq_f32(vld1q_f32(c - 1), vld1q_f32(c + 1));
+        float32x4_t v = vaddq_f32(vaddq_f32(vmulq_n_f32(outer, k[2]), vmulq_n_f32(inner, k[1])),
+                                  vmulq_n_f32(vld1q_f32(c), k[0]));
+        vst1q_f32(out + i, v);
+    }
+    gauss5Scalar(in + i, out + i, n - i, k);
+}
+
+static inline float32x4_t tanhNeon(float32x4_t x){
+    x = vmaxq_f32(vdupq_n_f32(-TANH_CLAMP), vminq_f32(vdupq_n_f32(TANH_CLAMP), x));
+    float32x4_t x2 = vmulq_f32(x, x);
+    float32x4_t p = vdupq_n_f32(TA13);
+    for(float a : { TA11, TA9, TA7, TA5, TA3, TA1 })
+        p = vaddq_f32(vmulq_f32(p, x2), vdupq_n_f32(a));
+    float32x4_t q = vdupq_n_f32(TB6);
+    for(float b : { TB4, TB2, TB0 })
+        q = vaddq_f32(vmulq_f32(q, x2), vdupq_n_f32(b));
+#ifdef __aarch64__
+    return vdivq_f32(vmulq_f32(x, p), q);
+#else
+    // armv7 has no vector divide: reciprocal estimate + two Newton steps
+    float32x4_t r = vrecpeq_f32(q);
+    r = vmulq_f32(r, vrecpsq_f32(q, r));
+    r = vmulq_f32(r, vrecpsq_f32(q, r));
+    return vmulq_f32(vmulq_f32(x, p), r);
+#endif
+}
+
+static void softLimitNeon(const float* x, const float* g, float* out,
+                          size_t n, float drive, float post){
+    size_t i = 0;
+    for(; i + 4 <= n; i += 4){
+        float32x4_t v = vmulq_f32(vmulq_n_f32(vld1q_f32(g + i), drive), vld1q_f32(x + i));
+        vst1q_f32(out + i, vmulq_n_f32(tanhNeon(v), post));
+    }
+    for(; i < n; i++) out[i] = post * tanhRational(drive * g[i] * x[i]);
+}
+
+static const DspKernels NEON = {
+    "neon",
+    s16ToFloatNeon, floatToS16Neon, peakAbsNeon,
+    gateNeon, gauss5Neon, softLimitNeon,
+};
+
+#endif // PRIMUS_NEON
+
+/* ================================================================
+   DISPATCH
+================================================================ */
+
+vector<const DspKernels*> availableDspKernels(){
+    vector<const DspKernels*> out = { &SCALAR };
+#ifdef PRIMUS_X86
+    __builtin_cpu_init();
+    if(__builtin_cpu_supports("sse2")) out.push_back(&SSE2);
+    if(__builtin_cpu_supports("avx2")) out.push_back(&AVX2);
+#endif
+#ifdef PRIMUS_NEON
+    out.push_back(&NEON);
+#endif
+    return out;
+}
+
+static const DspKernels* chooseKernels(){
+    vector<const DspKernels*> all = availableDspKernels();
+    if(const char* want = getenv("PRIMUS_SIMD")){
+        for(auto k : all)
+            if(strcmp(k->name, want) == 0) return k;
+    }
+    return all.back();
+}
+
+const DspKernels& dspKernels(){
+    static const DspKernels* chosen = chooseKernels();
+    return *chosen;
+}
@@ -0,0 +1,44 @@
+#pragma once
+#include <cstddef>
+#include <cstdint>
+#include <vector>
+
+/*
+ * Vector kernels behind the TTS DSP chain.
+ *
+ * Every variant implements the same table; dspKernels() picks the
+ * widest one the CPU supports on first use (AVX2 → SSE2 on x86-64,
+ * NEON on ARM, scalar elsewhere). PRIMUS_SIMD=scalar|sse2|avx2|neon
+ * forces a variant, e.g. to compare output on a Pi.
+ *
+ * The scalar table is the reference. Conversions, peak and gate are
+ * bit-exact across variants; gauss5 may differ in the last bit where
+ * the compiler contracts the scalar loop into fused multiply-adds,
+ * and the vector softLimit replaces tanhf with a rational
+ * approximation a few ulp away from it.
+ */
+
+struct DspKernels {
+    const char* name;
+
+    // out[i] = in[i] / 32768
+    void  (*s16ToFloat)(const int16_t* in, float* out, size_t n);
+    // out[i] = trunc(clamp(in[i], -1, 1) * 32767)
+    void  (*floatToS16)(const float* in, int16_t* out, size_t n);
+    // max |x[i]|, 0 for n == 0
+    float (*peakAbs)(const float* x, size_t n);
+    // x[i] = 0 where |x[i]| < threshold
+    void  (*gate)(float* x, size_t n, float threshold);
+    // out[i] = k[2]*(in[i-2]+in[i+2]) + k[1]*(in[i-1]+in[i+1]) + k[0]*in[i];
+    // reads in[-2 .. n+1]
+    void  (*gauss5)(const float* in, float* out, size_t n, const float k[3]);
+    // out[i] = post * tanh(drive * gain[i] * x[i]); out may alias x
+    void  (*softLimit)(const float* x, const float* gain, float* out,
+                       size_t n, float drive, float post);
+};
+
+// Best variant for this CPU (or PRIMUS_SIMD), chosen once
+const DspKernels& dspKernels();
+
+// Every variant this build and CPU can run, scalar first
+std::vector<const DspKernels*> availableDspKernels();
@@ -16,6 +16,7 @@ Enhancer::Enhancer(){
     lastTopic = "";
     loadSynonyms();
     loadExpansions();
+    compileRewriter();
 }
 
 /* ===== SYNONYMS ===== */
@@ -94,7 +95,7 @@ void Enhancer::loadExpansions(){
 
 /* ===== LOWERCASE (ASCII only) ===== */
 
-string Enhancer::toLower(const string& text){
+string Enhancer::toLower(const string& text) const {
     string result = text;
     transform(result.begin(), result.end(), result.begin(),
               [](unsigned char c){ return tolower(c); });
@@ -103,7 +104,7 @@ string Enhancer::toLower(const string& text){
 
 /* ===== REMOVE PUNCTUATION ===== */
 
-string Enhancer::removePunctuation(const string& text){
+string Enhancer::removePunctuation(const string& text) const {
     string result;
     for(unsigned char c : text){
         if(isalnum(c) || c >= 128 || c == ' ')
@@ -112,36 +113,77 @@ string Enhancer::removePunctuation(const string& text){
     return result;
 }
 
-/* ===== NORMALIZE SYNONYMS ===== */
+/* ===== COMPILE REWRITER =====
+   Synonyms used to run first and short forms second over the
+   result, so "ipc" → "आईपीसी" → "भारतीय दंड संहिता". That chain is
+   resolved here once: synonym targets are rewritten through the
+   short forms, then both tables go into a single automaton. */
 
-string Enhancer::normalizeSynonyms(const string& text){
-    string s = text;
-    for(auto& [from, to] : synonymMap){
-        size_t pos;
-        while((pos = s.find(from)) != string::npos)
-            s.replace(pos, from.length(), to);
+void Enhancer::compileRewriter(){
+    rewriter.clear();
+    replacements.clear();
+    for(auto& [abbr, full] : shortExpansions){
+        rewriter.add(abbr, replacements.size());
+        replacements.push_back(full);
     }
-    return s;
+    rewriter.compile();
+
+    vector<pair<string, string>> resolved;
+    for(auto& [from, to] : synonymMap)
+        resolved.push_back({from, rewrite(to)});
+
+    // Synonyms are added first so they win a key shared with short forms
+    rewriter.clear();
+    replacements.clear();
+    for(auto& [from, to] : resolved){
+        rewriter.add(from, replacements.size());
+        replacements.push_back(to);
+    }
+    for(auto& [abbr, full] : shortExpansions){
+        rewriter.add(abbr, replacements.size());
+        replacements.push_back(full);
+    }
+    rewriter.compile();
 }
 
-/* ===== EXPAND SHORT FORMS ===== */
+/* ===== REWRITE (one pass, whole words only) ===== */
 
-string Enhancer::expandShortForms(const string& text){
-    string s = text;
-    for(auto& [abbr, full] : shortExpansions){
-        size_t pos;
-        while((pos = s.find(abbr)) != string::npos)
-            s.replace(pos, abbr.length(), full);
+string Enhancer::rewrite(const string& text) const {
+    thread_local vector<PhraseMatch> matches;
+    rewriter.findAll(text, matches);
+    if(matches.empty()) return text;
+
+    string s;
+    s.reserve(text.size() + 32);
+    size_t pos = 0;
+    for(auto& m : matches){
+        s.append(text, pos, m.start - pos);
+        s += replacements[m.id];
+        pos = m.start + m.length;
     }
+    s.append(text, pos, string::npos);
     return s;
 }
 
+/* ===== FINGERPRINT (FNV-1a over both dictionaries) ===== */
+
+uint64_t Enhancer::fingerprint() const {
+    uint64_t h = 1469598103934665603ULL;
+    auto mix = [&](const string& s){
+        for(unsigned char c : s){ h ^= c; h *= 1099511628211ULL; }
+        h ^= 0xFF;                      // separator: "ab"+"c" != "a"+"bc"
+        h *= 1099511628211ULL;
+    };
+    for(auto* table : { &synonymMap, &shortExpansions })
+        for(auto& [from, to] : *table){ mix(from); mix(to); }
+    return h;
+}
+
 /* ===== PREPROCESS (main pipeline) ===== */
 
-string Enhancer::preprocess(const string& input){
+string Enhancer::preprocess(const string& input) const {
     string s = toLower(input);
-    s = normalizeSynonyms(s);
-    s = expandShortForms(s);
+    s = rewrite(s);
     s = removePunctuation(s);
     return s;
 }
@@ -2,24 +2,39 @@
 #include <string>
 #include <map>
 #include <vector>
+#include <cstdint>
+
+#include "phrase_matcher.h"
 
 class Enhancer {
 public:
     Enhancer();
-    std::string preprocess(const std::string& input);
+    std::string preprocess(const std::string& input) const;
     std::string applyContext(const std::string& input);
     std::string expandAnswer(const std::string& answer);
 
+    // Hash of the rewrite dictionaries. Anything built from
+    // preprocess() output (a knowledge snapshot) records it.
+    uint64_t fingerprint() const;
+
+    // Source dictionaries (read-only, for tools and benchmarks)
+    const std::map<std::string, std::string>& getSynonyms()   const { return synonymMap; }
+    const std::map<std::string, std::string>& getShortForms() const { return shortExpansions; }
+
 private:
     std::string lastTopic;
     std::map<std::string, std::string> synonymMap;
     std::map<std::string, std::string> shortExpansions;
 
+    // Both dictionaries compiled into one automaton at construction
+    PhraseMatcher            rewriter;
+    std::vector<std::string> replacements;   // match id → replacement
+
     void loadSynonyms();
     void loadExpansions();
+    void compileRewriter();
 
-    std::string removePunctuation(const std::string& text);
-    std::string normalizeSynonyms(const std::string& text);
-    std::string expandShortForms(const std::string& text);
-    std::string toLower(const std::string& text);
+    std::string removePunctuation(const std::string& text) const;
+    std::string rewrite(const std::string& text) const;
+    std::string toLower(const std::string& text) const;
 };
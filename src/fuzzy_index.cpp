@@ -0,0 +1,167 @@
+/*
+ * ============================================================
+ *  PRIMUS AI - Fuzzy Index
+ *  Code-point Levenshtein (Myers bit-parallel) + BK-tree
+ * ============================================================
+ */
+
+#include "fuzzy_index.h"
+
+#include <algorithm>
+
+using namespace std;
+
+/* ===== UTF-8 → CODE POINTS ===== */
+
+u32string toCodePoints(const string& s){
+    u32string out;
+    out.reserve(s.size());
+    for(size_t i = 0; i < s.size(); ){
+        unsigned char c = s[i];
+        int extra = (c < 0x80) ? 0 : (c >= 0xF0) ? 3 : (c >= 0xE0) ? 2 : 1;
+        char32_t cp = (extra == 0) ? c : (c & (0x3F >> extra));
+        for(int k = 1; k <= extra && i + k < s.size(); k++)
+            cp = (cp << 6) | (s[i + k] & 0x3F);
+        out.push_back(cp);
+        i += extra + 1;
+    }
+    return out;
+}
+
+/* ================================================================
+   MYERS / HYYRÖ BIT-PARALLEL DISTANCE (pattern ≤ 64 code points)
+   One 64-bit column of the DP matrix per text character.
+================================================================ */
+
+namespace {
+
+struct MyersPattern {
+    vector<pair<char32_t, uint64_t>> peq;   // code point → match mask
+    int      m    = 0;
+    uint64_t high = 0;
+
+    explicit MyersPattern(const u32string& p) : m(p.size()) {
+        if(m == 0) return;
+        high = 1ULL << (m - 1);
+        for(int i = 0; i < m; i++){
+            auto it = find_if(peq.begin(), peq.end(),
+                              [&](auto& e){ return e.first == p[i]; });
+            if(it == peq.end()) peq.push_back({p[i], 1ULL << i});
+            else                it->second |= 1ULL << i;
+        }
+    }
+
+    uint64_t mask(char32_t c) const {
+        for(auto& e : peq) if(e.first == c) return e.second;
+        return 0;
+    }
+
+    int distance(const u32string& t) const {
+        if(m == 0) return t.size();
+        uint64_t pv = ~0ULL, mv = 0;
+        int score = m;
+        for(char32_t c : t){
+            uint64_t eq = mask(c);
+            uint64_t xv = eq | mv;
+            uint64_t xh = (((eq & pv) + pv) ^ pv) | eq;
+            uint64_t ph = mv | ~(xh | pv);
+            uint64_t mh = pv & xh;
+            if(ph & high)      score++;
+            else if(mh & high) score--;
+            ph = (ph << 1) | 1;     // row 0 grows by one per column
+            mh <<= 1;
+            pv = mh | ~(xv | ph);
+            mv = ph & xv;
+        }
+        return score;
+    }
+};
+
+// Two-row DP for words longer than 64 code points
+int dpDistance(const u32string& a, const u32string& b){
+    vector<int> prev(b.size() + 1), cur(b.size() + 1);
+    for(size_t j = 0; j <= b.size(); j++) prev[j] = j;
+    for(size_t i = 1; i <= a.size(); i++){
+        cur[0] = i;
+        for(size_t j = 1; j <= b.size(); j++)
+            cur[j] = min({ prev[j] + 1, cur[j-1] + 1,
+                           prev[j-1] + (a[i-1] != b[j-1] ? 1 : 0) });
+        swap(prev, cur);
+    }
+    return prev[b.size()];
+}
+
+int patternDistance(const MyersPattern& p, const u32string& pattern,
+                    const u32string& text)
+{
+    return pattern.size() <= 64 ? p.distance(text) : dpDistance(pattern, text);
+}
+
+} // namespace
+
+int editDistance(const u32string& a, const u32string& b){
+    if(a.size() <= 64) return MyersPattern(a).distance(b);
+    if(b.size() <= 64) return MyersPattern(b).distance(a);
+    return dpDistance(a, b);
+}
+
+/* ================================================================
+   BK-TREE
+================================================================ */
+
+void FuzzyIndex::clear(){
+    nodes.clear();
+}
+
+void FuzzyIndex::build(const vector<string>& words){
+    clear();
+    nodes.reserve(words.size());
+    for(auto& w : words) insert(w);
+}
+
+void FuzzyIndex::insert(const string& word){
+    u32string cps = toCodePoints(word);
+    if(nodes.empty()){
+        nodes.push_back({word, cps, {}});
+        return;
+    }
+
+    MyersPattern pat(cps);
+    int cur = 0;
+    while(true){
+        int d = patternDistance(pat, cps, nodes[cur].cps);
+        if(d == 0) return;                       // duplicate
+        auto& kids = nodes[cur].children;
+        auto it = find_if(kids.begin(), kids.end(),
+                          [d](auto& e){ return e.first == d; });
+        if(it == kids.end()){
+            kids.push_back({d, (int)nodes.size()});
+            nodes.push_back({word, move(cps), {}});
+            return;
+        }
+        cur = it->second;
+    }
+}
+
+void FuzzyIndex::lookup(const u32string& query, int radius,
+                        vector<FuzzyCandidate>& out) const
+{
+    out.clear();
+    if(nodes.empty()) return;
+
+    MyersPattern pat(query);
+    vector<int> stack = {0};
+    while(!stack.empty()){
+        const Node& n = nodes[stack.back()];
+        stack.pop_back();
+
+        int d = patternDistance(pat, query, n.cps);
+        if(d <= radius)
+            out.push_back({&n.word, d, (int)n.cps.size()});
+
+        // Triangle inequality: only children with |edge - d| ≤ radius
+        for(auto& [edge, child] : n.children)
+            if(edge >= d - radius && edge <= d + radius)
+                stack.push_back(child);
+    }
+}
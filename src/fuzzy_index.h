@@ -0,0 +1,44 @@
+#pragma once
+#include <string>
+#include <vector>
+#include <cstdint>
+
+/*
+ * Fuzzy word lookup for STT correction.
+ * Distances are Levenshtein over Unicode code points (one Devanagari
+ * matra = 1 edit, not 3 bytes). Words up to 64 code points use the
+ * Myers/Hyyrö bit-parallel recurrence; longer ones fall back to a
+ * two-row DP. The vocabulary lives in a BK-tree, so a lookup with
+ * radius r only visits subtrees whose edge distance is within r.
+ */
+
+std::u32string toCodePoints(const std::string& utf8);
+int editDistance(const std::u32string& a, const std::u32string& b);
+
+struct FuzzyCandidate {
+    const std::string* word;   // points into the index
+    int                distance;
+    int                length; // in code points
+};
+
+class FuzzyIndex {
+public:
+    void   build(const std::vector<std::string>& words);
+    void   clear();
+    bool   empty() const { return nodes.empty(); }
+    size_t size()  const { return nodes.size(); }
+
+    // All words within radius of query (code-point edits)
+    void lookup(const std::u32string& query, int radius,
+                std::vector<FuzzyCandidate>& out) const;
+
+private:
+    struct Node {
+        std::string    word;
+        std::u32string cps;
+        std::vector<std::pair<int, int>> children;   // (edge distance, node)
+    };
+    std::vector<Node> nodes;
+
+    void insert(const std::string& word);
+};
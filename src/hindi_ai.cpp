@@ -6,23 +6,21 @@
  */
 
 #include "hindi_ai.h"
-#include "enhancer.h"
-#include "intelligence.h"
+#include "trace.h"
 
 #include <iostream>
 #include <sstream>
 #include <algorithm>
 #include <vector>
 #include <set>
-#include <cstdlib>
-#include <ctime>
 #include <cctype>
+#include <unistd.h>
+#include <sys/stat.h>
+#include <sys/resource.h>
+#include <sys/syscall.h>
 
 using namespace std;
 
-static Enhancer    enhancer;
-static Intelligence brain;
-
 /* ===== STOP WORDS (Hindi + English) ===== */
 
 static const set<string> STOP_WORDS = {
@@ -31,44 +29,579 @@ static const set<string> STOP_WORDS = {
     "the","is","of","in","a","an","what","who","when","where","how"
 };
 
+/* ===== FTS5 SCHEMA =====
+   External-content index over knowledge, kept in sync by triggers.
+   unicode61 only treats letters, digits and Co as token characters,
+   which splits Devanagari at every matra and virama — M* keeps
+   "प्रधानमंत्री" as one token. */
+
+static const char* FTS_SCHEMA =
+    "CREATE VIRTUAL TABLE IF NOT EXISTS knowledge_fts "
+    "USING fts5(question, answer, category, content='knowledge', "
+    "content_rowid='id', "
+    "tokenize=\"unicode61 remove_diacritics 0 categories 'L* N* Co M*'\");"
+
+    "CREATE TRIGGER IF NOT EXISTS knowledge_fts_ai AFTER INSERT ON knowledge BEGIN "
+    "INSERT INTO knowledge_fts(rowid, question, answer, category) "
+    "VALUES (new.id, new.question, new.answer, new.category); END;"
+
+    "CREATE TRIGGER IF NOT EXISTS knowledge_fts_ad AFTER DELETE ON knowledge BEGIN "
+    "INSERT INTO knowledge_fts(knowledge_fts, rowid, question, answer, category) "
+    "VALUES ('delete', old.id, old.question, old.answer, old.category); END;"
+
+    "CREATE TRIGGER IF NOT EXISTS knowledge_fts_au AFTER UPDATE ON knowledge BEGIN "
+    "INSERT INTO knowledge_fts(knowledge_fts, rowid, question, answer, category) "
+    "VALUES ('delete', old.id, old.question, old.answer, old.category); "
+    "INSERT INTO knowledge_fts(rowid, question, answer, category) "
+    "VALUES (new.id, new.question, new.answer, new.category); END;";
+
+/* ===== TRACE STAGES ===== */
+
+static const TraceStage TRACE_RESPOND   ("ai.respond");
+static const TraceStage TRACE_PREPROCESS("ai.preprocess");
+static const TraceStage TRACE_CACHE     ("ai.cache");
+static const TraceStage TRACE_FTS       ("ai.fts");
+static const TraceStage TRACE_KEYWORD   ("ai.keyword");
+static const TraceStage TRACE_CORRECT   ("ai.correct");
+static const TraceStage TRACE_REWRITE   ("ai.rewrite");      // corrections that changed the query
+static const TraceStage TRACE_CATEGORY  ("ai.category");
+static const TraceStage TRACE_FETCH     ("ai.fetch");
+
 /* ===== RANDOM TEMPLATE ===== */
 
-static string randomFrom(const vector<string>& v){
-    static bool seeded = false;
-    if(!seeded){ srand(time(0)); seeded = true; }
-    return v[rand() % v.size()];
+static string randomFrom(const vector<string>& v, mt19937& rng){
+    return v[uniform_int_distribution<size_t>(0, v.size() - 1)(rng)];
 }
 
 /* ================================================================
-   CONSTRUCTOR / DESTRUCTOR
+   KNOWLEDGE — one generation: the file it was opened on, its
+   connections, and everything built from them
 ================================================================ */
 
-HindiAI::HindiAI(const string& dbFile){
-    if(sqlite3_open(dbFile.c_str(), &db) != SQLITE_OK){
-        cerr << "Database open failed: " << sqlite3_errmsg(db) << "\n";
-        db = nullptr;
+struct HindiAI::Knowledge {
+    Source         source;
+    bool           usable = false;         // opened and indexed
+    KeywordIndex   keywordIndex;           // token → rows, built or mapped
+    Performer      performer;              // vocabulary built when correction is enabled
+    bool           ftsLive = false;
+    bool           snapshotMapped = false;
+
+    mutex                      readersLock;
+    vector<unique_ptr<Reader>> readers;    // all, [0] = setup connection
+    vector<Reader*>            idle;
+    condition_variable         readerFree;
+
+    mutex         watchLock;
+    sqlite3*      watchDb   = nullptr;     // runs PRAGMA data_version only
+    sqlite3_stmt* watchStmt = nullptr;
+    long long     dataVersion = -1;
+
+    atomic<bool>  retired{false};          // no longer live: results are not cached
+    bool          replaced = false;        // another file is at the path now
+
+    ~Knowledge(){
+        // The -wal and -shm names belong to the new file: the last close
+        // must not checkpoint and delete them by name
+        if(replaced){
+            int keep = 1;
+            for(auto& r : readers)
+                if(r->db) sqlite3_file_control(r->db, "main", SQLITE_FCNTL_PERSIST_WAL, &keep);
+            if(watchDb) sqlite3_file_control(watchDb, "main", SQLITE_FCNTL_PERSIST_WAL, &keep);
+        }
+        sqlite3_finalize(watchStmt);
+        sqlite3_close(watchDb);
+    }
+};
+
+// readers = connections to open up front, so the first queries on a
+// reloaded generation do not pay for them. Only the first generation
+// may write (WAL, version triggers, FTS migration): reloads run while
+// a loader may be mid-way and take the file as it is. nullptr if the
+// database cannot be opened
+shared_ptr<HindiAI::Knowledge> HindiAI::openKnowledge(size_t readers, bool migrate){
+    auto kb = make_shared<Knowledge>();
+
+    // Before the open: if the file is swapped in between, the next
+    // check sees another inode and reloads once more, never less
+    struct stat st;
+    if(stat(dbPath.c_str(), &st) == 0){
+        kb->source.device = st.st_dev;
+        kb->source.inode  = st.st_ino;
+    }
+
+    // The setup connection then becomes the first pooled reader
+    auto r = make_unique<Reader>();
+    r->kb = kb.get();
+    if(sqlite3_open_v2(dbPath.c_str(), &r->db,
+                       migrate ? SQLITE_OPEN_READWRITE | SQLITE_OPEN_CREATE : SQLITE_OPEN_READONLY,
+                       nullptr) != SQLITE_OK)
+    {
+        cerr << "Database open failed: " << sqlite3_errmsg(r->db) << "\n";
+        return nullptr;
+    }
+    if(migrate){
+        // Enable WAL mode for faster reads (and readers that don't block)
+        sqlite3_exec(r->db, "PRAGMA journal_mode=WAL;", 0,0,0);
+        sqlite3_exec(r->db, "PRAGMA synchronous=NORMAL;", 0,0,0);
+        installKnowledgeVersion(r->db);
+        kb->ftsLive = setupFts(r->db);
     } else {
-        // Enable WAL mode for faster reads
-        sqlite3_exec(db, "PRAGMA journal_mode=WAL;", 0,0,0);
-        sqlite3_exec(db, "PRAGMA synchronous=NORMAL;", 0,0,0);
-        // Create FTS table if not exists for full text search
-        sqlite3_exec(db,
-            "CREATE VIRTUAL TABLE IF NOT EXISTS knowledge_fts "
-            "USING fts5(question, answer, category, content='knowledge', "
-            "content_rowid='id');",
-            0,0,0);
+        kb->ftsLive = ftsInStep(r->db);
+    }
+    prepareStatements(*r);
+    kb->ftsLive = kb->ftsLive && r->stmtFts >= 0;
+    cerr << (kb->ftsLive ? "FTS: live\n"
+                         : "FTS: offline — keyword index only\n");
+
+    // Map the compiled keyword index, or build it once from the table
+    // Questions are indexed in the form queries arrive in after preprocess()
+    // One read transaction: the version is exactly the rows indexed
+    sqlite3_exec(r->db, "BEGIN;", 0,0,0);
+    readKnowledgeVersion(r->db, kb->source.version);
+    kb->snapshotMapped = !snapshotPath.empty() && mapSnapshot(*kb, r->db);
+    kb->usable = kb->snapshotMapped ||
+                 kb->keywordIndex.build(r->db, [this](const string& q){ return enhancer.preprocess(q); });
+    if(!kb->usable)
+        cerr << "Keyword index build failed: " << sqlite3_errmsg(r->db) << "\n";
+    sqlite3_exec(r->db, "COMMIT;", 0,0,0);
+    cerr << "Index: " << kb->keywordIndex.rowCount() << " rows "
+         << (kb->snapshotMapped ? "mapped from " + snapshotPath : string("built from SQLite")) << "\n";
+
+    // The question words are exactly the keyword index dictionary
+    if(correction.enabled) kb->performer.buildVocabulary(kb->keywordIndex.words());
+
+    kb->idle.push_back(r.get());
+    kb->readers.push_back(move(r));
+    while(kb->readers.size() < readers){
+        auto extra = openReader(*kb);
+        if(!extra) break;
+        kb->idle.push_back(extra.get());
+        kb->readers.push_back(move(extra));
     }
+
+    // data_version only moves for commits by other connections, so the
+    // watcher must be one that never writes
+    if(sqlite3_open_v2(dbPath.c_str(), &kb->watchDb, SQLITE_OPEN_READONLY, nullptr) != SQLITE_OK ||
+       sqlite3_prepare_v2(kb->watchDb, "PRAGMA data_version;", -1, &kb->watchStmt, nullptr) != SQLITE_OK)
+    {
+        cerr << "Answer cache off for this version, cannot watch the database: "
+             << sqlite3_errmsg(kb->watchDb) << "\n";
+    }
+    return kb;
+}
+
+/* ================================================================
+   CONSTRUCTOR / DESTRUCTOR
+================================================================ */
+
+HindiAI::HindiAI(const string& dbFile, const string& snapshotFile)
+    : dbPath(dbFile), snapshotPath(snapshotFile)
+{
+    live = openKnowledge(1, true);
+    if(!live) live = make_shared<Knowledge>();     // no readers: nothing is found
+    reloaded.version = live->source.version;
+    applyAnswerCacheSize(*live);
 }
 
 HindiAI::~HindiAI(){
+    watchForReload(chrono::milliseconds(0));
+}
+
+HindiAI::Reader::~Reader(){
+    statements.finalizeAll();
     if(db) sqlite3_close(db);
 }
 
+/* ================================================================
+   READER POOL — one connection per concurrent query
+================================================================ */
+
+// NOMUTEX is safe because a reader is only ever used by the thread
+// that borrowed it
+unique_ptr<HindiAI::Reader> HindiAI::openReader(Knowledge& kb){
+    auto r = make_unique<Reader>();
+    r->kb = &kb;
+    if(sqlite3_open_v2(dbPath.c_str(), &r->db,
+                       SQLITE_OPEN_READONLY | SQLITE_OPEN_NOMUTEX, nullptr) != SQLITE_OK ||
+       !prepareStatements(*r))
+    {
+        cerr << "Reader open failed: " << sqlite3_errmsg(r->db) << "\n";
+        return nullptr;
+    }
+    // A replaced file belongs to the next generation, not this one
+    struct stat st;
+    if(stat(dbPath.c_str(), &st) != 0 ||
+       (uint64_t)st.st_dev != kb.source.device || (uint64_t)st.st_ino != kb.source.inode)
+        return nullptr;
+    return r;
+}
+
+HindiAI::Reader* HindiAI::borrowReader(Knowledge& kb){
+    {
+        lock_guard<mutex> g(kb.readersLock);
+        if(kb.readers.empty()) return nullptr;     // database never opened
+        if(!kb.idle.empty()){
+            Reader* r = kb.idle.back();
+            kb.idle.pop_back();
+            return r;
+        }
+    }
+
+    // All busy: open another
+    auto r = openReader(kb);
+    if(!r){
+        // Out of file handles or memory, or the file was replaced:
+        // wait for a busy one instead
+        unique_lock<mutex> g(kb.readersLock);
+        kb.readerFree.wait(g, [&]{ return !kb.idle.empty(); });
+        Reader* any = kb.idle.back();
+        kb.idle.pop_back();
+        return any;
+    }
+    lock_guard<mutex> g(kb.readersLock);
+    kb.readers.push_back(move(r));
+    return kb.readers.back().get();
+}
+
+void HindiAI::returnReader(Reader* r){
+    Knowledge& kb = *r->kb;
+    {
+        lock_guard<mutex> g(kb.readersLock);
+        kb.idle.push_back(r);
+    }
+    kb.readerFree.notify_one();
+}
+
+long long HindiAI::sqlPrepares() const {
+    auto kb = current();
+    lock_guard<mutex> g(kb->readersLock);
+    long long n = 0;
+    for(auto& r : kb->readers) n += r->statements.prepareCount();
+    return n;
+}
+
+long long HindiAI::sqlExecutions() const {
+    auto kb = current();
+    lock_guard<mutex> g(kb->readersLock);
+    long long n = 0;
+    for(auto& r : kb->readers) n += r->statements.executionCount();
+    return n;
+}
+
+size_t HindiAI::readerCount() const {
+    auto kb = current();
+    lock_guard<mutex> g(kb->readersLock);
+    return kb->readers.size();
+}
+
+bool HindiAI::isFtsLive() const        { return current()->ftsLive; }
+bool HindiAI::isSnapshotMapped() const { return current()->snapshotMapped; }
+
+KeywordHit HindiAI::matchKeywords(const string& query) const {
+    return current()->keywordIndex.bestMatch(scoringTokens(query));
+}
+
+/* ================================================================
+   ANSWER CACHE — dropped whenever another process commits
+================================================================ */
+
+void HindiAI::setAnswerCacheSize(size_t entries){
+    answerEntries = entries;
+    applyAnswerCacheSize(*current());
+}
+
+// Per generation: one whose watcher failed to open leaves the cache
+// off only until a later one can watch again
+void HindiAI::applyAnswerCacheSize(const Knowledge& kb){
+    answers.setCapacity(kb.watchStmt ? answerEntries.load() : 0);
+}
+
+void HindiAI::checkForChanges(Knowledge& kb){
+    lock_guard<mutex> g(kb.watchLock);
+    if(!kb.watchStmt) return;
+    long long v = -1;
+    if(sqlite3_step(kb.watchStmt) == SQLITE_ROW) v = sqlite3_column_int64(kb.watchStmt, 0);
+    sqlite3_reset(kb.watchStmt);
+    if(v != kb.dataVersion){
+        if(kb.dataVersion >= 0) answers.invalidate();
+        kb.dataVersion = v;
+    }
+}
+
+/* ================================================================
+   RELOAD — build the next generation aside, publish it with one
+   atomic store; the old one goes with its last query
+================================================================ */
+
+HindiAI::Source HindiAI::probe(Knowledge& kb){
+    Source s;
+    struct stat st;
+    if(stat(dbPath.c_str(), &st) != 0) return s;   // between rm and re-create
+    s.device = st.st_dev;
+    s.inode  = st.st_ino;
+
+    if(s.device == kb.source.device && s.inode == kb.source.inode && kb.watchDb){
+        lock_guard<mutex> g(kb.watchLock);
+        readKnowledgeVersion(kb.watchDb, s.version);
+    } else {
+        sqlite3* db = nullptr;
+        if(sqlite3_open_v2(dbPath.c_str(), &db, SQLITE_OPEN_READONLY, nullptr) == SQLITE_OK)
+            readKnowledgeVersion(db, s.version);
+        sqlite3_close(db);
+    }
+    return s;
+}
+
+// The build runs at the lowest priority, so on a busy core it only
+// gets what queries leave over (Linux: nice is per thread)
+bool HindiAI::reload(bool force){
+    lock_guard<mutex> g(reloadLock);
+    bool swapped = false;
+    thread worker([&]{
+        setpriority(PRIO_PROCESS, (id_t)syscall(SYS_gettid), 19);
+        swapped = rebuild(force);
+    });
+    worker.join();
+    return swapped;
+}
+
+bool HindiAI::rebuild(bool force){
+    shared_ptr<Knowledge> old = current();
+    Source now = probe(*old);
+    if(now.inode == 0 || (!force && now == old->source)) return false;
+
+    // As many connections as the old generation needed
+    size_t warm;
+    {
+        lock_guard<mutex> r(old->readersLock);
+        warm = max<size_t>(1, old->readers.size());
+    }
+    auto t0 = chrono::steady_clock::now();
+    shared_ptr<Knowledge> next = openKnowledge(warm, false);
+    double ms = chrono::duration<double, milli>(chrono::steady_clock::now() - t0).count();
+
+    // A file caught between create and load has no rows yet: keep
+    // serving the old one until it does
+    if(!next || !next->usable || (next->keywordIndex.empty() && !old->keywordIndex.empty())){
+        cerr << "Reload: " << dbPath << " not usable yet, still on version "
+             << old->source.version.version << "\n";
+        lock_guard<mutex> s(reloadedLock);
+        reloaded.failures++;
+        return false;
+    }
+
+    // retired first: a query still on the old generation that reaches
+    // the cache after the invalidate must not store its answer there
+    old->retired  = true;
+    old->replaced = now.device != old->source.device || now.inode != old->source.inode;
+    atomic_store(&live, next);
+    applyAnswerCacheSize(*next);
+    answers.invalidate();
+    cerr << "Reload: version " << next->source.version.version << ", "
+         << next->keywordIndex.rowCount() << " rows (" << (int)ms << " ms)\n";
+    {
+        lock_guard<mutex> s(reloadedLock);
+        reloaded.reloads++;
+        reloaded.lastMs  = ms;
+        reloaded.version = next->source.version;
+    }
+
+    // Queries that loaded the old generation before the store still
+    // hold it, and nothing can take a new reference: whichever lets go
+    // last frees it
+    return true;
+}
+
+void HindiAI::watchForReload(chrono::milliseconds interval){
+    {
+        lock_guard<mutex> g(watcherLock);
+        watcherStop = true;
+    }
+    watcherWake.notify_all();
+    if(watcher.joinable()) watcher.join();
+    watcherStop = false;
+    if(interval.count() > 0) watcher = thread(&HindiAI::watchLoop, this, interval);
+}
+
+void HindiAI::watchLoop(chrono::milliseconds interval){
+    Source last = current()->source;
+    unique_lock<mutex> g(watcherLock);
+    while(!watcherWake.wait_for(g, interval, [this]{ return watcherStop; })){
+        g.unlock();
+        bool changed;
+        Source now;
+        {
+            // Released before reload(), so this loop never keeps a
+            // retired generation alive
+            auto kb = current();
+            now     = probe(*kb);
+            changed = now != kb->source;
+        }
+        if(changed && now == last) reload();
+        last = now;
+        g.lock();
+    }
+}
+
+ReloadStats HindiAI::reloadStats() const {
+    lock_guard<mutex> g(reloadedLock);
+    return reloaded;
+}
+
+/* ================================================================
+   SNAPSHOT — only if compiled from this database as it is now
+================================================================ */
+
+bool HindiAI::mapSnapshot(Knowledge& kb, sqlite3* db){
+    const string& path = snapshotPath;
+    if(access(path.c_str(), F_OK) != 0) return false;      // none built
+
+    auto snap = make_shared<KnowledgeSnapshot>();
+    KnowledgeVersion now;
+    if(!snap->open(path)){
+        cerr << "Snapshot: " << path << " unreadable or from another version\n";
+        return false;
+    }
+    if(!readKnowledgeVersion(db, now) || now != snap->source()){
+        cerr << "Snapshot: " << path << " is stale (knowledge changed since primus_snapshot)\n";
+        return false;
+    }
+    if(snap->normalizer() != enhancer.fingerprint()){
+        cerr << "Snapshot: " << path << " is stale (built with other rewrite rules)\n";
+        return false;
+    }
+    kb.keywordIndex.attach(snap->tables(), snap);
+    return true;
+}
+
+/* ================================================================
+   CORRECTION STAGE — option + lazy vocabulary build
+================================================================ */
+
+void HindiAI::setCorrection(const CorrectionOptions& opts){
+    correction = opts;
+    auto kb = current();
+    if(!correction.enabled || kb->performer.hasVocabulary()) return;
+
+    // The question words are exactly the keyword index dictionary
+    kb->performer.buildVocabulary(kb->keywordIndex.words());
+}
+
+/* ================================================================
+   SETUP FTS — create, migrate old tokenizer, rebuild if stale
+================================================================ */
+
+static long long scalarInt(sqlite3* db, const char* sql){
+    sqlite3_stmt* stmt;
+    long long v = -1;
+    if(sqlite3_prepare_v2(db, sql, -1, &stmt, nullptr) == SQLITE_OK &&
+       sqlite3_step(stmt) == SQLITE_ROW)
+        v = sqlite3_column_int64(stmt, 0);
+    sqlite3_finalize(stmt);
+    return v;
+}
+
+bool installKnowledgeFts(sqlite3* db, bool* created){
+    // Tables created before the Devanagari tokenizer are useless: drop
+    if(scalarInt(db, "SELECT COUNT(*) FROM sqlite_master WHERE name='knowledge_fts' "
+                     "AND sql NOT LIKE '%categories%';") > 0)
+        sqlite3_exec(db, "DROP TABLE knowledge_fts;", 0,0,0);
+    bool existed = scalarInt(db, "SELECT COUNT(*) FROM sqlite_master "
+                                 "WHERE name='knowledge_fts';") > 0;
+
+    char* err = nullptr;
+    if(sqlite3_exec(db, FTS_SCHEMA, 0,0, &err) != SQLITE_OK){
+        cerr << "FTS setup failed: " << (err ? err : "?") << "\n";
+        sqlite3_free(err);
+        return false;
+    }
+    if(created) *created = !existed;
+    return true;
+}
+
+bool HindiAI::setupFts(sqlite3* db){
+    bool created = false;
+    if(!installKnowledgeFts(db, &created)) return false;
+    bool existed = !created;
+    char* err = nullptr;
+
+    // Counting both tables reads the whole database. Skip it when the
+    // last check was at the current version: the triggers have kept
+    // the index in step since.
+    KnowledgeVersion v;
+    bool versioned = readKnowledgeVersion(db, v);
+    if(existed && versioned &&
+       scalarInt(db, "SELECT value FROM knowledge_meta WHERE key='fts_checked';") == v.version)
+        return true;
+
+    // The docsize shadow table has one row per indexed document
+    long long rows    = scalarInt(db, "SELECT COUNT(*) FROM knowledge;");
+    long long indexed = scalarInt(db, "SELECT COUNT(*) FROM knowledge_fts_docsize;");
+    if(rows != indexed){
+        cerr << "FTS: indexing " << rows << " rows...\n";
+        if(sqlite3_exec(db, "INSERT INTO knowledge_fts(knowledge_fts) VALUES('rebuild');",
+                        0,0, &err) != SQLITE_OK)
+        {
+            cerr << "FTS rebuild failed: " << (err ? err : "?") << "\n";
+            sqlite3_free(err);
+            return false;
+        }
+    }
+    if(rows < 0) return false;
+
+    if(versioned){
+        string sql = "INSERT OR REPLACE INTO knowledge_meta VALUES ('fts_checked', " +
+                     to_string(v.version) + ");";
+        sqlite3_exec(db, sql.c_str(), 0,0,0);
+    }
+    return true;
+}
+
+// Reloads cannot migrate or rebuild: FTS is used as the loader left
+// it, if it has the current tokenizer and is in step with the table
+bool HindiAI::ftsInStep(sqlite3* db){
+    if(scalarInt(db, "SELECT COUNT(*) FROM sqlite_master WHERE name='knowledge_fts' "
+                     "AND sql LIKE '%categories%';") <= 0)
+        return false;
+    KnowledgeVersion v;
+    if(readKnowledgeVersion(db, v) &&
+       scalarInt(db, "SELECT value FROM knowledge_meta WHERE key='fts_checked';") == v.version)
+        return true;
+    long long rows = scalarInt(db, "SELECT COUNT(*) FROM knowledge;");
+    return rows >= 0 && rows == scalarInt(db, "SELECT COUNT(*) FROM knowledge_fts_docsize;");
+}
+
+/* ================================================================
+   PREPARE STATEMENTS — compiled once, reset + rebound per query
+================================================================ */
+
+bool HindiAI::prepareStatements(Reader& r){
+    StatementCache& statements = r.statements;
+    sqlite3*        db         = r.db;
+
+    // bm25 column weights: question 10, answer 1, category 1
+    r.stmtFts = statements.prepare(db,
+        "SELECT knowledge.id, knowledge.answer, "
+        "bm25(knowledge_fts, 10.0, 1.0, 1.0) AS rank FROM knowledge_fts "
+        "JOIN knowledge ON knowledge.id = knowledge_fts.rowid "
+        "WHERE knowledge_fts MATCH ? "
+        "ORDER BY rank LIMIT 1;");
+
+    r.stmtAnswer = statements.prepare(db,
+        "SELECT answer FROM knowledge WHERE id=?;");
+
+    if(r.stmtAnswer < 0){
+        cerr << "Statement prepare failed: " << sqlite3_errmsg(db) << "\n";
+        return false;
+    }
+    return true;
+}
+
 /* ================================================================
    TOKENIZE
 ================================================================ */
 
-vector<string> HindiAI::tokenize(const string& text){
+vector<string> HindiAI::tokenize(const string& text) const {
     stringstream ss(text);
     string word;
     vector<string> tokens;
@@ -79,137 +612,206 @@ vector<string> HindiAI::tokenize(const string& text){
     return tokens;
 }
 
-bool HindiAI::isStopWord(const string& w){
+bool HindiAI::isStopWord(const string& w) const {
     return STOP_WORDS.count(w) > 0;
 }
 
 /* ================================================================
-   SCORE MATCH (TF-IDF style)
-   - Each matching token = +2
-   - Exact phrase match bonus = +10
-   - Partial (substr) match = +1
+   FTS QUERY — quoted tokens, implicitly AND-ed
+   Quoting keeps stray punctuation or words like "AND"/"NOT"
+   from being parsed as FTS5 syntax. Single digits stay in, as
+   for scoring: "अनुच्छेद 1" is not a question about अनुच्छेद.
 ================================================================ */
 
-int HindiAI::scoreMatch(const string& query, const string& dbQuestion){
-    int score = 0;
+string HindiAI::buildFtsQuery(const string& query) const {
+    string match;
+    for(auto& tok : tokenize(query)){
+        if(!match.empty()) match += ' ';
+        match += '"';
+        for(char c : tok){
+            if(c == '"') match += '"';
+            match += c;
+        }
+        match += '"';
+    }
+    return match;
+}
 
-    // Exact phrase match bonus
-    if(dbQuestion.find(query) != string::npos)
-        score += 10;
+/* ================================================================
+   SCORING TOKENS — what KeywordIndex ranks with BM25
+   Matching is by whole token, so single digits and letters ("4",
+   "k") are kept: IDF decides how much they are worth.
+================================================================ */
 
-    auto tokens = tokenize(query);
-    for(auto& tok : tokens){
-        if(tok.size() < 2) continue;
-        if(dbQuestion.find(tok) != string::npos)
-            score += 2;
-    }
+vector<string> HindiAI::scoringTokens(const string& query) const {
+    return tokenize(query);
+}
+
+/* ================================================================
+   CONFIDENT — one bar for whichever path found the row
+   Its question explains enough of the query's IDF and leaves out
+   none of the query's numbers.
+================================================================ */
 
-    return score;
+static bool confident(const KeywordHit& hit, double floor){
+    return hit.id >= 0 && hit.confidence >= floor && hit.missedNumbers == 0;
 }
 
 /* ================================================================
    SEARCH DB — Primary method
 ================================================================ */
 
-string HindiAI::searchDB(const string& query){
-    if(!db) return "";
-
-    sqlite3_stmt* stmt;
+string HindiAI::searchDB(Reader& r, const string& query){
     // Also try FTS first (much faster on large DB)
-    string fts_sql =
-        "SELECT knowledge.answer FROM knowledge "
-        "JOIN knowledge_fts ON knowledge.id = knowledge_fts.rowid "
-        "WHERE knowledge_fts MATCH ? "
-        "ORDER BY rank LIMIT 1;";
-
-    if(sqlite3_prepare_v2(db, fts_sql.c_str(), -1, &stmt, nullptr) == SQLITE_OK){
-        sqlite3_bind_text(stmt, 1, query.c_str(), -1, SQLITE_TRANSIENT);
-        if(sqlite3_step(stmt) == SQLITE_ROW){
-            string ans = (const char*)sqlite3_column_text(stmt, 0);
-            sqlite3_finalize(stmt);
-            if(!ans.empty()) return ans;
-        }
-        sqlite3_finalize(stmt);
+    string ans = searchFts(r, query);
+    if(!ans.empty()) return ans;
+
+    // Fallback: BM25 over the keyword index
+    return searchByKeyword(r, query);
+}
+
+string HindiAI::searchFts(Reader& r, const string& query){
+    TraceSpan span(TRACE_FTS);
+    string match = r.kb->ftsLive ? buildFtsQuery(query) : "";
+    auto stmt = match.empty() ? StatementCache::Lease(nullptr)
+                              : r.statements.acquire(r.stmtFts);
+    if(!stmt) return "";
+
+    sqlite3_bind_text(stmt.get(), 1, match.c_str(), -1, SQLITE_TRANSIENT);
+    if(sqlite3_step(stmt.get()) != SQLITE_ROW) return "";
+    long long id = sqlite3_column_int64(stmt.get(), 0);
+
+    // FTS matches answers and categories too: the question itself
+    // has to carry the query's rare words and pass the same bar as a
+    // keyword hit, or the keyword search gets its turn
+    if(!r.kb->keywordIndex.empty()){
+        KeywordHit hit = r.kb->keywordIndex.scoreRow(id, scoringTokens(query));
+        if(hit.missedRare > 0 || !confident(hit, minConfidence)) return "";
+    }
+
+    string ans = (const char*)sqlite3_column_text(stmt.get(), 1);
+    if(!ans.empty()){
+        r.foundId    = id;
+        r.foundScore = sqlite3_column_double(stmt.get(), 2);
     }
+    return ans;
+}
+
+long long HindiAI::searchOnly(SearchPath path, const string& query, const string& category){
+    shared_ptr<Knowledge> kb = current();
+    Reader* r = borrowReader(*kb);
+    if(!r) return -1;
 
-    // Fallback: full scan with scoring
-    return searchByKeyword(query);
+    string answer;
+    switch(path){
+        case SearchPath::Fts:      answer = searchFts(*r, query);                  break;
+        case SearchPath::Keyword:  answer = searchByKeyword(*r, query);            break;
+        case SearchPath::Category: answer = searchByCategory(*r, category, query); break;
+    }
+    long long id = answer.empty() ? -1 : r->foundId;
+    returnReader(r);
+    return id;
 }
 
 /* ================================================================
-   SEARCH BY KEYWORD (scored full scan)
+   SEARCH BY KEYWORD (inverted index, BM25 over whole tokens)
+   A hit that explains too little of the query is not an answer.
 ================================================================ */
 
-string HindiAI::searchByKeyword(const string& query){
-    if(!db) return "";
-
-    sqlite3_stmt* stmt;
-    string sql = "SELECT question, answer, category FROM knowledge;";
+string HindiAI::searchByKeyword(Reader& r, const string& query){
+    KeywordHit hit;
+    {
+        TraceSpan span(TRACE_KEYWORD);
+        vector<string> tokens = scoringTokens(query);
+        hit = r.kb->keywordIndex.bestMatch(tokens);
+        if(hit.id >= 0) hit = r.kb->keywordIndex.scoreRow(hit.id, tokens);
+    }
+    if(!confident(hit, minConfidence)) return "";
 
-    if(sqlite3_prepare_v2(db, sql.c_str(), -1, &stmt, nullptr) != SQLITE_OK)
-        return "";
+    r.foundScore = hit.score;
+    return fetchAnswer(r, hit.id);
+}
 
-    string bestAnswer   = "";
-    int    bestScore    = 0;
-    const int MIN_SCORE = 1;  // require at least 1 token match
+/* ================================================================
+   FETCH ANSWER by knowledge.id
+================================================================ */
 
-    while(sqlite3_step(stmt) == SQLITE_ROW){
-        string dbQ = (const char*)sqlite3_column_text(stmt, 0);
-        string dbA = (const char*)sqlite3_column_text(stmt, 1);
+string HindiAI::fetchAnswer(Reader& r, long long id){
+    TraceSpan span(TRACE_FETCH);
+    auto stmt = r.statements.acquire(r.stmtAnswer);
+    if(!stmt) return "";
 
-        int score = scoreMatch(query, dbQ);
+    sqlite3_bind_int64(stmt.get(), 1, id);
 
-        if(score > bestScore){
-            bestScore  = score;
-            bestAnswer = dbA;
-        }
+    string answer = "";
+    if(sqlite3_step(stmt.get()) == SQLITE_ROW){
+        answer    = (const char*)sqlite3_column_text(stmt.get(), 0);
+        r.foundId = id;
     }
 
-    sqlite3_finalize(stmt);
-
-    if(bestScore >= MIN_SCORE)
-        return bestAnswer;
-
-    return "";
+    return answer;
 }
 
 /* ================================================================
-   SEARCH BY CATEGORY
+   SEARCH CORRECTED — retry with STT errors fixed
 ================================================================ */
 
-string HindiAI::searchByCategory(const string& category, const string& query){
-    if(!db || category.empty()) return "";
+string HindiAI::searchCorrected(Reader& r, const string& query){
+    const Performer& performer = r.kb->performer;
+    r.cutShort = false;
+    if(!correction.enabled || !performer.hasVocabulary()) return "";
 
-    sqlite3_stmt* stmt;
-    string sql = "SELECT question, answer FROM knowledge WHERE category=?;";
+    auto t0 = chrono::steady_clock::now();
+    vector<pair<string, string>> rewrites;
+    string fixed;
+    {
+        TraceSpan span(TRACE_CORRECT);
+        fixed = performer.correctQuery(query, correction.budget, rewrites, &r.cutShort);
+    }
+    auto t1 = chrono::steady_clock::now();
 
-    if(sqlite3_prepare_v2(db, sql.c_str(), -1, &stmt, nullptr) != SQLITE_OK)
-        return "";
+    if(rewrites.empty()) return "";
 
-    sqlite3_bind_text(stmt, 1, category.c_str(), -1, SQLITE_TRANSIENT);
+    // Seen in the trace whatever the verbosity; the server stays quiet
+    if(traceEnabled()) traceRecord(TRACE_REWRITE, traceNs(t0), traceNs(t1));
+    if(correction.verbose){
+        cerr << "[autocorrect]";
+        for(auto& [from, to] : rewrites) cerr << " " << from << " → " << to;
+        cerr << " (" << chrono::duration_cast<chrono::microseconds>(t1 - t0).count() << " us)\n";
+    }
 
-    string bestAnswer = "";
-    int    bestScore  = 0;
+    return searchDB(r, fixed);
+}
 
-    while(sqlite3_step(stmt) == SQLITE_ROW){
-        string dbQ = (const char*)sqlite3_column_text(stmt, 0);
-        string dbA = (const char*)sqlite3_column_text(stmt, 1);
-        int score  = scoreMatch(query, dbQ);
-        if(score > bestScore){
-            bestScore  = score;
-            bestAnswer = dbA;
-        }
+/* ================================================================
+   SEARCH BY CATEGORY
+================================================================ */
+
+string HindiAI::searchByCategory(Reader& r, const string& category, const string& query){
+    if(category.empty()) return "";
+
+    // The detected topic is evidence of its own, so half the usual
+    // confidence is enough inside it
+    KeywordHit hit;
+    {
+        TraceSpan span(TRACE_CATEGORY);
+        vector<string> tokens = scoringTokens(query);
+        hit = r.kb->keywordIndex.bestInCategory(category, tokens);
+        if(hit.id >= 0) hit = r.kb->keywordIndex.scoreRow(hit.id, tokens);
     }
+    if(!confident(hit, minConfidence / 2)) return "";
 
-    sqlite3_finalize(stmt);
-    return bestAnswer;
+    r.foundScore = hit.score;
+    return fetchAnswer(r, hit.id);
 }
 
 /* ================================================================
    WRAP RESPONSE with emotion-aware suffix
 ================================================================ */
 
-string HindiAI::wrapResponse(const string& answer, const string& emotion){
+string HindiAI::wrapResponse(const string& answer, const string& emotion,
+                             mt19937& rng) const
+{
     vector<string> neutral = {
         answer + "। यदि आप चाहें तो मैं और विस्तार से समझा सकता हूँ।",
         answer + "। क्या आप इस विषय पर और जानकारी चाहते हैं?",
@@ -228,88 +830,113 @@ string HindiAI::wrapResponse(const string& answer, const string& emotion){
         answer + "। शांत मन से इसे समझें, और प्रश्न हो तो पूछें।"
     };
 
-    if(emotion == "warm")      return randomFrom(warm);
-    if(emotion == "energetic") return randomFrom(energetic);
-    if(emotion == "calm")      return randomFrom(calm);
-    return randomFrom(neutral);
+    if(emotion == "warm")      return randomFrom(warm, rng);
+    if(emotion == "energetic") return randomFrom(energetic, rng);
+    if(emotion == "calm")      return randomFrom(calm, rng);
+    return randomFrom(neutral, rng);
 }
 
 /* ================================================================
    GENERATE RESPONSE — Main entry point
 ================================================================ */
 
-string HindiAI::generateResponse(const string& input){
-
-    // 1. Preprocess
-    string processed = enhancer.preprocess(input);
+static const char* NOT_FOUND =
+    "क्षमा कीजिए बॉस, इस विषय पर मेरे पास अभी जानकारी नहीं है। "
+    "कृपया अलग शब्दों में पूछें या किसी और विषय पर प्रश्न करें।";
+
+string HindiAI::generateResponse(const string& input, Session& session, Intent intent){
+    session.answerId  = -1;
+    session.answerLen = 0;
+
+    TraceSpan span(TRACE_RESPOND);
+    // Held to the end: a reload meanwhile waits for this query before
+    // freeing the generation it runs on
+    shared_ptr<Knowledge> kb = current();
+    Reader* r = borrowReader(*kb);
+    if(!r) return NOT_FOUND;
+    string response = respondWith(*r, input, session, intent);
+    returnReader(r);
+    return response;
+}
 
-    // 2. Detect emotion
-    brain.detectEmotion(processed);
-    string emotion = brain.getEmotion();
+string HindiAI::respondWith(Reader& r, const string& input, Session& session,
+                            Intent intent)
+{
+    Intelligence& brain = session.brain;
+    string processed, emotion, topic;
+    {
+        TraceSpan span(TRACE_PREPROCESS);
 
-    // 3. Apply context (pronoun resolution)
-    processed = brain.applyContext(processed);
+        // 1. Preprocess
+        processed = enhancer.preprocess(input);
 
-    // 4. Detect topic for category search
-    string topic = brain.detectTopic(processed);
+        // 2. Detect emotion
+        brain.detectEmotion(processed);
+        emotion = brain.getEmotion();
 
-    /* --- Greetings --- */
-    if(processed.find("नमस्ते") != string::npos ||
-       processed.find("hello")  != string::npos ||
-       processed.find("हाय")    != string::npos ||
-       processed.find("hey")    != string::npos)
-    {
-        vector<string> greets = {
-            "नमस्ते बॉस! मैं पूरी तरह सक्रिय हूँ। भारतीय राजनीति, सिनेमा, भूगोल, कानून या तकनीक — किसी भी विषय पर पूछें।",
-            "हेलो! मैं आपकी सेवा में हूँ। क्या जानना चाहते हैं?",
-            "नमस्कार! आज किस विषय में जानकारी चाहिए?"
-        };
-        return randomFrom(greets);
-    }
+        // 3. Apply context (pronoun resolution)
+        processed = brain.applyContext(processed);
 
-    /* --- Help --- */
-    if(processed.find("मदद") != string::npos ||
-       processed.find("help") != string::npos)
-    {
-        return "मैं इन विषयों में मदद कर सकता हूँ:\n"
-               "1. भारतीय राजनीति (नेता, दल, चुनाव, संसद)\n"
-               "2. भारतीय सिनेमा (फिल्में, कलाकार, पुरस्कार)\n"
-               "3. भारतीय भूगोल (राज्य, नदियाँ, पर्वत)\n"
-               "4. भारतीय कानून (धाराएँ, संविधान, न्यायालय)\n"
-               "5. तकनीक (इंटरनेट, एआई, प्रोग्रामिंग)\n"
-               "बस पूछिए!";
+        // 4. Detect topic for category search
+        topic = brain.detectTopic(processed);
     }
 
     /* --- "और बताओ" (follow-up) --- */
-    if(processed.find("और बताओ") != string::npos ||
-       processed.find("विस्तार") != string::npos)
-    {
+    if(intent == Intent::FollowUp){
         string lastSubj = brain.getLastSubject();
         if(!lastSubj.empty()){
-            string followUp = searchDB(lastSubj + " विस्तार " + processed);
-            if(followUp.empty()) followUp = searchDB(lastSubj);
+            string followUp = searchDB(r, lastSubj + " विस्तार " + processed);
+            if(followUp.empty()) followUp = searchDB(r, lastSubj);
             if(!followUp.empty()){
                 brain.updateContext(input, followUp);
-                return wrapResponse(followUp, emotion);
+                session.answerId  = r.foundId;
+                session.answerLen = followUp.size();
+                return wrapResponse(followUp, emotion, session.rng);
             }
         }
     }
 
-    // 5. Primary search
-    string answer = searchDB(processed);
+    // 5-6. A query seen before skips straight to its row
+    checkForChanges(*r.kb);
+    string answer;
+    AnswerCache::Result cached;
+    uint64_t ticket;
+    bool seen;
+    {
+        TraceSpan span(TRACE_CACHE);
+        seen = answers.find(processed, cached, ticket);
+    }
+    if(seen){
+        if(cached.id >= 0) answer = fetchAnswer(r, cached.id);
+    } else {
+        // 5. Primary search
+        answer = searchDB(r, processed);
+
+        // 5b. STT correction retry (optional, time-bounded)
+        if(answer.empty())
+            answer = searchCorrected(r, processed);
+
+        // 6. Category fallback
+        if(answer.empty() && !topic.empty() && topic != "सामान्य"){
+            answer = searchByCategory(r, topic, processed);
+        }
 
-    // 6. Category fallback
-    if(answer.empty() && !topic.empty() && topic != "सामान्य"){
-        answer = searchByCategory(topic, processed);
+        // "Not found" because the correction ran out of time is about
+        // the machine's load, not the query
+        if(!r.kb->retired && !(answer.empty() && r.cutShort))
+            answers.insert(processed, answer.empty() ? AnswerCache::Result()
+                                                     : AnswerCache::Result{ r.foundId, r.foundScore },
+                           ticket);
     }
 
     // 7. Success
     if(!answer.empty()){
         brain.updateContext(input, answer);
-        return wrapResponse(answer, emotion);
+        session.answerId  = r.foundId;
+        session.answerLen = answer.size();
+        return wrapResponse(answer, emotion, session.rng);
     }
 
     // 8. Not found
-    return "क्षमा कीजिए बॉस, इस विषय पर मेरे पास अभी जानकारी नहीं है। "
-           "कृपया अलग शब्दों में पूछें या किसी और विषय पर प्रश्न करें।";
+    return NOT_FOUND;
 }
@@ -0,0 +1,227 @@
+#pragma once
+#include <string>
+#include <vector>
+#include <chrono>
+#include <memory>
+#include <mutex>
+#include <condition_variable>
+#include <thread>
+#include <atomic>
+#include <random>
+#include <sqlite3.h>
+
+#include "keyword_index.h"
+#include "knowledge_snapshot.h"
+#include "statement_cache.h"
+#include "performer.h"
+#include "enhancer.h"
+#include "intelligence.h"
+#include "answer_cache.h"
+#include "intent_router.h"
+
+// Creates knowledge_fts and the triggers that keep it in step with
+// knowledge, first dropping one made with an older tokenizer. created:
+// the table is new, and empty until a 'rebuild'
+bool installKnowledgeFts(sqlite3* db, bool* created = nullptr);
+
+// STT-error correction stage, run only when the first search misses
+struct CorrectionOptions {
+    bool                      enabled = false;
+    std::chrono::microseconds budget  { 2000 };   // per query
+    bool                      verbose = false;    // each rewrite to stderr
+};
+
+// Per-conversation state. Give each user / client its own; one
+// Session must not be used by two threads at the same time
+struct Session {
+    Intelligence brain;                         // context, emotion, history
+    std::mt19937 rng { std::random_device{}() };  // reply templates
+
+    // knowledge.id of the answer at the start of the last response
+    // and its length in bytes; -1 when the response is not a table row
+    long long answerId  = -1;
+    size_t    answerLen = 0;
+
+    size_t memoryBytes() const { return sizeof(*this) - sizeof(brain) + brain.memoryBytes(); }
+};
+
+// The stages of the knowledge search, for searchOnly()
+enum class SearchPath { Fts, Keyword, Category };
+
+/*
+ * The knowledge indexes and dictionaries are built once per generation
+ * (see below) and only read afterwards, so generateResponse(input, session) may run on several
+ * threads at once. Each call borrows a read connection (with its own
+ * prepared statements) from a pool that grows to the number of
+ * concurrent callers; WAL lets them read in parallel.
+ *
+ * With a snapshot (primus_snapshot) that matches the database, the
+ * keyword index is mapped from it instead of being built, so startup
+ * no longer scans the knowledge table.
+ *
+ * Everything opened on the database (connections, the keyword index,
+ * the correction vocabulary) is one Knowledge generation. A reload
+ * builds the next one off the query path and publishes it with one
+ * atomic pointer store, RCU-style: a query keeps the generation it
+ * started on until it returns, and the last query to let go of the
+ * old one frees it. Reloads open the database read-only; only the
+ * first generation writes to it (WAL, triggers, FTS migration).
+ */
+
+struct ReloadStats {
+    size_t           reloads  = 0;      // generations swapped in
+    size_t           failures = 0;      // builds that were thrown away
+    double           lastMs   = 0;      // build time of the last one
+    KnowledgeVersion version;           // what the live one was built from
+};
+
+class HindiAI {
+public:
+    explicit HindiAI(const std::string& dbFile, const std::string& snapshotFile = "");
+    ~HindiAI();
+
+    // Thread-safe as long as each thread passes its own Session.
+    // intent comes from the caller's IntentRouter: Knowledge, or
+    // FollowUp to continue the last subject
+    std::string generateResponse(const std::string& input, Session& session,
+                                 Intent intent = Intent::Knowledge);
+
+    // Single-conversation shorthand for the console
+    std::string generateResponse(const std::string& input){
+        return generateResponse(input, console);
+    }
+
+    // Call before serving queries, not concurrently with them
+    void setCorrection(const CorrectionOptions& opts);
+
+    // Remembered searches by normalized query (0 = off). Off while the
+    // live version's changes cannot be watched: nothing would invalidate it
+    void setAnswerCacheSize(size_t entries);
+    AnswerCacheStats answerCacheStats() const { return answers.stats(); }
+
+    // Keyword hits matching less than this share of the query's IDF
+    // weight answer "not found" (see KeywordHit); call before serving
+    void   setMinConfidence(double share) { minConfidence = share; }
+    double getMinConfidence() const       { return minConfidence; }
+
+    // The keyword index alone, without FTS or the threshold; query is
+    // preprocessed text. For benchmarks and diagnostics.
+    KeywordHit matchKeywords(const std::string& query) const;
+    std::vector<std::string> scoringTokens(const std::string& query) const;
+
+    // One search stage alone, with the thresholds the pipeline applies
+    // to it; query is preprocessed text, category a knowledge category
+    // (Category only). knowledge.id of the answer, or -1
+    long long searchOnly(SearchPath path, const std::string& query,
+                         const std::string& category = "");
+
+    // True once knowledge_fts is populated and queryable
+    bool isFtsLive() const;
+
+    // True when the keyword index came from the snapshot file
+    bool isSnapshotMapped() const;
+
+    // Builds a new generation if the file at dbFile was replaced or
+    // knowledge changed since the live one (always, with force) and
+    // swaps it in; queries keep running meanwhile. Blocks the caller
+    // for the build. True if a new generation went live
+    bool reload(bool force = false);
+
+    // Checks every interval from a background thread; reloads once a
+    // change has stood still for one interval (a load in progress is
+    // not chased commit by commit). 0 stops watching
+    void watchForReload(std::chrono::milliseconds interval);
+
+    ReloadStats reloadStats() const;
+
+    // Answer behind the last console response (see Session)
+    long long lastAnswerId()     const { return console.answerId; }
+    size_t    lastAnswerLength() const { return console.answerLen; }
+
+    // Prepare vs. execution counters, summed over all read connections
+    long long sqlPrepares()   const;
+    long long sqlExecutions() const;
+    size_t    readerCount()   const;
+
+private:
+    struct Knowledge;
+
+    // The file at dbPath and the knowledge version in it
+    struct Source {
+        uint64_t         device = 0, inode = 0;    // 0 = no file
+        KnowledgeVersion version;
+
+        bool operator==(const Source& o) const {
+            return device == o.device && inode == o.inode && version == o.version;
+        }
+        bool operator!=(const Source& o) const { return !(*this == o); }
+    };
+
+    // One connection and its statements; held by one query at a time
+    struct Reader {
+        Knowledge*     kb = nullptr;   // the generation it belongs to
+        sqlite3*       db = nullptr;
+        StatementCache statements;     // compiled once per connection
+        long long      foundId = -1;   // row behind the last search hit
+        double         foundScore = 0; // and how well it matched
+        bool           cutShort = false;   // last correction ran out of budget
+
+        int stmtFts    = -1;
+        int stmtAnswer = -1;
+
+        ~Reader();
+    };
+
+    std::string    dbPath;
+    std::string    snapshotPath;
+    Enhancer       enhancer;
+    double         minConfidence  = 0.4;
+    CorrectionOptions correction;
+
+    // Replaced whole by reload(); std::atomic_load/atomic_store only
+    std::shared_ptr<Knowledge> live;
+
+    std::mutex              reloadLock;      // one rebuild at a time
+    mutable std::mutex      reloadedLock;
+    ReloadStats             reloaded;
+    std::thread             watcher;
+    std::mutex              watcherLock;
+    std::condition_variable watcherWake;
+    bool                    watcherStop = false;
+
+    Session console;
+
+    AnswerCache   answers;
+    std::atomic<size_t> answerEntries{1024}; // as set; answers holds 0 while unwatched
+
+    std::shared_ptr<Knowledge> current() const { return std::atomic_load(&live); }
+    std::shared_ptr<Knowledge> openKnowledge(size_t readers, bool migrate);
+    bool setupFts(sqlite3* db);
+    bool ftsInStep(sqlite3* db);
+    void applyAnswerCacheSize(const Knowledge& kb);
+    bool mapSnapshot(Knowledge& kb, sqlite3* db);
+    bool prepareStatements(Reader& r);
+    std::unique_ptr<Reader> openReader(Knowledge& kb);
+    Reader* borrowReader(Knowledge& kb);
+    void    returnReader(Reader* r);
+    void    checkForChanges(Knowledge& kb);
+    Source  probe(Knowledge& kb);
+    bool    rebuild(bool force);
+    void    watchLoop(std::chrono::milliseconds interval);
+
+    std::vector<std::string> tokenize(const std::string& text) const;
+    bool isStopWord(const std::string& w) const;
+
+    std::string buildFtsQuery(const std::string& query) const;
+    std::string searchFts(Reader& r, const std::string& query);
+    std::string searchDB(Reader& r, const std::string& query);
+    std::string searchByKeyword(Reader& r, const std::string& query);
+    std::string searchByCategory(Reader& r, const std::string& category, const std::string& query);
+    std::string fetchAnswer(Reader& r, long long id);
+    std::string searchCorrected(Reader& r, const std::string& query);
+    std::string respondWith(Reader& r, const std::string& input, Session& session,
+                            Intent intent);
+
+    std::string wrapResponse(const std::string& answer, const std::string& emotion,
+                             std::mt19937& rng) const;
+};
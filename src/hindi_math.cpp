@@ -0,0 +1,709 @@
+/*
+ * ============================================================
+ *  PRIMUS AI - Hindi Arithmetic
+ *  Number words, Devanagari digits, precedence parser
+ * ============================================================
+ */
+
+#include "hindi_math.h"
+
+#include <vector>
+#include <deque>
+#include <algorithm>
+#include <cmath>
+#include <cstdio>
+#include <cstdint>
+#include <cstring>
+
+using namespace std;
+
+namespace {
+
+/* ===== LEXEMES ===== */
+
+enum Kind : uint8_t {
+    NUM, OP, PERCENT, SQUARE, CUBE, SQRT, AND, KA, KO, SE, FROM, MEIN, LPAREN, RPAREN,
+    UNIT, MULT, FRACTION, POINT,    // merged into NUM before parsing
+    FILLER, END
+};
+
+// Where an operator word may stand
+enum : uint8_t {
+    INFIX = 1,      // between operands:        "5 जोड़ 3"
+    FINAL = 2,      // ends a sentence form:    "100 में से 45 घटाओ"
+    AGG   = 4       // after का:                "25 और 30 का जोड़"
+};
+
+struct Lex {
+    Kind    kind;
+    double  value  = 0;
+    char    op     = 0;
+    uint8_t flags  = 0;
+    uint8_t digits = 0;         // digit literals: digits before the point
+    bool    fromWord = false;
+    bool    isDo     = false;   // the word "दो" (2, or the verb in "भाग दो")
+};
+
+const int MAX_LEX = 64;
+
+/* ===== WORD TABLE ===== */
+
+struct Word {
+    const char* key;
+    Kind        kind;
+    double      value;
+    char        op    = 0;
+    uint8_t     flags = 0;
+};
+
+const Word WORDS[] = {
+    // 0-100. Each has its own word in Hindi; common spelling variants
+    { "शून्य", UNIT, 0 },  { "zero", UNIT, 0 },
+    { "एक", UNIT, 1 },     { "one", UNIT, 1 },
+    { "दो", UNIT, 2 },     { "two", UNIT, 2 },
+    { "तीन", UNIT, 3 },    { "three", UNIT, 3 },
+    { "चार", UNIT, 4 },    { "four", UNIT, 4 },
+    { "पाँच", UNIT, 5 },   { "पांच", UNIT, 5 },  { "five", UNIT, 5 },
+    { "छह", UNIT, 6 },     { "छः", UNIT, 6 },    { "छे", UNIT, 6 },  { "six", UNIT, 6 },
+    { "सात", UNIT, 7 },    { "seven", UNIT, 7 },
+    { "आठ", UNIT, 8 },     { "eight", UNIT, 8 },
+    { "नौ", UNIT, 9 },     { "nine", UNIT, 9 },
+    { "दस", UNIT, 10 },    { "ten", UNIT, 10 },
+    { "ग्यारह", UNIT, 11 }, { "eleven", UNIT, 11 },
+    { "बारह", UNIT, 12 },  { "twelve", UNIT, 12 },
+    { "तेरह", UNIT, 13 },  { "thirteen", UNIT, 13 },
+    { "चौदह", UNIT, 14 },  { "fourteen", UNIT, 14 },
+    { "पंद्रह", UNIT, 15 }, { "पन्द्रह", UNIT, 15 }, { "fifteen", UNIT, 15 },
+    { "सोलह", UNIT, 16 },  { "sixteen", UNIT, 16 },
+    { "सत्रह", UNIT, 17 },  { "seventeen", UNIT, 17 },
+    { "अठारह", UNIT, 18 }, { "eighteen", UNIT, 18 },
+    { "उन्नीस", UNIT, 19 }, { "nineteen", UNIT, 19 },
+    { "बीस", UNIT, 20 },   { "twenty", UNIT, 20 },
+    { "इक्कीस", UNIT, 21 }, { "बाईस", UNIT, 22 }, { "तेईस", UNIT, 23 },
+    { "चौबीस", UNIT, 24 }, { "पच्चीस", UNIT, 25 }, { "छब्बीस", UNIT, 26 },
+    { "सत्ताईस", UNIT, 27 }, { "अट्ठाईस", UNIT, 28 }, { "अठाईस", UNIT, 28 },
+    { "उनतीस", UNIT, 29 }, { "उन्तीस", UNIT, 29 },
+    { "तीस", UNIT, 30 },   { "thirty", UNIT, 30 },
+    { "इकतीस", UNIT, 31 }, { "इकत्तीस", UNIT, 31 }, { "बत्तीस", UNIT, 32 },
+    { "तैंतीस", UNIT, 33 }, { "तेंतीस", UNIT, 33 },
+    { "चौंतीस", UNIT, 34 }, { "चौतीस", UNIT, 34 },
+    { "पैंतीस", UNIT, 35 }, { "पेंतीस", UNIT, 35 }, { "छत्तीस", UNIT, 36 },
+    { "सैंतीस", UNIT, 37 }, { "सेंतीस", UNIT, 37 }, { "अड़तीस", UNIT, 38 },
+    { "उनतालीस", UNIT, 39 }, { "उनचालीस", UNIT, 39 },
+    { "चालीस", UNIT, 40 }, { "forty", UNIT, 40 },
+    { "इकतालीस", UNIT, 41 }, { "बयालीस", UNIT, 42 },
+    { "तैंतालीस", UNIT, 43 }, { "तेंतालीस", UNIT, 43 },
+    { "चवालीस", UNIT, 44 }, { "चौवालीस", UNIT, 44 },
+    { "पैंतालीस", UNIT, 45 }, { "पेंतालीस", UNIT, 45 }, { "छियालीस", UNIT, 46 },
+    { "सैंतालीस", UNIT, 47 }, { "सेंतालीस", UNIT, 47 }, { "अड़तालीस", UNIT, 48 },
+    { "उनचास", UNIT, 49 },
+    { "पचास", UNIT, 50 },  { "fifty", UNIT, 50 },
+    { "इक्यावन", UNIT, 51 }, { "बावन", UNIT, 52 },
+    { "तिरेपन", UNIT, 53 }, { "तिरपन", UNIT, 53 },
+    { "चौवन", UNIT, 54 },  { "चौव्वन", UNIT, 54 }, { "पचपन", UNIT, 55 },
+    { "छप्पन", UNIT, 56 }, { "सत्तावन", UNIT, 57 },
+    { "अट्ठावन", UNIT, 58 }, { "अठावन", UNIT, 58 }, { "उनसठ", UNIT, 59 },
+    { "साठ", UNIT, 60 },   { "sixty", UNIT, 60 },
+    { "इकसठ", UNIT, 61 },  { "बासठ", UNIT, 62 },
+    { "तिरेसठ", UNIT, 63 }, { "तिरसठ", UNIT, 63 },
+    { "चौंसठ", UNIT, 64 }, { "चौसठ", UNIT, 64 },
+    { "पैंसठ", UNIT, 65 }, { "पेंसठ", UNIT, 65 }, { "छियासठ", UNIT, 66 },
+    { "सड़सठ", UNIT, 67 }, { "सरसठ", UNIT, 67 }, { "अड़सठ", UNIT, 68 },
+    { "उनहत्तर", UNIT, 69 },
+    { "सत्तर", UNIT, 70 }, { "seventy", UNIT, 70 },
+    { "इकहत्तर", UNIT, 71 }, { "बहत्तर", UNIT, 72 }, { "तिहत्तर", UNIT, 73 },
+    { "चौहत्तर", UNIT, 74 }, { "पचहत्तर", UNIT, 75 }, { "छिहत्तर", UNIT, 76 },
+    { "सतहत्तर", UNIT, 77 }, { "अठहत्तर", UNIT, 78 },
+    { "उन्यासी", UNIT, 79 }, { "उनासी", UNIT, 79 },
+    { "अस्सी", UNIT, 80 }, { "eighty", UNIT, 80 },
+    { "इक्यासी", UNIT, 81 }, { "बयासी", UNIT, 82 }, { "तिरासी", UNIT, 83 },
+    { "चौरासी", UNIT, 84 }, { "पचासी", UNIT, 85 }, { "छियासी", UNIT, 86 },
+    { "सत्तासी", UNIT, 87 }, { "अट्ठासी", UNIT, 88 }, { "नवासी", UNIT, 89 },
+    { "नब्बे", UNIT, 90 }, { "ninety", UNIT, 90 },
+    { "इक्यानवे", UNIT, 91 }, { "इक्यानबे", UNIT, 91 },
+    { "बानवे", UNIT, 92 },  { "बानबे", UNIT, 92 },
+    { "तिरानवे", UNIT, 93 }, { "तिरानबे", UNIT, 93 },
+    { "चौरानवे", UNIT, 94 }, { "चौरानबे", UNIT, 94 },
+    { "पचानवे", UNIT, 95 }, { "पंचानवे", UNIT, 95 }, { "पचानबे", UNIT, 95 },
+    { "छियानवे", UNIT, 96 }, { "छियानबे", UNIT, 96 },
+    { "सत्तानवे", UNIT, 97 }, { "सत्तानबे", UNIT, 97 },
+    { "अट्ठानवे", UNIT, 98 }, { "अट्ठानबे", UNIT, 98 },
+    { "निन्यानवे", UNIT, 99 }, { "निन्यानबे", UNIT, 99 },
+    { "डेढ़", UNIT, 1.5 },  { "डेढ", UNIT, 1.5 },
+    { "ढाई", UNIT, 2.5 },   { "आधा", UNIT, 0.5 },   { "half", UNIT, 0.5 },
+
+    // Indian place values
+    { "सौ", MULT, 1e2 },     { "hundred", MULT, 1e2 },
+    { "हज़ार", MULT, 1e3 },  { "हजार", MULT, 1e3 },  { "thousand", MULT, 1e3 },
+    { "लाख", MULT, 1e5 },   { "lakh", MULT, 1e5 },  { "lakhs", MULT, 1e5 }, { "lac", MULT, 1e5 },
+    { "million", MULT, 1e6 },
+    { "करोड़", MULT, 1e7 },  { "करोड", MULT, 1e7 },  { "crore", MULT, 1e7 }, { "crores", MULT, 1e7 },
+    { "अरब", MULT, 1e9 },   { "billion", MULT, 1e9 },
+
+    // साढ़े तीन = 3.5, सवा सौ = 125, पौने दो = 1.75
+    { "साढ़े", FRACTION, 0.5 }, { "साढे", FRACTION, 0.5 },
+    { "सवा", FRACTION, 0.25 },  { "पौने", FRACTION, -0.25 },
+    { "दशमलव", POINT, 0 },     { "point", POINT, 0 },
+
+    // Operators
+    { "जोड़", OP, 0, '+', INFIX | FINAL | AGG },
+    { "जोड़ो", OP, 0, '+', FINAL },  { "जोड़िए", OP, 0, '+', FINAL },
+    { "जोड़ें", OP, 0, '+', FINAL }, { "जोड़ना", OP, 0, '+', FINAL },
+    { "जोड़कर", OP, 0, '+', FINAL },
+    { "योग", OP, 0, '+', AGG },      { "sum", OP, 0, '+', AGG },  { "total", OP, 0, '+', AGG },
+    { "प्लस", OP, 0, '+', INFIX },   { "plus", OP, 0, '+', INFIX },
+
+    { "घटा", OP, 0, '-', INFIX | FINAL },
+    { "घटाओ", OP, 0, '-', FINAL },   { "घटाइए", OP, 0, '-', FINAL },
+    { "घटाएं", OP, 0, '-', FINAL },  { "घटाना", OP, 0, '-', FINAL },
+    { "घटाकर", OP, 0, '-', FINAL },
+    { "अंतर", OP, 0, '-', AGG },     { "अन्तर", OP, 0, '-', AGG }, { "difference", OP, 0, '-', AGG },
+    { "माइनस", OP, 0, '-', INFIX },  { "minus", OP, 0, '-', INFIX },
+
+    { "गुणा", OP, 0, '*', INFIX | FINAL | AGG },
+    { "गुणे", OP, 0, '*', INFIX },
+    { "गुणनफल", OP, 0, '*', AGG },   { "product", OP, 0, '*', AGG },
+    { "times", OP, 0, '*', INFIX },  { "into", OP, 0, '*', INFIX },
+    { "multiplied", OP, 0, '*', INFIX }, { "x", OP, 0, '*', INFIX },
+
+    { "भाग", OP, 0, '/', INFIX | FINAL },
+    { "बटा", OP, 0, '/', INFIX },
+    { "भागफल", OP, 0, '/', AGG },    { "quotient", OP, 0, '/', AGG },
+    { "divided", OP, 0, '/', INFIX }, { "over", OP, 0, '/', INFIX },
+
+    { "की घात", OP, 0, '^', INFIX }, { "घात", OP, 0, '^', INFIX },
+    { "पावर", OP, 0, '^', INFIX },   { "power", OP, 0, '^', INFIX },
+
+    { "प्रतिशत", PERCENT, 0 }, { "फीसदी", PERCENT, 0 }, { "फ़ीसदी", PERCENT, 0 },
+    { "percent", PERCENT, 0 },
+    { "वर्ग", SQUARE, 0 },  { "square", SQUARE, 0 },  { "squared", SQUARE, 0 },
+    { "घन", CUBE, 0 },      { "cube", CUBE, 0 },      { "cubed", CUBE, 0 },
+    { "वर्गमूल", SQRT, 0 }, { "square root", SQRT, 0 }, { "root", SQRT, 0 },
+
+    // Sentence structure
+    { "और", AND, 0 },  { "तथा", AND, 0 },  { "and", AND, 0 },
+    { "का", KA, 0 },   { "की", KA, 0 },    { "के", KA, 0 },   { "of", KA, 0 },
+    { "को", KO, 0 },   { "से", SE, 0 },
+    { "में से", FROM, 0 }, { "में", MEIN, 0 },
+
+    // Words a question carries around the arithmetic
+    { "क्या", FILLER, 0 },  { "है", FILLER, 0 },    { "हैं", FILLER, 0 },
+    { "होता", FILLER, 0 },  { "होते", FILLER, 0 },  { "होती", FILLER, 0 },
+    { "होगा", FILLER, 0 },  { "होगी", FILLER, 0 },  { "होंगे", FILLER, 0 },
+    { "कितना", FILLER, 0 }, { "कितने", FILLER, 0 }, { "कितनी", FILLER, 0 },
+    { "बताओ", FILLER, 0 },  { "बताइए", FILLER, 0 }, { "बताइये", FILLER, 0 },
+    { "बताएं", FILLER, 0 }, { "करो", FILLER, 0 },   { "करें", FILLER, 0 },
+    { "करिए", FILLER, 0 },  { "कीजिए", FILLER, 0 }, { "कर", FILLER, 0 },
+    { "बराबर", FILLER, 0 }, { "उत्तर", FILLER, 0 }, { "जवाब", FILLER, 0 },
+    { "हल", FILLER, 0 },    { "निकालो", FILLER, 0 }, { "गणना", FILLER, 0 },
+    { "हिसाब", FILLER, 0 }, { "जरा", FILLER, 0 },   { "ज़रा", FILLER, 0 },
+    { "मुझे", FILLER, 0 },  { "बॉस", FILLER, 0 },   { "जी", FILLER, 0 },
+    { "calculate", FILLER, 0 }, { "compute", FILLER, 0 }, { "what", FILLER, 0 },
+    { "what's", FILLER, 0 },    { "whats", FILLER, 0 },   { "is", FILLER, 0 },
+    { "are", FILLER, 0 },       { "equals", FILLER, 0 },  { "the", FILLER, 0 },
+    { "to", FILLER, 0 },        { "by", FILLER, 0 },      { "please", FILLER, 0 },
+};
+
+// Vosk may spell nukta letters precomposed (ड़ = U+095C) or as letter
+// + U+093C; the table is written decomposed
+string composeNukta(const char* s){
+    static const unsigned char BASE[]   = { 0x95, 0x96, 0x97, 0x9C, 0xA1, 0xA2, 0xAB, 0xAF };
+    static const unsigned char NUKTA[]  = { 0x98, 0x99, 0x9A, 0x9B, 0x9C, 0x9D, 0x9E, 0x9F };
+    string out;
+    size_t n = strlen(s);
+    for(size_t i = 0; i < n; ){
+        const unsigned char* p = (const unsigned char*)s + i;
+        if(i + 6 <= n && p[0] == 0xE0 && p[1] == 0xA4 && p[3] == 0xE0 && p[4] == 0xA4 && p[5] == 0xBC){
+            const unsigned char* b = find(begin(BASE), end(BASE), p[2]);
+            if(b != end(BASE)){
+                out += "\xE0\xA5";
+                out += (char)NUKTA[b - BASE];
+                i += 6;
+                continue;
+            }
+        }
+        out += s[i++];
+    }
+    return out;
+}
+
+struct Entry {
+    string_view key;
+    const Word* word;
+    bool operator<(const Entry& o) const { return key < o.key; }
+};
+
+const vector<Entry>& dictionary(){
+    static deque<string> composed;          // stable storage for the variants
+    static const vector<Entry> dict = []{
+        vector<Entry> d;
+        for(const Word& w : WORDS){
+            d.push_back({ w.key, &w });
+            string c = composeNukta(w.key);
+            if(c != w.key){
+                composed.push_back(move(c));
+                d.push_back({ composed.back(), &w });
+            }
+        }
+        sort(d.begin(), d.end());
+        return d;
+    }();
+    return dict;
+}
+
+const Word* lookup(string_view key){
+    const vector<Entry>& d = dictionary();
+    auto it = lower_bound(d.begin(), d.end(), Entry{ key, nullptr });
+    return (it != d.end() && it->key == key) ? it->word : nullptr;
+}
+
+/* ================================================================
+   LEXER — text → lexemes, false at the first unknown word
+================================================================ */
+
+// 0-9 or ०-९ (U+0966-U+096F); -1 otherwise
+int digitAt(string_view s, size_t i, size_t& len){
+    if(i < s.size() && s[i] >= '0' && s[i] <= '9'){ len = 1; return s[i] - '0'; }
+    if(i + 2 < s.size() && (unsigned char)s[i] == 0xE0 && (unsigned char)s[i + 1] == 0xA5 &&
+       (unsigned char)s[i + 2] >= 0xA6 && (unsigned char)s[i + 2] <= 0xAF){
+        len = 3;
+        return (unsigned char)s[i + 2] - 0xA6;
+    }
+    return -1;
+}
+
+// Bytes that end a word: ASCII punctuation and । ॥ × ÷
+size_t symbolLength(string_view s, size_t i){
+    unsigned char c = s[i];
+    if(c < 0x80) return (c && strchr("+-*/^%(),=?!.:;\"", c)) ? 1 : 0;
+    if(i + 1 < s.size() && c == 0xC3 && ((unsigned char)s[i + 1] == 0x97 ||
+                                         (unsigned char)s[i + 1] == 0xB7)) return 2;
+    if(i + 2 < s.size() && c == 0xE0 && (unsigned char)s[i + 1] == 0xA5 &&
+       ((unsigned char)s[i + 2] == 0xA4 || (unsigned char)s[i + 2] == 0xA5)) return 3;
+    return 0;
+}
+
+bool isSpace(char c){ return c == ' ' || c == '\t' || c == '\n' || c == '\r'; }
+
+size_t wordEnd(string_view s, size_t i){
+    while(i < s.size() && !isSpace(s[i]) && symbolLength(s, i) == 0) i++;
+    return i;
+}
+
+int lex(string_view s, Lex* out){
+    int n = 0;
+    auto emit = [&](const Lex& l){
+        if(n == MAX_LEX) return false;
+        out[n++] = l;
+        return true;
+    };
+
+    size_t i = 0;
+    while(i < s.size()){
+        if(isSpace(s[i])){ i++; continue; }
+
+        // Digit literal: 25, १२, 1,00,000, 2.5
+        size_t len;
+        bool   point = s[i] == '.' && digitAt(s, i + 1, len) >= 0;
+        if(digitAt(s, i, len) >= 0 || point){
+            Lex l{ UNIT };
+            double scale = 0;
+            for(int d; i < s.size(); ){
+                if((d = digitAt(s, i, len)) >= 0){
+                    if(scale > 0){ l.value += d * scale; scale /= 10; }
+                    else         { l.value = l.value * 10 + d; l.digits++; }
+                    i += len;
+                } else if(s[i] == ',' && scale == 0 && digitAt(s, i + 1, len) >= 0){
+                    i++;                                  // Indian grouping
+                } else if(s[i] == '.' && scale == 0 && digitAt(s, i + 1, len) >= 0){
+                    scale = 0.1;
+                    i++;
+                } else break;
+            }
+            if(!emit(l)) return -1;
+            continue;
+        }
+
+        if(size_t sym = symbolLength(s, i)){
+            Lex l{ FILLER };
+            unsigned char c = s[i];
+            if(c == 0xC3){                                  // × ÷
+                l.kind  = OP;
+                l.op    = (unsigned char)s[i + 1] == 0x97 ? '*' : '/';
+                l.flags = INFIX;
+            }
+            else if(sym > 1) {}                             // । ॥
+            else if(strchr("+-*/^", c)){ l.kind = OP; l.op = c; l.flags = INFIX; }
+            else if(c == '%') l.kind = PERCENT;
+            else if(c == '(') l.kind = LPAREN;
+            else if(c == ')') l.kind = RPAREN;
+            else if(c == ',') l.kind = AND;
+            i += sym;
+            if(l.kind != FILLER && !emit(l)) return -1;
+            continue;
+        }
+
+        // Word, or two words forming one key ("में से", "की घात")
+        size_t end = wordEnd(s, i);
+        const Word* w = nullptr;
+        if(end + 1 < s.size() && s[end] == ' ' && !isSpace(s[end + 1])){
+            size_t end2 = wordEnd(s, end + 1);
+            if(end2 > end + 1 && (w = lookup(s.substr(i, end2 - i))))
+                end = end2;
+        }
+        if(!w) w = lookup(s.substr(i, end - i));
+        if(!w) return -1;
+
+        if(w->kind != FILLER){
+            Lex l{ w->kind, w->value, w->op, w->flags };
+            l.fromWord = true;
+            l.isDo     = strcmp(w->key, "दो") == 0;
+            if(!emit(l)) return -1;
+        }
+        i = end;
+    }
+    return n;
+}
+
+/* ================================================================
+   NUMBER PHRASES — "पाँच लाख पच्चीस हज़ार", "साढ़े तीन सौ"
+================================================================ */
+
+// Consumes one number from lx[i...]; false if it is malformed
+bool numberPhrase(const Lex* lx, int n, int& i, Lex& out){
+    double total = 0, cur = 0, pending = 0, lastBig = 0, scale = 0;
+    bool   hasCur = false, lastUnit = false, any = false;
+    double lastValue = 0;
+    bool   lastWord  = false;
+    int    start = i;
+
+    for(; i < n; i++){
+        const Lex& l = lx[i];
+        if(l.kind == UNIT){
+            if(scale > 0){                                  // after दशमलव
+                if(l.fromWord){
+                    if(l.value != floor(l.value) || l.value > 9) break;
+                    cur   += l.value * scale;
+                    scale /= 10;
+                } else {
+                    double shift = pow(10.0, -l.digits);
+                    cur   += l.value * shift * scale * 10;
+                    scale *= shift;
+                }
+                any = true;
+                continue;
+            }
+            // "twenty five": a tens word then a units word
+            bool tensUnit = lastUnit && lastWord && l.fromWord && lastValue >= 20 &&
+                            lastValue <= 90 && fmod(lastValue, 10) == 0 &&
+                            l.value >= 1 && l.value < 10;
+            if(lastUnit && !tensUnit) break;               // "25 30": two numbers
+            cur      += l.value + pending;
+            pending   = 0;
+            hasCur    = true;
+            lastUnit  = true;
+            lastValue = l.value;
+            lastWord  = l.fromWord;
+            any       = true;
+        } else if(l.kind == MULT){
+            scale = 0;
+            double base = hasCur ? cur : (total == 0 ? 1 + pending : 0);
+            if(l.value == 100){
+                cur    = base * 100;
+                hasCur = true;
+            } else {
+                // "दो हज़ार करोड़": a larger place value scales what came before
+                if(l.value > lastBig && total > 0) total = (total + base) * l.value;
+                else                               total += base * l.value;
+                lastBig = l.value;
+                cur     = 0;
+                hasCur  = false;
+            }
+            pending  = 0;
+            lastUnit = false;
+            any      = true;
+        } else if(l.kind == FRACTION){
+            if(lastUnit || scale > 0) break;
+            pending += l.value;
+        } else if(l.kind == POINT){
+            if(scale > 0) break;
+            scale    = 0.1;
+            lastUnit = false;
+        } else break;
+    }
+    if(!any || pending != 0) return false;
+
+    out        = Lex{ NUM, total + cur };
+    out.isDo   = (i - start == 1 && lx[start].isDo);
+    return true;
+}
+
+int mergeNumbers(const Lex* lx, int n, Lex* out){
+    int m = 0;
+    for(int i = 0; i < n; ){
+        Kind k = lx[i].kind;
+        if(k == UNIT || k == MULT || k == FRACTION || k == POINT){
+            if(!numberPhrase(lx, n, i, out[m++])) return -1;
+        } else {
+            out[m++] = lx[i++];
+        }
+    }
+    return m;
+}
+
+/* ================================================================
+   PARSER
+   sentence := expr ( (और expr)+ [का AGG | FINAL]
+                    | (में से | में) expr FINAL
+                    | को expr से OP ) ["दो"]
+   expr     := term (('+' | '-') term)*
+   term     := unary (('*' | '/' | का) unary)*      का = "of"
+   unary    := '-' unary | power
+   power    := postfix ['^' unary]
+   postfix  := primary ('%' | [का] वर्ग | [का] घन | [का] वर्गमूल)*
+   primary  := NUM | '(' expr ')' | (वर्ग | घन | वर्गमूल) [का] postfix
+================================================================ */
+
+struct Parser {
+    const Lex* t = nullptr;
+    int        n = 0;
+    int        i = 0;
+    MathResult r;
+    char       op = 0;              // last binary operation
+    double     lhs = 0, rhs = 0;
+
+    const Lex& peek(int k = 0) const {
+        static const Lex END_LEX{ END };
+        return i + k < n ? t[i + k] : END_LEX;
+    }
+    bool ok() const { return r.status == MathStatus::Ok; }
+    double fail(MathStatus s = MathStatus::NotMath){
+        if(ok()) r.status = s;
+        return 0;
+    }
+    bool isOp(int k, const char* ops, uint8_t where) const {
+        const Lex& l = peek(k);
+        return l.kind == OP && (l.flags & where) && strchr(ops, l.op);
+    }
+    bool operandAt(int k) const {
+        Kind c = peek(k).kind;
+        return c == NUM || c == LPAREN || c == SQUARE || c == CUBE || c == SQRT ||
+               (isOp(k, "-", INFIX) && operandAt(k + 1));
+    }
+
+    double apply(char o, double a, double b){
+        r.operations++;
+        op = o; lhs = a; rhs = b;
+        switch(o){
+            case '+': return a + b;
+            case '-': return a - b;
+            case '*': return a * b;
+            case '/': return b == 0 ? fail(MathStatus::DivideByZero) : a / b;
+            case '^': return pow(a, b);
+        }
+        return fail();
+    }
+
+    double unaryOp(Kind k, double v){
+        r.operations++;
+        if(k == SQUARE) return v * v;
+        if(k == CUBE)   return v * v * v;
+        return v < 0 ? fail(MathStatus::OutOfRange) : sqrt(v);
+    }
+
+    void swallowDo(){
+        if(peek().kind == NUM && peek().isDo && i + 1 == n) i++;
+    }
+
+    double sentence(){
+        double a = expr();
+        if(!ok()) return 0;
+
+        Kind k = peek().kind;
+        if(k == AND){
+            double items[MAX_LEX];
+            int    count = 0;
+            items[count++] = a;
+            while(peek().kind == AND && ok()){
+                i++;
+                items[count++] = expr();
+            }
+            char o = '+';                                   // "दो और दो"
+            if(peek().kind == KA && isOp(1, "+-*/", AGG)){ o = peek(1).op; i += 2; }
+            else if(isOp(0, "+-*/", FINAL))              { o = peek().op;  i++; }
+            swallowDo();
+            a = items[0];
+            for(int j = 1; j < count && ok(); j++) a = apply(o, a, items[j]);
+        } else if(k == FROM || k == MEIN){
+            i++;
+            double b = expr();
+            if(!ok() || !isOp(0, "+-*/", FINAL)) return fail();
+            char o = peek().op;
+            i++;
+            swallowDo();
+            a = apply(o, a, b);
+        } else if(k == KO){
+            i++;
+            double b = expr();
+            if(!ok() || peek().kind != SE) return fail();
+            i++;
+            if(!isOp(0, "+-*/^", FINAL | INFIX)) return fail();
+            char o = peek().op;
+            i++;
+            swallowDo();
+            a = apply(o, a, b);
+        }
+        if(ok() && peek().kind != END) return fail();
+        return a;
+    }
+
+    double expr(){
+        double v = term();
+        while(ok() && isOp(0, "+-", INFIX) && operandAt(1)){
+            char o = peek().op;
+            i++;
+            v = apply(o, v, term());
+        }
+        return v;
+    }
+
+    double term(){
+        double v = unary();
+        while(ok()){
+            if(isOp(0, "*/", INFIX) && operandAt(1)){
+                char o = peek().op;
+                i++;
+                v = apply(o, v, unary());
+            } else if(peek().kind == KA && operandAt(1)){   // "200 का 15 प्रतिशत"
+                i++;
+                v = apply('*', v, unary());
+            } else break;
+        }
+        return v;
+    }
+
+    double unary(){
+        if(isOp(0, "-", INFIX) && operandAt(1)){
+            i++;
+            return -unary();
+        }
+        return power();
+    }
+
+    double power(){
+        double v = postfix();
+        if(ok() && isOp(0, "^", INFIX) && operandAt(1)){
+            i++;
+            v = apply('^', v, unary());
+        }
+        return v;
+    }
+
+    double postfix(){
+        double v = primary();
+        while(ok()){
+            Kind k = peek().kind;
+            int  at = (k == KA) ? 1 : 0;
+            Kind f  = peek(at).kind;
+            if(k == PERCENT){
+                i++;
+                r.operations++;
+                v /= 100;
+            } else if(f == SQUARE || f == CUBE || f == SQRT){
+                i += at + 1;
+                v = unaryOp(f, v);
+            } else break;
+        }
+        return v;
+    }
+
+    double primary(){
+        const Lex& l = peek();
+        if(l.kind == NUM){
+            i++;
+            return l.value;
+        }
+        if(l.kind == LPAREN){
+            i++;
+            double v = expr();
+            if(!ok() || peek().kind != RPAREN) return fail();
+            i++;
+            return v;
+        }
+        if(l.kind == SQUARE || l.kind == CUBE || l.kind == SQRT){   // "square root of 81"
+            Kind f = l.kind;
+            i++;
+            if(peek().kind == KA) i++;
+            double v = postfix();
+            return ok() ? unaryOp(f, v) : 0;
+        }
+        return fail();
+    }
+};
+
+}  // namespace
+
+/* ================================================================
+   EVALUATE
+================================================================ */
+
+MathResult evaluateArithmetic(string_view text){
+    Lex raw[MAX_LEX], toks[MAX_LEX];
+    int n = lex(text, raw);
+    if(n > 0) n = mergeNumbers(raw, n, toks);
+    if(n <= 0) return MathResult();
+
+    Parser p;
+    p.t        = toks;
+    p.n        = n;
+    p.r.status = MathStatus::Ok;
+    double v = p.sentence();
+
+    MathResult r = p.r;
+    if(r.status == MathStatus::Ok && r.operations == 0) return MathResult();
+    if(r.status == MathStatus::Ok && !isfinite(v)) r.status = MathStatus::OutOfRange;
+    if(r.status == MathStatus::NotMath) return MathResult();
+    r.value = v;
+    if(r.operations == 1 && p.op){
+        r.op  = p.op;
+        r.lhs = p.lhs;
+        r.rhs = p.rhs;
+    }
+    return r;
+}
+
+/* ================================================================
+   FORMAT — Indian place values for large whole numbers
+================================================================ */
+
+string formatHindiNumber(double v){
+    if(!isfinite(v)) return "";
+    double a = round(fabs(v) * 1e4) / 1e4;
+    string out = (v < 0 && a != 0) ? "ऋण " : "";
+
+    if(a == floor(a) && a < 1e15){
+        long long n = (long long)a;
+        if(n < 100000) return out + to_string(n);
+
+        string words;
+        auto part = [&](long long q, const char* name){
+            if(q == 0) return;
+            if(!words.empty()) words += ' ';
+            words += to_string(q) + " " + name;
+        };
+        part(n / 10000000,     "करोड़");
+        part(n / 100000 % 100, "लाख");
+        part(n / 1000 % 100,   "हज़ार");
+        if(n % 1000) words += " " + to_string(n % 1000);
+        return out + words;
+    }
+
+    char buf[64];
+    snprintf(buf, sizeof(buf), a < 1e15 ? "%.4f" : "%.0f", a);
+    string s = buf;
+    if(s.find('.') != string::npos){
+        s.erase(s.find_last_not_of('0') + 1);
+        if(s.back() == '.') s.pop_back();
+    }
+    return out + s;
+}
@@ -0,0 +1,38 @@
+#pragma once
+#include <string>
+#include <string_view>
+
+/*
+ * Spoken arithmetic, as Vosk transcribes it.
+ *
+ * Numbers: ASCII and Devanagari digits (०-९), Hindi and English
+ * number words composed the Indian way ("पाँच लाख पच्चीस हज़ार",
+ * "साढ़े तीन सौ", "twenty five"), "दशमलव" / "point" decimals.
+ * Expressions: + − × ÷ with precedence, parentheses, powers
+ * ("2 की घात 10"), percentages ("200 का 15 प्रतिशत"), squares,
+ * cubes and square roots, plus the sentence forms
+ *   "25 और 30 का जोड़"   "100 में से 45 घटाओ"   "12 को 8 से गुणा करो"
+ *
+ * Any word that is neither a number, an operator nor a known filler
+ * ("क्या", "कितना", "बताओ", ...) makes the text NotMath, so a
+ * knowledge question is rejected at its first unknown word. Parsing
+ * works on fixed-size token arrays and never allocates.
+ */
+
+enum class MathStatus { Ok, NotMath, DivideByZero, OutOfRange };
+
+struct MathResult {
+    MathStatus status     = MathStatus::NotMath;
+    double     value      = 0;
+    int        operations = 0;     // NotMath unless at least one
+
+    // When the whole text is one + − × ÷ on two numbers
+    char       op  = 0;
+    double     lhs = 0;
+    double     rhs = 0;
+};
+
+MathResult evaluateArithmetic(std::string_view text);   // ASCII lowercased
+
+// "55", "2.5", "ऋण 3", "1 करोड़ 23 लाख 45 हज़ार 678"
+std::string formatHindiNumber(double v);
@@ -0,0 +1,135 @@
+/*
+ * ============================================================
+ *  PRIMUS AI v2.0 — Knowledge Ingest
+ *  Usage: ./primus_ingest knowledge.db SOURCE... [--format F]
+ *           [--prune] [--dry-run] [--batch N] [--snapshot FILE]
+ *
+ *  Loads CSV, TSV or seed SQL files into the knowledge table in
+ *  place: only new and changed rows are written, and FTS follows
+ *  them through its triggers (see knowledge_ingest.h). Safe to
+ *  run while hindi_ai is serving from the same database.
+ *
+ *  --format F       csv, tsv or sql (default: by extension; "-"
+ *                   reads stdin and needs it)
+ *  --prune          delete rows that are in no SOURCE
+ *  --dry-run        report what would change, write nothing
+ *  --batch N        written rows per transaction (default 50000)
+ *  --snapshot FILE  recompile the keyword snapshot if rows changed
+ * ============================================================
+ */
+
+#include "knowledge_ingest.h"
+#include "knowledge_snapshot.h"
+#include "enhancer.h"
+
+#include <sqlite3.h>
+#include <iostream>
+#include <string>
+#include <vector>
+#include <chrono>
+#include <algorithm>
+#include <iomanip>
+#include <cstring>
+#include <cstdlib>
+#include <unistd.h>
+
+using namespace std;
+
+static void usage(const char* argv0){
+    cerr << "Usage: " << argv0 << " knowledge.db SOURCE... [--format csv|tsv|sql]\n"
+            "       [--prune] [--dry-run] [--batch N] [--snapshot FILE]\n";
+}
+
+int main(int argc, char** argv){
+    string         dbPath, snapPath;
+    vector<string> sources;
+    IngestFormat   format = IngestFormat::Auto;
+    IngestOptions  opt;
+
+    for(int i = 1; i < argc; i++){
+        string a = argv[i];
+        if(a == "--prune")        opt.prune  = true;
+        else if(a == "--dry-run") opt.dryRun = true;
+        else if(a == "--batch" && i + 1 < argc) opt.batch = max(1LL, atoll(argv[++i]));
+        else if(a == "--snapshot" && i + 1 < argc) snapPath = argv[++i];
+        else if(a == "--format" && i + 1 < argc){
+            string f = argv[++i];
+            if(f == "csv")      format = IngestFormat::Csv;
+            else if(f == "tsv") format = IngestFormat::Tsv;
+            else if(f == "sql") format = IngestFormat::Sql;
+            else { usage(argv[0]); return 2; }
+        }
+        else if(a.size() > 2 && a.compare(0, 2, "--") == 0){ usage(argv[0]); return 2; }
+        else if(dbPath.empty()) dbPath = a;
+        else sources.push_back(a);
+    }
+    if(dbPath.empty() || sources.empty()){
+        usage(argv[0]);
+        return 2;
+    }
+
+    sqlite3* db = nullptr;
+    if(sqlite3_open(dbPath.c_str(), &db) != SQLITE_OK){
+        cerr << "DB Error: " << sqlite3_errmsg(db) << "\n";
+        sqlite3_close(db);
+        return 1;
+    }
+    // The assistant's readers never block us; another writer might
+    sqlite3_busy_timeout(db, 5000);
+
+    bool ok;
+    IngestStats total;
+    {
+        KnowledgeIngest ingest(db, opt);
+        ok = ingest.begin();
+        for(size_t i = 0; ok && i < sources.size(); i++){
+            IngestStats before = ingest.stats();
+            auto t0 = chrono::steady_clock::now();
+            ok = ingest.addSource(sources[i], format);
+            if(!ok) break;
+            const IngestStats& now = ingest.stats();
+            double ms = chrono::duration<double, milli>(chrono::steady_clock::now() - t0).count();
+            cout << "  " << sources[i] << ": " << now.read - before.read << " records, "
+                 << now.inserted - before.inserted << " new, "
+                 << now.updated - before.updated << " changed ("
+                 << (int)ms << " ms)\n";
+        }
+        ok = ok && ingest.finish();
+        total = ingest.stats();
+    }
+    if(!ok){
+        sqlite3_close(db);
+        cerr << "Ingest failed, the last batch was rolled back: " << dbPath << "\n";
+        return 1;
+    }
+
+    cout << (opt.dryRun ? "🔍 " : "✅ ") << dbPath << ": " << total.read << " read, "
+         << total.inserted << " inserted, " << total.updated << " updated, "
+         << total.unchanged << " unchanged, " << total.deleted << " deleted";
+    if(total.skipped) cout << ", " << total.skipped << " skipped";
+    cout << " (" << fixed << setprecision(2) << total.seconds << " s, "
+         << (size_t)(total.read / max(total.seconds, 1e-3)) << " records/s)"
+         << (total.ftsBuilt ? ", FTS built" : "")
+         << (opt.dryRun ? ", dry run: nothing written" : "") << "\n";
+
+    // Same compile as primus_snapshot, only when there is news
+    if(!snapPath.empty() && !opt.dryRun &&
+       (total.written() > 0 || access(snapPath.c_str(), F_OK) != 0))
+    {
+        auto t0 = chrono::steady_clock::now();
+        Enhancer enhancer;
+        size_t rows = 0;
+        if(!KnowledgeSnapshot::compile(db, snapPath,
+                                       [&](const string& q){ return enhancer.preprocess(q); },
+                                       enhancer.fingerprint(), &rows))
+        {
+            cerr << "Snapshot write failed: " << snapPath << "\n";
+            sqlite3_close(db);
+            return 1;
+        }
+        double ms = chrono::duration<double, milli>(chrono::steady_clock::now() - t0).count();
+        cout << "✅ " << snapPath << ": " << rows << " rows (" << (int)ms << " ms)\n";
+    }
+    sqlite3_close(db);
+    return 0;
+}
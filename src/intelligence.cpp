@@ -6,6 +6,8 @@
  */
 
 #include "intelligence.h"
+#include <map>
+#include <vector>
 #include <sstream>
 #include <algorithm>
 #include <chrono>
@@ -32,13 +34,13 @@ Intelligence::Intelligence(){
     lastSubject  = "";
     lastTopic    = "";
     currentEmotion = "neutral";
-    loadTopicKeywords();
 }
 
-/* ===== TOPIC KEYWORDS MAP ===== */
+/* ===== TOPIC KEYWORDS MAP =====
+   Shared by every session; a context only holds its own turns */
 
-void Intelligence::loadTopicKeywords(){
-    topicKeywords = {
+static const map<string, string>& topicKeywords(){
+    static const map<string, string> TOPICS = {
         {"राजनीति",    "चुनाव मोदी गांधी भाजपा कांग्रेस संसद सरकार मंत्री विधायक सांसद"},
         {"सिनेमा",     "फिल्म बॉलीवुड अभिनेता अभिनेत्री निर्देशक ऑस्कर फिल्मफेयर"},
         {"भूगोल",      "राज्य नदी पर्वत राजधानी जिला क्षेत्रफल जनसंख्या"},
@@ -48,6 +50,7 @@ void Intelligence::loadTopicKeywords(){
         {"खेल",        "क्रिकेट फुटबॉल ओलंपिक विश्वकप टूर्नामेंट"},
         {"अर्थव्यवस्था","जीडीपी बजट रुपया बैंक व्यापार निर्यात"}
     };
+    return TOPICS;
 }
 
 /* ===== TOPIC DETECTION ===== */
@@ -56,7 +59,7 @@ string Intelligence::detectTopic(const string& input){
     int bestScore = 0;
     string bestTopic = "सामान्य";
 
-    for(auto& [topic, keywords] : topicKeywords){
+    for(auto& [topic, keywords] : topicKeywords()){
         int score = 0;
         stringstream ss(keywords);
         string kw;
@@ -186,3 +189,19 @@ void Intelligence::detectEmotion(const string& input){
 string Intelligence::getEmotion() const{
     return currentEmotion;
 }
+
+/* ===== MEMORY FOOTPRINT ===== */
+
+static size_t heapBytes(const string& s){
+    // Short strings live inside the object (SSO)
+    return s.capacity() > 15 ? s.capacity() + 1 : 0;
+}
+
+size_t Intelligence::memoryBytes() const {
+    size_t n = sizeof(*this) + heapBytes(lastSubject) + heapBytes(lastTopic) +
+               heapBytes(currentEmotion);
+    for(auto& t : history)
+        n += sizeof(t) + heapBytes(t.userInput) + heapBytes(t.aiResponse) +
+             heapBytes(t.topic) + heapBytes(t.subject);
+    return n;
+}
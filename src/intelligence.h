@@ -1,8 +1,7 @@
 #pragma once
 #include <string>
-#include <vector>
-#include <map>
 #include <deque>
+#include <cstddef>
 
 struct ConversationTurn {
     std::string userInput;
@@ -24,7 +23,11 @@ public:
     // Enhanced context
     std::string getLastSubject() const { return lastSubject; }
     std::string getLastTopic()   const { return lastTopic; }
-    std::vector<ConversationTurn> getHistory() const { return history; }
+    // Oldest turn first; valid until the next updateContext()
+    const std::deque<ConversationTurn>& getHistory() const { return history; }
+
+    // Approximate heap + object footprint, for session memory caps
+    size_t memoryBytes() const;
 
     // Topic detection
     std::string detectTopic(const std::string& input);
@@ -37,7 +40,4 @@ private:
     std::string lastTopic;
     std::string currentEmotion;
     std::deque<ConversationTurn> history;   // last 10 turns
-    std::map<std::string, std::string> topicKeywords;
-
-    void loadTopicKeywords();
 };
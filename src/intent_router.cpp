@@ -0,0 +1,105 @@
+/*
+ * ============================================================
+ *  PRIMUS AI - Intent Router
+ *  Declarative intent table → one word-boundary DFA scan
+ * ============================================================
+ */
+
+#include "intent_router.h"
+
+using namespace std;
+
+/* ===== INTENT TABLE =====
+   Inflected forms are listed explicitly: with word boundaries
+   "जोड़" no longer covers "जोड़ो" by accident. */
+
+const vector<IntentRule>& IntentRouter::defaultRules(){
+    static const vector<IntentRule> RULES = {
+        { Intent::Greeting, nullptr, nullptr,
+          "hello|hey|नमस्ते|नमस्कार|हाय|हेलो" },
+
+        { Intent::Time, nullptr, nullptr,
+          "समय|टाइम|time|कितने बजे|क्या बजा" },
+
+        { Intent::Date, nullptr, nullptr,
+          "तारीख|दिनांक|डेट|date" },
+
+        { Intent::Math, "op", "+",
+          "जोड़|जोड़ो|जोड़िए|जोड़ें|जोड़कर|जोड़ना|plus|add|+" },
+        { Intent::Math, "op", "-",
+          "घटाओ|घटाइए|घटाएं|घटाकर|घटाना|minus|subtract|-" },
+        { Intent::Math, "op", "*",
+          "गुणा|गुणा करो|multiply|*" },
+        { Intent::Math, "op", "/",
+          "भाग|भाग दो|भाग करो|divide|/" },
+        { Intent::Math, nullptr, nullptr,
+          "calculate" },
+
+        { Intent::Help, nullptr, nullptr,
+          "मदद|help" },
+
+        { Intent::FollowUp, nullptr, nullptr,
+          "और बताओ|आगे बताओ|विस्तार|विस्तार से" },
+    };
+    return RULES;
+}
+
+const char* intentName(Intent intent){
+    switch(intent){
+        case Intent::Greeting:  return "greeting";
+        case Intent::Time:      return "time";
+        case Intent::Date:      return "date";
+        case Intent::Math:      return "math";
+        case Intent::Help:      return "help";
+        case Intent::FollowUp:  return "follow_up";
+        case Intent::Knowledge: return "knowledge";
+    }
+    return "?";
+}
+
+const IntentSlot* Route::slot(const char* name) const {
+    for(auto& s : slots)
+        if(string(s.name) == name) return &s;
+    return nullptr;
+}
+
+/* ================================================================
+   COMPILE
+================================================================ */
+
+IntentRouter::IntentRouter() : IntentRouter(defaultRules()) {}
+
+IntentRouter::IntentRouter(const vector<IntentRule>& table) : rules(table) {
+    for(size_t r = 0; r < rules.size(); r++){
+        string phrases = rules[r].phrases;
+        size_t from = 0;
+        while(from <= phrases.size()){
+            size_t bar = phrases.find('|', from);
+            if(bar == string::npos) bar = phrases.size();
+            matcher.add(phrases.substr(from, bar - from), r);
+            from = bar + 1;
+        }
+    }
+    matcher.compile();
+}
+
+/* ================================================================
+   ROUTE — highest-priority intent among the matched phrases
+================================================================ */
+
+Route IntentRouter::route(const string& text) const {
+    thread_local vector<PhraseMatch> found;
+    matcher.findAll(text, found);
+
+    Route out;
+    for(auto& m : found)
+        if(rules[m.id].intent < out.intent)
+            out.intent = rules[m.id].intent;
+
+    for(auto& m : found){
+        const IntentRule& r = rules[m.id];
+        if(r.intent == out.intent && r.slot)
+            out.slots.push_back({ r.slot, r.value, m.start, m.length });
+    }
+    return out;
+}
@@ -0,0 +1,59 @@
+#pragma once
+#include <string>
+#include <vector>
+#include <cstddef>
+
+#include "phrase_matcher.h"
+
+/*
+ * Utterance → intent, decided once per query.
+ *
+ * The intent table (intent, optional slot, trigger phrases) is
+ * compiled into one PhraseMatcher, so routing is a single scan and
+ * phrases only match whole words: "भाग" (divide) no longer fires
+ * inside "विभाग" or "भागलपुर". When phrases of several intents
+ * occur, the one listed first in Intent wins, as the old if/else
+ * chain did.
+ */
+
+// Declaration order is priority order
+enum class Intent { Greeting, Time, Date, Math, Help, FollowUp, Knowledge };
+
+const char* intentName(Intent intent);
+
+struct IntentSlot {
+    const char* name;      // e.g. "op"
+    const char* value;     // e.g. "+"
+    size_t      start;     // byte span of the phrase in the text
+    size_t      length;
+};
+
+struct Route {
+    Intent                  intent = Intent::Knowledge;
+    std::vector<IntentSlot> slots;     // from phrases of that intent, in text order
+
+    // First slot with this name, or null
+    const IntentSlot* slot(const char* name) const;
+};
+
+struct IntentRule {
+    Intent      intent;
+    const char* slot;      // null = the phrases only select the intent
+    const char* value;
+    const char* phrases;   // '|'-separated, lowercase
+};
+
+class IntentRouter {
+public:
+    IntentRouter();                                        // built-in table
+    explicit IntentRouter(const std::vector<IntentRule>& table);
+
+    // text lowercased (ASCII) by the caller; safe to call concurrently
+    Route route(const std::string& text) const;
+
+    static const std::vector<IntentRule>& defaultRules();
+
+private:
+    std::vector<IntentRule> rules;
+    PhraseMatcher           matcher;   // match id = index into rules
+};
@@ -0,0 +1,60 @@
+#pragma once
+#include <string>
+#include <cstdint>
+#include <cstddef>
+
+/*
+ * Framed messages for server mode (hindi_ai --serve SOCKET).
+ *
+ * Every frame, both directions, little-endian:
+ *
+ *   u32 length      bytes after this field (40 + session + text)
+ *   u32 magic       "PRQ1"
+ *   u16 type        IPC_QUERY / IPC_REPLY / IPC_ERROR
+ *   u16 flags       IPC_SPEAK: server speaks the reply itself
+ *   u64 id          chosen by the client, echoed in the reply
+ *   i64 answerId    knowledge.id behind the reply, -1 otherwise
+ *   u32 queueUs     frame received → handling started
+ *   u32 computeUs   time spent answering
+ *   u32 totalUs     frame received → reply queued
+ *   u16 sessionLen  conversation id length, 0 = one per connection
+ *   u16 reserved
+ *   ... session     UTF-8 (room, speaker), echoed in the reply
+ *   ... text        UTF-8, may contain newlines
+ *
+ * Timing and answerId are zero / -1 in queries.
+ * scripts/primus_ipc.py is the Python side of this format.
+ */
+
+static const uint32_t IPC_MAGIC     = 0x31515250;   // "PRQ1"
+static const size_t   IPC_HEADER    = 40;
+static const size_t   IPC_MAX_FRAME = 1 << 20;
+
+enum IpcType : uint16_t {
+    IPC_QUERY = 1,
+    IPC_REPLY = 2,
+    IPC_ERROR = 3,
+};
+
+enum IpcFlags : uint16_t {
+    IPC_SPEAK = 1,
+};
+
+struct IpcMessage {
+    uint16_t    type      = IPC_QUERY;
+    uint16_t    flags     = 0;
+    uint64_t    id        = 0;
+    int64_t     answerId  = -1;
+    uint32_t    queueUs   = 0;
+    uint32_t    computeUs = 0;
+    uint32_t    totalUs   = 0;
+    std::string session;
+    std::string text;
+};
+
+// Appends one frame to out
+void ipcEncode(const IpcMessage& m, std::string& out);
+
+// 1 = one frame decoded (used = its size), 0 = need more bytes,
+// -1 = not our protocol or oversized; drop the connection
+int  ipcDecode(const char* buf, size_t len, IpcMessage& out, size_t& used);
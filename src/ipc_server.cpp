@@ -0,0 +1,367 @@
+/*
+ * ============================================================
+ *  PRIMUS AI - IPC Server
+ *  Length-prefixed frames over a Unix domain socket
+ * ============================================================
+ */
+
+#include "ipc_server.h"
+#include "trace.h"
+
+#include <iostream>
+#include <algorithm>
+#include <cstring>
+#include <cerrno>
+#include <unistd.h>
+#include <fcntl.h>
+#include <poll.h>
+#include <sys/eventfd.h>
+#include <sys/socket.h>
+#include <sys/stat.h>
+#include <sys/un.h>
+
+using namespace std;
+
+static const TraceStage TRACE_QUEUE ("ipc.queue");     // received → picked up by a worker
+static const TraceStage TRACE_HANDLE("ipc.handle");
+
+/* ================================================================
+   FRAMING
+================================================================ */
+
+static void put16(string& out, uint16_t v){
+    out += (char)(v & 0xff);
+    out += (char)(v >> 8);
+}
+
+static void put32(string& out, uint32_t v){
+    for(int i = 0; i < 4; i++) out += (char)((v >> (8 * i)) & 0xff);
+}
+
+static void put64(string& out, uint64_t v){
+    for(int i = 0; i < 8; i++) out += (char)((v >> (8 * i)) & 0xff);
+}
+
+static uint64_t get(const char* p, int bytes){
+    uint64_t v = 0;
+    for(int i = 0; i < bytes; i++) v |= (uint64_t)(unsigned char)p[i] << (8 * i);
+    return v;
+}
+
+void ipcEncode(const IpcMessage& m, string& out){
+    size_t session = min(m.session.size(), (size_t)UINT16_MAX);
+    out.reserve(out.size() + 4 + IPC_HEADER + session + m.text.size());
+    put32(out, (uint32_t)(IPC_HEADER + session + m.text.size()));
+    put32(out, IPC_MAGIC);
+    put16(out, m.type);
+    put16(out, m.flags);
+    put64(out, m.id);
+    put64(out, (uint64_t)m.answerId);
+    put32(out, m.queueUs);
+    put32(out, m.computeUs);
+    put32(out, m.totalUs);
+    put16(out, (uint16_t)session);
+    put16(out, 0);
+    out.append(m.session, 0, session);
+    out += m.text;
+}
+
+int ipcDecode(const char* buf, size_t len, IpcMessage& m, size_t& used){
+    if(len < 8) return 0;
+    size_t body = get(buf, 4);
+    // Check the magic before waiting for the body: a stray text client
+    // ("hello\n") must not leave us waiting for a 1.8 GB frame
+    if(get(buf + 4, 4) != IPC_MAGIC || body < IPC_HEADER || body > IPC_MAX_FRAME) return -1;
+    if(len < 4 + body) return 0;
+
+    const char* p = buf + 8;
+    m.type      = (uint16_t)get(p, 2);
+    m.flags     = (uint16_t)get(p + 2, 2);
+    m.id        = get(p + 4, 8);
+    m.answerId  = (int64_t)get(p + 12, 8);
+    m.queueUs   = (uint32_t)get(p + 20, 4);
+    m.computeUs = (uint32_t)get(p + 24, 4);
+    m.totalUs   = (uint32_t)get(p + 28, 4);
+    size_t session = get(p + 32, 2);
+    if(session > body - IPC_HEADER) return -1;
+    m.session.assign(buf + 4 + IPC_HEADER, session);
+    m.text.assign(buf + 4 + IPC_HEADER + session, body - IPC_HEADER - session);
+    used = 4 + body;
+    return 1;
+}
+
+/* ================================================================
+   SERVER
+================================================================ */
+
+static const size_t MAX_CLIENTS = 64;
+
+// Queries received but not yet handed to a worker, per client. Past
+// this the server stops reading from it: a client that pipelines
+// faster than it is answered waits in its socket buffer, not in ours
+static const size_t MAX_PENDING = 8;
+
+// Nor are more queries answered while this much of its replies is
+// still unsent: one that never reads would grow c.out instead
+static const size_t MAX_UNSENT = 64 * 1024;
+
+using Clock = chrono::steady_clock;
+
+static uint32_t usSince(Clock::time_point t0, Clock::time_point t1){
+    return (uint32_t)chrono::duration_cast<chrono::microseconds>(t1 - t0).count();
+}
+
+IpcServer::IpcServer(int workers) : workerCount(max(1, workers)) {}
+
+IpcServer::~IpcServer(){
+    stopWorkers();
+    for(auto& c : clients) close(c.fd);
+    if(wakeFd >= 0) close(wakeFd);
+    if(listenFd >= 0){
+        close(listenFd);
+        unlink(path.c_str());
+    }
+}
+
+bool IpcServer::listen(const string& socketPath){
+    sockaddr_un addr = {};
+    addr.sun_family = AF_UNIX;
+    if(socketPath.empty() || socketPath.size() >= sizeof(addr.sun_path)){
+        cerr << "IPC: socket path too long: " << socketPath << "\n";
+        return false;
+    }
+    memcpy(addr.sun_path, socketPath.c_str(), socketPath.size() + 1);
+
+    int fd = socket(AF_UNIX, SOCK_STREAM | SOCK_NONBLOCK | SOCK_CLOEXEC, 0);
+    if(fd < 0) return false;
+
+    // A socket file left by a crashed server refuses connections; one
+    // that accepts belongs to a running server we must not steal from
+    struct stat st;
+    if(lstat(socketPath.c_str(), &st) == 0 && S_ISSOCK(st.st_mode)){
+        int probe = socket(AF_UNIX, SOCK_STREAM | SOCK_CLOEXEC, 0);
+        bool alive = probe >= 0 && connect(probe, (sockaddr*)&addr, sizeof(addr)) == 0;
+        if(probe >= 0) close(probe);
+        if(alive){
+            cerr << "IPC: " << socketPath << " is already served\n";
+            close(fd);
+            return false;
+        }
+        unlink(socketPath.c_str());
+    }
+
+    if(bind(fd, (sockaddr*)&addr, sizeof(addr)) != 0 || ::listen(fd, 16) != 0){
+        cerr << "IPC: cannot listen on " << socketPath << ": " << strerror(errno) << "\n";
+        close(fd);
+        return false;
+    }
+    chmod(socketPath.c_str(), 0660);
+    listenFd = fd;
+    path     = socketPath;
+    return true;
+}
+
+void IpcServer::accept(){
+    while(true){
+        int fd = accept4(listenFd, nullptr, nullptr, SOCK_NONBLOCK | SOCK_CLOEXEC);
+        if(fd < 0) return;
+        if(clients.size() >= MAX_CLIENTS){
+            close(fd);
+            continue;
+        }
+        Client c;
+        c.id = nextId++;
+        c.fd = fd;
+        clients.push_back(move(c));
+    }
+}
+
+// Reads what is available and queues complete frames, up to MAX_PENDING
+void IpcServer::readFrom(Client& c){
+    char buf[16384];
+    Clock::time_point now = Clock::now();
+    while(c.pending.size() < MAX_PENDING && !c.dead){
+        ssize_t n = read(c.fd, buf, sizeof(buf));
+        if(n < 0 && errno == EINTR) continue;
+        if(n == 0){
+            // EOF after the last query (shutdown(SHUT_WR)) still gets answers
+            c.eof = true;
+            break;
+        }
+        if(n < 0){
+            c.dead = errno != EAGAIN && errno != EWOULDBLOCK;
+            break;
+        }
+        c.in.append(buf, n);
+
+        size_t pos = 0, used = 0;
+        IpcMessage m;
+        int rc;
+        while((rc = ipcDecode(c.in.data() + pos, c.in.size() - pos, m, used)) == 1){
+            c.pending.push_back({ move(m), now });
+            pos += used;
+        }
+        c.in.erase(0, pos);
+        if(rc < 0) c.dead = true;
+    }
+}
+
+void IpcServer::flush(Client& c){
+    while(!c.out.empty()){
+        // MSG_NOSIGNAL: a client gone mid-reply must not SIGPIPE the server
+        ssize_t n = send(c.fd, c.out.data(), c.out.size(), MSG_NOSIGNAL);
+        if(n < 0){
+            if(errno == EINTR) continue;
+            if(errno != EAGAIN && errno != EWOULDBLOCK) c.dead = true;
+            return;
+        }
+        c.out.erase(0, n);
+    }
+}
+
+// Hands the client's next query to the pool unless one is in flight
+// or its replies are piling up unread
+void IpcServer::dispatch(Client& c){
+    if(c.busy || c.dead || c.pending.empty() || c.out.size() >= MAX_UNSENT) return;
+    c.busy = true;
+    {
+        lock_guard<mutex> g(lock);
+        jobs.push_back({ c.id, move(c.pending.front()) });
+    }
+    c.pending.pop_front();
+    jobReady.notify_one();
+}
+
+// Moves finished replies to their clients' output buffers
+void IpcServer::collect(){
+    uint64_t count;
+    while(read(wakeFd, &count, sizeof(count)) > 0) {}
+
+    deque<Done> finished;
+    {
+        lock_guard<mutex> g(lock);
+        finished.swap(done);
+    }
+    for(auto& d : finished){
+        for(auto& c : clients){
+            if(c.id != d.client) continue;
+            c.busy = false;
+            c.out += d.frame;
+            break;
+        }
+    }
+}
+
+void IpcServer::work(const Handler& handler){
+    traceNameThread("worker");
+    while(true){
+        Job job;
+        {
+            unique_lock<mutex> g(lock);
+            jobReady.wait(g, [&]{ return quitting || !jobs.empty(); });
+            if(quitting) return;
+            job = move(jobs.front());
+            jobs.pop_front();
+        }
+
+        IpcMessage& q = job.p.query;
+        Clock::time_point start = Clock::now();
+        IpcMessage reply;
+        if(q.type == IPC_QUERY){
+            reply = handler(q, job.client);
+            reply.type = IPC_REPLY;
+        } else {
+            reply.type = IPC_ERROR;
+            reply.text = "unknown message type";
+        }
+        Clock::time_point end = Clock::now();
+        if(traceEnabled()){
+            traceRecord(TRACE_QUEUE,  traceNs(job.p.received), traceNs(start));
+            traceRecord(TRACE_HANDLE, traceNs(start), traceNs(end));
+        }
+        reply.id        = q.id;
+        reply.session   = q.session;
+        reply.queueUs   = usSince(job.p.received, start);
+        reply.computeUs = usSince(start, end);
+        reply.totalUs   = usSince(job.p.received, end);
+
+        Done d{ job.client, {} };
+        ipcEncode(reply, d.frame);
+        {
+            lock_guard<mutex> g(lock);
+            done.push_back(move(d));
+        }
+        uint64_t one = 1;
+        if(write(wakeFd, &one, sizeof(one)) < 0) {}
+    }
+}
+
+void IpcServer::stopWorkers(){
+    {
+        lock_guard<mutex> g(lock);
+        quitting = true;
+        jobs.clear();
+    }
+    jobReady.notify_all();
+    for(auto& t : workers) t.join();
+    workers.clear();
+}
+
+void IpcServer::run(const Handler& handler, volatile sig_atomic_t* stop){
+    if(listenFd < 0) return;
+    wakeFd = eventfd(0, EFD_NONBLOCK | EFD_CLOEXEC);
+    if(wakeFd < 0) return;
+
+    quitting = false;
+    for(int i = 0; i < workerCount; i++)
+        workers.emplace_back([this, &handler]{ work(handler); });
+
+    vector<pollfd> fds;
+    while(!*stop){
+        fds.clear();
+        fds.push_back({ listenFd, POLLIN, 0 });
+        fds.push_back({ wakeFd,   POLLIN, 0 });
+        for(auto& c : clients){
+            bool full = c.pending.size() >= MAX_PENDING;
+            short ev = (c.eof || c.dead || full) ? 0 : POLLIN;
+            if(!c.out.empty()) ev |= POLLOUT;
+            // Negative fds are skipped, so a dead client awaiting its worker,
+            // or a full one that hung up, doesn't wake us with POLLHUP over
+            // and over
+            fds.push_back({ (c.dead || (full && ev == 0)) ? -1 : c.fd, ev, 0 });
+        }
+
+        // A signal interrupts poll (no SA_RESTART), so *stop is seen promptly
+        if(poll(fds.data(), fds.size(), -1) < 0){
+            if(errno == EINTR) continue;
+            cerr << "IPC: poll: " << strerror(errno) << "\n";
+            break;
+        }
+
+        // Indices in fds match clients as they were before accept()
+        size_t polled = clients.size();
+        for(size_t i = 0; i < polled; i++){
+            Client& c = clients[i];
+            short ev = fds[i + 2].revents;
+            if(c.eof && (ev & (POLLHUP | POLLERR))) c.dead = true;   // fully closed
+            else if(ev & (POLLIN | POLLHUP | POLLERR)) readFrom(c);
+            if((ev & POLLOUT) && !c.dead) flush(c);
+        }
+        if(fds[1].revents & POLLIN) collect();
+        if(fds[0].revents & POLLIN) accept();
+
+        for(size_t i = clients.size(); i-- > 0; ){
+            Client& c = clients[i];
+            if(!c.dead) flush(c);
+            dispatch(c);
+
+            // Gone clients leave once their worker is done with them
+            bool finished = c.eof && c.pending.empty() && c.out.empty();
+            if(c.busy || !(c.dead || finished)) continue;
+            close(c.fd);
+            if(disconnected) disconnected(c.id);
+            clients.erase(clients.begin() + i);
+        }
+    }
+    stopWorkers();
+}
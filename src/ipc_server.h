@@ -0,0 +1,95 @@
+#pragma once
+#include <string>
+#include <vector>
+#include <deque>
+#include <functional>
+#include <thread>
+#include <mutex>
+#include <condition_variable>
+#include <chrono>
+#include <csignal>
+#include <cstdint>
+
+#include "ipc.h"
+
+/*
+ * Unix domain socket server for framed IpcMessages.
+ *
+ * One poll() thread does all socket I/O; a pool of worker threads
+ * runs the handler. Each client has at most one query in flight, so
+ * its replies come back in order and per-client state needs no
+ * locking, while different clients are answered in parallel.
+ * A client that pipelines faster than it reads is held back: past a
+ * few queued queries or 64 KiB of unread replies the server stops
+ * reading from it until it catches up.
+ * queueUs in a reply is the time its frame waited for a worker.
+ */
+
+class IpcServer {
+public:
+    // client identifies the connection; stable until onDisconnect
+    using Handler = std::function<IpcMessage(const IpcMessage& query, uint64_t client)>;
+
+    explicit IpcServer(int workers = 1);
+    ~IpcServer();
+
+    // Replaces a stale socket file; false if the path is in use or bad
+    bool listen(const std::string& path);
+
+    // Called on the poll thread once a client is gone and idle
+    void onDisconnect(std::function<void(uint64_t client)> cb) { disconnected = std::move(cb); }
+
+    // Serves until *stop becomes non-zero (set it from a signal handler)
+    void run(const Handler& handler, volatile std::sig_atomic_t* stop);
+
+private:
+    using Clock = std::chrono::steady_clock;
+
+    struct Pending {
+        IpcMessage        query;
+        Clock::time_point received;
+    };
+
+    struct Client {
+        uint64_t            id   = 0;
+        int                 fd   = -1;
+        bool                busy = false;   // a worker has its query
+        bool                eof  = false;   // peer stopped sending
+        bool                dead = false;   // I/O or framing error
+        std::string         in, out;
+        std::deque<Pending> pending;
+    };
+
+    struct Job {
+        uint64_t client;
+        Pending  p;
+    };
+
+    struct Done {
+        uint64_t    client;
+        std::string frame;
+    };
+
+    std::string         path;
+    int                 listenFd = -1;
+    int                 wakeFd   = -1;      // eventfd: a worker finished
+    uint64_t            nextId   = 1;
+    std::vector<Client> clients;
+    std::function<void(uint64_t)> disconnected;
+
+    int                      workerCount;
+    std::vector<std::thread> workers;
+    std::mutex               lock;
+    std::condition_variable  jobReady;
+    std::deque<Job>          jobs;
+    std::deque<Done>         done;
+    bool                     quitting = false;
+
+    void accept();
+    void readFrom(Client& c);
+    void flush(Client& c);
+    void dispatch(Client& c);
+    void collect();
+    void work(const Handler& handler);
+    void stopWorkers();
+};
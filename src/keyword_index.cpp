@@ -0,0 +1,332 @@
+/*
+ * ============================================================
+ *  PRIMUS AI - Keyword Index
+ *  Token → posting list, built once at startup or mapped
+ * ============================================================
+ */
+
+#include "keyword_index.h"
+
+#include <algorithm>
+#include <unordered_map>
+#include <climits>
+#include <cmath>
+
+using namespace std;
+
+// BM25 term-frequency saturation and length normalization
+static const double K1 = 1.2;
+static const double B  = 0.75;
+
+// Same separators as operator>> on a stringstream
+static bool isSpace(char c){
+    return c == ' ' || c == '\t' || c == '\n' || c == '\v' || c == '\f' || c == '\r';
+}
+
+/* ================================================================
+   BUILD — one pass over the knowledge table
+================================================================ */
+
+bool KeywordIndex::build(sqlite3* db, const Normalizer& normalize){
+    sqlite3_stmt* stmt;
+    if(sqlite3_prepare_v2(db, "SELECT id, question, category FROM knowledge ORDER BY id;",
+                          -1, &stmt, nullptr) != SQLITE_OK)
+        return false;
+    bool ok = build(stmt, normalize);
+    sqlite3_finalize(stmt);
+    return ok;
+}
+
+bool KeywordIndex::build(sqlite3_stmt* stmt, const Normalizer& normalize){
+    clear();
+    if(!stmt) return false;
+
+    unordered_map<string_view, uint32_t> wordIds;    // views into pool
+    vector<IndexString>                  wordText;
+    vector<vector<IndexPosting>>         wordRows;
+    unordered_map<string, uint32_t>      categoryIds;
+    vector<string>                       categoryNames;
+
+    // Questions go into the pool first and words are cut from them
+    // afterwards, so the views in wordIds never see it reallocate
+    int rc;
+    while((rc = sqlite3_step(stmt)) == SQLITE_ROW){
+        const char* q = (const char*)sqlite3_column_text(stmt, 1);
+        const char* c = (const char*)sqlite3_column_text(stmt, 2);
+        string question(q ? q : "", q ? sqlite3_column_bytes(stmt, 1) : 0);
+        if(normalize) question = normalize(question);
+        else for(char& ch : question)
+            if(ch >= 'A' && ch <= 'Z') ch += 'a' - 'A';
+        if(pool.size() + question.size() > UINT32_MAX) break;
+
+        IndexRow r = {};
+        r.id       = sqlite3_column_int64(stmt, 0);
+        r.question = { (uint32_t)pool.size(), (uint32_t)question.size() };
+        pool += question;
+
+        string cat = c ? c : "";
+        auto it = categoryIds.find(cat);
+        if(it == categoryIds.end()){
+            it = categoryIds.emplace(cat, categoryNames.size()).first;
+            categoryNames.push_back(cat);
+        }
+        r.category = it->second;
+        rows.push_back(r);
+    }
+    if(rc != SQLITE_DONE){
+        clear();
+        return false;
+    }
+
+    uint64_t totalTokens = 0;
+    for(uint32_t row = 0; row < rows.size(); row++){
+        IndexRow& r = rows[row];
+        string_view q(pool.data() + r.question.offset, r.question.length);
+        size_t i = 0;
+        while(i < q.size()){
+            while(i < q.size() && isSpace(q[i])) i++;
+            size_t start = i;
+            while(i < q.size() && !isSpace(q[i])) i++;
+            if(i == start) break;
+
+            r.tokens++;
+            string_view word = q.substr(start, i - start);
+            auto it = wordIds.find(word);
+            if(it == wordIds.end()){
+                it = wordIds.emplace(word, wordText.size()).first;
+                wordText.push_back({ (uint32_t)(r.question.offset + start), (uint32_t)word.size() });
+                wordRows.emplace_back();
+            }
+            auto& list = wordRows[it->second];
+            if(!list.empty() && list.back().row == row) list.back().count++;
+            else                                        list.push_back({ row, 1 });
+        }
+        totalTokens += r.tokens;
+    }
+    stats.avgTokens = rows.empty() ? 0 : (double)totalTokens / rows.size();
+
+    // Words sorted bytewise, postings laid out in that order
+    vector<uint32_t> order(wordText.size());
+    for(uint32_t w = 0; w < order.size(); w++) order[w] = w;
+    sort(order.begin(), order.end(), [&](uint32_t a, uint32_t b){
+        return text(wordText[a]) < text(wordText[b]);
+    });
+    double n = rows.size();
+    for(uint32_t w : order){
+        double df = wordRows[w].size();
+        wordTable.push_back({ wordText[w], (uint32_t)postings.size(), (uint32_t)df,
+                              (float)log(1 + (n - df + 0.5) / (df + 0.5)) });
+        postings.insert(postings.end(), wordRows[w].begin(), wordRows[w].end());
+    }
+
+    // Category names sorted too, rows renumbered to match
+    vector<uint32_t> catOrder(categoryNames.size()), catRank(categoryNames.size());
+    for(uint32_t c = 0; c < catOrder.size(); c++) catOrder[c] = c;
+    sort(catOrder.begin(), catOrder.end(),
+         [&](uint32_t a, uint32_t b){ return categoryNames[a] < categoryNames[b]; });
+    for(uint32_t c : catOrder){
+        catRank[c] = categories.size();
+        categories.push_back({ (uint32_t)pool.size(), (uint32_t)categoryNames[c].size() });
+        pool += categoryNames[c];
+    }
+    for(auto& r : rows) r.category = catRank[r.category];
+    if(pool.size() > UINT32_MAX){
+        clear();
+        return false;
+    }
+
+    t.pool       = pool.data();       t.poolBytes     = pool.size();
+    t.rows       = rows.data();       t.rowCount      = rows.size();
+    t.words      = wordTable.data();  t.wordCount     = wordTable.size();
+    t.postings   = postings.data();   t.postingCount  = postings.size();
+    t.categories = categories.data(); t.categoryCount = categories.size();
+    t.stats      = &stats;            t.statsCount    = 1;
+    return true;
+}
+
+void KeywordIndex::clear(){
+    t = KeywordTables();
+    pool.clear();
+    rows.clear();
+    wordTable.clear();
+    postings.clear();
+    categories.clear();
+    stats = {};
+    keep.reset();
+}
+
+void KeywordIndex::attach(const KeywordTables& tables, shared_ptr<const void> owner){
+    clear();
+    t    = tables;
+    keep = move(owner);
+}
+
+vector<string> KeywordIndex::words() const {
+    vector<string> out;
+    out.reserve(t.wordCount);
+    for(size_t w = 0; w < t.wordCount; w++)
+        out.emplace_back(text(t.words[w].text));
+    return out;
+}
+
+/* ================================================================
+   LOOKUP HELPERS — mapped tables are range-checked on use
+================================================================ */
+
+// During build() the pool is still growing, so go through it directly
+string_view KeywordIndex::text(const IndexString& s) const {
+    const char* base = t.pool ? t.pool : pool.data();
+    size_t      size = t.pool ? t.poolBytes : pool.size();
+    if(s.offset > size || s.length > size - s.offset) return {};
+    return string_view(base + s.offset, s.length);
+}
+
+const IndexWord* KeywordIndex::findWord(const string& word) const {
+    const IndexWord* end = t.words + t.wordCount;
+    const IndexWord* w = lower_bound(t.words, end, word,
+                                     [this](const IndexWord& x, const string& v){
+                                         return text(x.text) < v;
+                                     });
+    if(w == end || text(w->text) != word) return nullptr;
+    if(w->postings > t.postingCount || w->rows > t.postingCount - w->postings) return nullptr;
+    return w;
+}
+
+/* ================================================================
+   SCORE — BM25 over the posting lists of the query's words
+   Only rows sharing a word with the query are ever visited.
+================================================================ */
+
+KeywordHit KeywordIndex::score(const vector<string>& tokens, long long category) const {
+    KeywordHit hit;
+    if(empty() || tokens.empty()) return hit;
+
+    // Query words no question contains weigh as much as the rarest word
+    double n          = t.rowCount;
+    double unknownIdf = log(1 + (n + 0.5) / 0.5);
+    double avgTokens  = (t.stats && t.statsCount && t.stats->avgTokens > 0)
+                        ? t.stats->avgTokens : 1;
+
+    // Row → (BM25, matched IDF), dense and reused per thread
+    struct Acc { double score, idf; };
+    thread_local vector<Acc>      acc;
+    thread_local vector<uint32_t> touched;
+    if(acc.size() < t.rowCount) acc.assign(t.rowCount, Acc{ 0, 0 });
+    touched.clear();
+
+    double queryIdf = 0;
+    for(size_t i = 0; i < tokens.size(); i++){
+        if(find(tokens.begin(), tokens.begin() + i, tokens[i]) != tokens.begin() + i)
+            continue;
+        const IndexWord* w = findWord(tokens[i]);
+        if(!w){
+            queryIdf += unknownIdf;
+            continue;
+        }
+        queryIdf += w->idf;
+        for(uint32_t p = 0; p < w->rows; p++){
+            const IndexPosting& post = t.postings[w->postings + p];
+            if(post.row >= t.rowCount) continue;
+            const IndexRow& row = t.rows[post.row];
+            if(category >= 0 && row.category != category) continue;
+
+            double tf   = post.count;
+            double norm = K1 * (1 - B + B * row.tokens / avgTokens);
+            Acc& a = acc[post.row];
+            if(a.idf == 0) touched.push_back(post.row);
+            a.score += w->idf * tf * (K1 + 1) / (tf + norm);
+            a.idf   += w->idf;
+        }
+    }
+
+    // Highest score wins; ties go to the lowest row, i.e. the lowest id
+    uint32_t best = UINT32_MAX;
+    for(uint32_t r : touched){
+        Acc& a = acc[r];
+        if(a.score > hit.score || (a.score == hit.score && r < best)){
+            hit.score      = a.score;
+            hit.confidence = queryIdf > 0 ? a.idf / queryIdf : 0;
+            best           = r;
+        }
+        a = Acc{ 0, 0 };
+    }
+    if(best != UINT32_MAX) hit.id = t.rows[best].id;
+    return hit;
+}
+
+/* ================================================================
+   SCORE ROW — one known row against the query
+   A number or rare word is what the question is about: "अनुच्छेद 1"
+   answered by the row on अनुच्छेद 74 is wrong however much else fits.
+================================================================ */
+
+static bool isNumber(const string& token){
+    for(size_t i = 0; i < token.size(); i++){
+        unsigned char c = token[i];
+        if(c >= '0' && c <= '9') return true;
+        // Devanagari digits U+0966-096F: E0 A5 A6-AF
+        if(c == 0xE0 && i + 2 < token.size() && (unsigned char)token[i + 1] == 0xA5 &&
+           (unsigned char)token[i + 2] >= 0xA6 && (unsigned char)token[i + 2] <= 0xAF)
+            return true;
+    }
+    return false;
+}
+
+KeywordHit KeywordIndex::scoreRow(long long id, const vector<string>& tokens) const {
+    KeywordHit hit;
+    const IndexRow* end = t.rows + t.rowCount;
+    const IndexRow* row = lower_bound(t.rows, end, id,
+                                      [](const IndexRow& r, long long v){ return r.id < v; });
+    if(row == end || row->id != id) return hit;
+    hit.id = id;
+
+    double n          = t.rowCount;
+    double unknownIdf = log(1 + (n + 0.5) / 0.5);
+    double avgTokens  = (t.stats && t.statsCount && t.stats->avgTokens > 0)
+                        ? t.stats->avgTokens : 1;
+    double norm       = K1 * (1 - B + B * row->tokens / avgTokens);
+    string_view q     = text(row->question);
+
+    double queryIdf = 0, matchedIdf = 0;
+    for(size_t i = 0; i < tokens.size(); i++){
+        if(find(tokens.begin(), tokens.begin() + i, tokens[i]) != tokens.begin() + i)
+            continue;
+        const IndexWord* w = findWord(tokens[i]);
+        double idf = w ? w->idf : unknownIdf;
+        queryIdf += idf;
+
+        double tf = 0;
+        size_t p  = 0;
+        while(w && p < q.size()){
+            while(p < q.size() && isSpace(q[p])) p++;
+            size_t start = p;
+            while(p < q.size() && !isSpace(q[p])) p++;
+            if(p > start && q.substr(start, p - start) == tokens[i]) tf++;
+        }
+        if(tf > 0){
+            hit.score  += idf * tf * (K1 + 1) / (tf + norm);
+            matchedIdf += idf;
+        } else if(isNumber(tokens[i])){
+            hit.missedNumbers++;
+        } else if(!w || (double)w->rows * 100 <= n){
+            hit.missedRare++;
+        }
+    }
+    hit.confidence = queryIdf > 0 ? matchedIdf / queryIdf : 0;
+    return hit;
+}
+
+KeywordHit KeywordIndex::bestMatch(const vector<string>& tokens) const {
+    return score(tokens, -1);
+}
+
+KeywordHit KeywordIndex::bestInCategory(const string& category,
+                                        const vector<string>& tokens) const {
+    const IndexString* end = t.categories + t.categoryCount;
+    const IndexString* c = lower_bound(t.categories, end, category,
+                                       [this](const IndexString& s, const string& v){
+                                           return text(s) < v;
+                                       });
+    if(c == end || text(*c) != category) return KeywordHit();
+    return score(tokens, c - t.categories);
+}
@@ -0,0 +1,136 @@
+#pragma once
+#include <string>
+#include <string_view>
+#include <vector>
+#include <memory>
+#include <functional>
+#include <cstdint>
+#include <cstddef>
+#include <sqlite3.h>
+
+/*
+ * In-memory inverted index over knowledge.question, scored with
+ * BM25 (k1 = 1.2, b = 0.75) over whole tokens.
+ *
+ * Questions pass through the same normalizer as queries (HindiAI
+ * uses Enhancer::preprocess), so "IPC 144" in a question and "ipc
+ * 144" → "भारतीय दंड संहिता 144" in a query meet as the same tokens.
+ *
+ * Each word's IDF is computed once at build time from the number of
+ * questions containing it, so "भारत" (in hundreds of questions) weighs
+ * far less than a rare name, and "राम" no longer matches inside
+ * "रामायण". Alongside the score, each hit gets a confidence: the share
+ * of the query's total IDF that the row matched. Words that are in no
+ * question count at the highest IDF, so a query the corpus cannot
+ * explain gets a low confidence and the caller can say "not found"
+ * rather than return a weak hit.
+ *
+ * The tables are flat arrays of offsets into one string pool, so
+ * the same layout can be built from SQLite at startup or mapped
+ * straight from a knowledge snapshot (see knowledge_snapshot.h).
+ */
+
+// Bump when tokenization or table layout changes; snapshots built
+// by another version are ignored
+static const uint32_t KEYWORD_INDEX_VERSION = 2;
+
+struct KeywordHit {
+    long long id         = -1;  // knowledge.id, -1 when nothing matched
+    double    score      = 0;   // BM25
+    double    confidence = 0;   // matched share of the query's IDF, 0-1
+    // scoreRow() only: query words the row's question lacks
+    int       missedNumbers = 0;
+    int       missedRare    = 0;    // in at most 1% of questions, or none
+};
+
+/* ===== FLAT TABLES (also the snapshot's on-disk layout) ===== */
+
+struct IndexString {
+    uint32_t offset;        // into the pool
+    uint32_t length;        // bytes
+};
+
+struct IndexRow {
+    int64_t     id;         // knowledge.id, ascending
+    IndexString question;   // normalized, as queries are
+    uint32_t    category;   // into categories
+    uint32_t    tokens;     // words in the question (BM25 length)
+};
+
+struct IndexWord {
+    IndexString text;       // words are sorted bytewise
+    uint32_t    postings;   // first entry in postings
+    uint32_t    rows;       // rows containing the word (document frequency)
+    float       idf;        // ln(1 + (N - rows + 0.5) / (rows + 0.5))
+};
+
+struct IndexPosting {
+    uint32_t row;
+    uint32_t count;         // occurrences in that row's question
+};
+
+struct IndexStats {
+    double avgTokens;       // mean IndexRow::tokens
+};
+
+struct KeywordTables {
+    const char*         pool       = nullptr;  size_t poolBytes     = 0;
+    const IndexRow*     rows       = nullptr;  size_t rowCount      = 0;
+    const IndexWord*    words      = nullptr;  size_t wordCount     = 0;
+    const IndexPosting* postings   = nullptr;  size_t postingCount  = 0;   // by row, per word
+    const IndexString*  categories = nullptr;  size_t categoryCount = 0;   // sorted
+    const IndexStats*   stats      = nullptr;  size_t statsCount    = 0;   // one entry
+};
+
+class KeywordIndex {
+public:
+    // Question text → the form queries are searched in; without one,
+    // questions are only ASCII-lowercased
+    using Normalizer = std::function<std::string(const std::string&)>;
+
+    // "SELECT id, question, category FROM knowledge ORDER BY id"
+    bool   build(sqlite3* db, const Normalizer& normalize = nullptr);
+    bool   build(sqlite3_stmt* rows,                 // caller-prepared, same columns
+                 const Normalizer& normalize = nullptr);
+    void   clear();
+    bool   empty()    const { return t.rowCount == 0; }
+    size_t rowCount() const { return t.rowCount; }
+
+    // Serve from tables that live elsewhere (a mapped snapshot);
+    // keep holds them alive for as long as the index uses them
+    void attach(const KeywordTables& tables, std::shared_ptr<const void> keep);
+    const KeywordTables& tables() const { return t; }
+
+    // Distinct question words, sorted
+    std::vector<std::string> words() const;
+
+    // tokens = scoring tokens of the lowercased query (stop words
+    // removed, single digits and letters kept); repeats count once.
+    // Ties go to the lowest id.
+    KeywordHit bestMatch(const std::vector<std::string>& tokens) const;
+
+    // Same scoring, restricted to one category
+    KeywordHit bestInCategory(const std::string& category,
+                              const std::vector<std::string>& tokens) const;
+
+    // The same measures for one row found by other means (FTS), plus
+    // which of the query's telling words its question lacks. id -1
+    // when the row is not indexed.
+    KeywordHit scoreRow(long long id, const std::vector<std::string>& tokens) const;
+
+private:
+    KeywordTables t;
+
+    // Backing store when built here; empty when attached
+    std::string               pool;
+    std::vector<IndexRow>     rows;
+    std::vector<IndexWord>    wordTable;
+    std::vector<IndexPosting> postings;
+    std::vector<IndexString>  categories;
+    IndexStats                stats = {};
+    std::shared_ptr<const void> keep;
+
+    std::string_view text(const IndexString& s) const;
+    const IndexWord* findWord(const std::string& word) const;
+    KeywordHit       score(const std::vector<std::string>& tokens, long long category) const;
+};
@@ -0,0 +1,303 @@
+/*
+ * ============================================================
+ *  PRIMUS AI - Knowledge Generator
+ *  Template rows at scale, named from the seed vocabulary
+ * ============================================================
+ */
+
+#include "knowledge_generator.h"
+
+#include <iostream>
+#include <unordered_map>
+#include <algorithm>
+#include <cstdio>
+#include <unistd.h>
+
+using namespace std;
+
+/* ===== TEMPLATES =====
+   {p} place     {t} film title   {q} another place   {s} state
+   {r} river     {a} person       {y} year
+   {n} population   {m} area (km²)   {c} seats   {k} 2-15 */
+
+struct RowTemplate {
+    const char* category;
+    const char* question;
+    const char* answer;
+};
+
+static const RowTemplate TEMPLATES[] = {
+    { "भूगोल",   "{p} जिले का मुख्यालय कहाँ है",       "{p} जिले का मुख्यालय {q} में है।" },
+    { "भूगोल",   "{p} जिला किस राज्य में है",          "{p} जिला {s} राज्य में स्थित है।" },
+    { "भूगोल",   "{p} जिले की जनसंख्या कितनी है",      "{p} जिले की जनसंख्या लगभग {n} है।" },
+    { "भूगोल",   "{p} जिले से कौन सी नदी बहती है",     "{p} जिले से होकर {r} नदी बहती है।" },
+    { "भूगोल",   "{p} जिले का क्षेत्रफल कितना है",      "{p} जिले का क्षेत्रफल लगभग {m} वर्ग किलोमीटर है।" },
+    { "भूगोल",   "{p} जिले में कितनी तहसीलें हैं",      "{p} जिले में {k} तहसीलें हैं।" },
+    { "सिनेमा",  "{t} फिल्म कब रिलीज़ हुई",            "{t} फिल्म {y} में रिलीज़ हुई थी।" },
+    { "सिनेमा",  "{t} फिल्म का निर्देशक कौन है",        "{t} फिल्म का निर्देशन {a} ने किया था।" },
+    { "सिनेमा",  "{t} फिल्म में मुख्य अभिनेता कौन है",   "{t} फिल्म में मुख्य भूमिका {a} ने निभाई थी।" },
+    { "सिनेमा",  "{t} फिल्म का संगीत किसने दिया",       "{t} फिल्म का संगीत {a} ने दिया था।" },
+    { "सिनेमा",  "{t} फिल्म के गीत किसने लिखे",         "{t} फिल्म के गीत {a} ने लिखे थे।" },
+    { "इतिहास",  "{p} का किला किसने बनवाया",           "{p} का किला {a} ने {y} में बनवाया था।" },
+    { "राजनीति", "{p} विधानसभा सीट से विधायक कौन है",   "{p} विधानसभा सीट से {a} विधायक हैं।" },
+    { "खेल",     "{p} स्टेडियम में कितने दर्शक बैठ सकते हैं", "{p} स्टेडियम में लगभग {c} दर्शक बैठ सकते हैं।" },
+    { "कानून",   "{p} जिला न्यायालय कब बना",           "{p} जिला न्यायालय की स्थापना {y} में हुई थी।" },
+    { "तकनीक",   "{p} में ब्रॉडबैंड सेवा कब शुरू हुई",    "{p} में ब्रॉडबैंड सेवा {y} में शुरू हुई थी।" },
+};
+static const size_t TEMPLATE_COUNT = sizeof(TEMPLATES) / sizeof(TEMPLATES[0]);
+
+/* ===== NAME PARTS ===== */
+
+static const vector<string> SUFFIXES = {
+    "पुर", "नगर", "गढ़", "बाद", "गंज", "पुरा", "कोट", "खेड़ा", "गाँव", "पल्ली", "वाड़ा", "सर"
+};
+static const vector<string> QUALIFIERS = {
+    "खुर्द", "कलाँ", "नया", "पुराना", "उत्तर", "दक्षिण", "पूर्व", "पश्चिम"
+};
+static const vector<string> STATES = {
+    "उत्तर प्रदेश", "बिहार", "राजस्थान", "मध्य प्रदेश", "महाराष्ट्र", "गुजरात", "पंजाब",
+    "हरियाणा", "ओडिशा", "झारखंड", "छत्तीसगढ़", "कर्नाटक", "केरल", "तमिलनाडु",
+    "आंध्र प्रदेश", "तेलंगाना", "पश्चिम बंगाल", "असम", "उत्तराखंड", "हिमाचल प्रदेश"
+};
+static const vector<string> RIVERS = {
+    "गंगा", "यमुना", "गोदावरी", "कृष्णा", "कावेरी", "नर्मदा", "ताप्ती", "महानदी",
+    "सोन", "चंबल", "घाघरा", "गंडक", "कोसी", "बेतवा", "साबरमती", "तुंगभद्रा"
+};
+static const vector<string> FIRST_NAMES = {
+    "राम", "सुरेश", "अनिल", "विजय", "राजेश", "सुनील", "अमित", "प्रकाश", "मनोज", "संजय",
+    "सीता", "गीता", "सुनीता", "अनीता", "कविता", "पूजा", "रेखा", "नेहा", "प्रिया", "मीना"
+};
+static const vector<string> SURNAMES = {
+    "शर्मा", "वर्मा", "सिंह", "यादव", "गुप्ता", "पटेल", "मिश्रा", "जोशी", "चौहान",
+    "खान", "कुमार", "दास", "नायर", "रेड्डी", "बोस", "ठाकुर"
+};
+
+// Used when there is no seed database to take names from
+static const vector<string> BUILTIN_STEMS = {
+    "राम", "शिव", "कृष्ण", "सूर्य", "चंद्र", "गोविंद", "लक्ष्मी", "हरि", "देव", "विजय",
+    "अजमेर", "अलवर", "उदय", "कोटा", "सीता", "मोती", "हीरा", "सोना", "बसंत", "कमल",
+    "गोपाल", "मोहन", "श्याम", "धर्म", "मान", "शक्ति", "नंद", "भीम", "अर्जुन", "बलराम",
+    "रतन", "जय", "प्रताप", "माधव", "केशव", "नारायण", "भैरव", "दुर्गा", "काली", "गौरी"
+};
+
+/* ===== HELPERS ===== */
+
+// Same value everywhere for the same input (splitmix64)
+static uint64_t mix(uint64_t x){
+    x += 0x9e3779b97f4a7c15ULL;
+    x = (x ^ (x >> 30)) * 0xbf58476d1ce4e5b9ULL;
+    x = (x ^ (x >> 27)) * 0x94d049bb133111ebULL;
+    return x ^ (x >> 31);
+}
+
+static const string& pick(const vector<string>& v, uint64_t h){
+    return v[h % v.size()];
+}
+
+// U+0900-U+097F, letters and signs only (no digits, danda, virama last)
+static bool isNameWord(const string& w){
+    size_t points = 0;
+    for(size_t i = 0; i < w.size(); i += 3){
+        unsigned char a = w[i], b = i + 1 < w.size() ? w[i+1] : 0;
+        if(a != 0xE0 || (b != 0xA4 && b != 0xA5) || i + 2 >= w.size()) return false;
+        unsigned cp = 0x900 + ((b & 0x3) << 6) + (w[i+2] & 0x3F);
+        if(cp >= 0x964) return false;
+        points++;
+    }
+    return points >= 2 && points <= 6 && w.compare(w.size() - 3, 3, "्") != 0;
+}
+
+/* ================================================================
+   GENERATOR
+================================================================ */
+
+// Words seen in at most two questions are names far more often than
+// not ("अलवर", "गोधरा", "सलमान"); template words are in hundreds
+KnowledgeGenerator::KnowledgeGenerator(sqlite3* seed){
+    if(seed){
+        unordered_map<string, int> seen;
+        sqlite3_stmt* st = nullptr;
+        if(sqlite3_prepare_v2(seed, "SELECT question FROM knowledge ORDER BY id;",
+                              -1, &st, nullptr) == SQLITE_OK)
+        {
+            while(sqlite3_step(st) == SQLITE_ROW){
+                const char* q = (const char*)sqlite3_column_text(st, 0);
+                string word;
+                for(const char* c = q ? q : ""; ; c++){
+                    if(*c && *c != ' '){ word += *c; continue; }
+                    if(!word.empty()) seen[word]++;
+                    word.clear();
+                    if(!*c) break;
+                }
+            }
+        }
+        sqlite3_finalize(st);
+        // A stem that ends in a suffix or is a qualifier could spell
+        // another entity's name ("अलीगढ़" = "अली" + "गढ़")
+        auto ambiguous = [](const string& w){
+            for(auto& x : SUFFIXES)
+                if(w.size() >= x.size() && w.compare(w.size() - x.size(), x.size(), x) == 0)
+                    return true;
+            return find(QUALIFIERS.begin(), QUALIFIERS.end(), w) != QUALIFIERS.end();
+        };
+        for(auto& [w, n] : seen)
+            if(n <= 2 && isNameWord(w) && !ambiguous(w)) stems.push_back(w);
+        sort(stems.begin(), stems.end());     // map order is not stable
+    }
+    if(stems.size() < BUILTIN_STEMS.size()) stems = BUILTIN_STEMS;
+}
+
+// Digits (stem, suffix or none, qualifier or none, leading stem or
+// none), so names only repeat after stems² × 13 × 9 places
+string KnowledgeGenerator::place(uint64_t i) const {
+    uint64_t s = stems.size();
+    uint64_t a = i % s;                       i /= s;
+    uint64_t x = i % (SUFFIXES.size() + 1);   i /= SUFFIXES.size() + 1;
+    uint64_t q = i % (QUALIFIERS.size() + 1); i /= QUALIFIERS.size() + 1;
+    uint64_t b = i % (s + 1);
+
+    string name = b ? stems[b - 1] + " " : "";
+    name += stems[a];
+    if(x) name += SUFFIXES[x - 1];
+    if(q) name += " " + QUALIFIERS[q - 1];
+    return name;
+}
+
+// Two or three stems, "दंगल गुलाब", like short film titles
+string KnowledgeGenerator::title(uint64_t i) const {
+    uint64_t s = stems.size();
+    uint64_t a = i % s;  i /= s;
+    uint64_t b = i % s;  i /= s;
+    uint64_t c = i % (s + 1);
+    string name = stems[a] + " " + stems[b];
+    if(c) name += " " + stems[c - 1];
+    return name;
+}
+
+GeneratedRow KnowledgeGenerator::row(uint64_t n) const {
+    const RowTemplate& t = TEMPLATES[n % TEMPLATE_COUNT];
+    uint64_t entity = n / TEMPLATE_COUNT;
+
+    auto expand = [&](const char* text){
+        string out;
+        for(const char* c = text; *c; c++){
+            if(*c != '{' || !c[1] || c[2] != '}'){
+                out += *c;
+                continue;
+            }
+            char     slot = c[1];
+            uint64_t h    = mix(n * 64 + slot);
+            c += 2;
+            switch(slot){
+                case 'p': out += place(entity);                        break;
+                case 't': out += title(entity);                        break;
+                case 'q': out += place(h % (entity + 1000));           break;
+                case 's': out += pick(STATES, h);                      break;
+                case 'r': out += pick(RIVERS, h);                      break;
+                case 'a': out += pick(FIRST_NAMES, h) + " " + pick(SURNAMES, h >> 20); break;
+                case 'y': out += to_string(1900 + h % 125);            break;
+                case 'n': out += to_string(50000 + h % 4950000);       break;
+                case 'm': out += to_string(200 + h % 19800);           break;
+                case 'c': out += to_string(5000 + h % 95000);          break;
+                case 'k': out += to_string(2 + h % 14);                break;
+                default:  out.append(c - 2, 3);                        break;
+            }
+        }
+        return out;
+    };
+    return { expand(t.question), expand(t.answer), t.category };
+}
+
+/* ================================================================
+   DATABASE — seed rows copied, generated rows in one transaction
+================================================================ */
+
+static const char* SCHEMA =
+    "PRAGMA journal_mode = WAL;"
+    "CREATE TABLE knowledge ("
+    "    id       INTEGER PRIMARY KEY AUTOINCREMENT,"
+    "    question TEXT    NOT NULL,"
+    "    answer   TEXT    NOT NULL,"
+    "    category TEXT    NOT NULL DEFAULT 'सामान्य');";
+
+static const char* INDEXES =
+    "CREATE INDEX IF NOT EXISTS idx_category ON knowledge(category);"
+    "CREATE INDEX IF NOT EXISTS idx_question  ON knowledge(question);";
+
+static bool exec(sqlite3* db, const string& sql){
+    char* err = nullptr;
+    if(sqlite3_exec(db, sql.c_str(), 0,0, &err) == SQLITE_OK) return true;
+    cerr << "Generate: " << (err ? err : "?") << "\n";
+    sqlite3_free(err);
+    return false;
+}
+
+bool generateKnowledge(const string& seedPath, const string& outPath,
+                       size_t rows, size_t* generated)
+{
+    if(generated) *generated = 0;
+    for(const char* ext : { "", "-wal", "-shm" })
+        unlink((outPath + ext).c_str());
+
+    sqlite3* seed = nullptr;
+    if(sqlite3_open_v2(seedPath.c_str(), &seed, SQLITE_OPEN_READONLY, nullptr) != SQLITE_OK){
+        cerr << "Generate: cannot open " << seedPath << "\n";
+        sqlite3_close(seed);
+        return false;
+    }
+    KnowledgeGenerator gen(seed);
+    sqlite3_close(seed);
+
+    sqlite3* db = nullptr;
+    if(sqlite3_open(outPath.c_str(), &db) != SQLITE_OK){
+        cerr << "Generate: cannot create " << outPath << "\n";
+        sqlite3_close(db);
+        return false;
+    }
+
+    // Indexes after the load: one sort instead of a b-tree insert per row
+    char* quoted = sqlite3_mprintf("%Q", seedPath.c_str());
+    string attach = string("ATTACH DATABASE ") + quoted + " AS seed;";
+    sqlite3_free(quoted);
+    bool ok = exec(db, SCHEMA) && exec(db, "PRAGMA synchronous = OFF;") &&
+              exec(db, attach) &&
+              exec(db, "INSERT INTO knowledge(question, answer, category) "
+                       "SELECT question, answer, category FROM seed.knowledge ORDER BY id;") &&
+              exec(db, "DETACH DATABASE seed;");
+
+    sqlite3_int64 have = 0;
+    sqlite3_stmt* st = nullptr;
+    if(ok && sqlite3_prepare_v2(db, "SELECT COUNT(*) FROM knowledge;", -1, &st, nullptr) == SQLITE_OK &&
+       sqlite3_step(st) == SQLITE_ROW)
+        have = sqlite3_column_int64(st, 0);
+    sqlite3_finalize(st);
+    st = nullptr;
+
+    size_t added = 0;
+    if(ok && (size_t)have < rows){
+        ok = exec(db, "BEGIN;") &&
+             sqlite3_prepare_v2(db, "INSERT INTO knowledge(question, answer, category) "
+                                    "VALUES (?, ?, ?);", -1, &st, nullptr) == SQLITE_OK;
+        for(uint64_t n = 0; ok && (size_t)have + added < rows; n++){
+            GeneratedRow r = gen.row(n);
+            sqlite3_bind_text(st, 1, r.question.c_str(), r.question.size(), SQLITE_STATIC);
+            sqlite3_bind_text(st, 2, r.answer.c_str(),   r.answer.size(),   SQLITE_STATIC);
+            sqlite3_bind_text(st, 3, r.category.c_str(), r.category.size(), SQLITE_STATIC);
+            ok = sqlite3_step(st) == SQLITE_DONE;
+            sqlite3_reset(st);
+            added++;
+        }
+        sqlite3_finalize(st);
+        ok = ok && exec(db, "COMMIT;");
+    }
+    ok = ok && exec(db, INDEXES) && exec(db, "PRAGMA synchronous = NORMAL;");
+    sqlite3_close(db);
+
+    if(!ok){
+        for(const char* ext : { "", "-wal", "-shm" })
+            unlink((outPath + ext).c_str());
+        return false;
+    }
+    if(generated) *generated = added;
+    return true;
+}
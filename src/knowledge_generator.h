@@ -0,0 +1,48 @@
+#pragma once
+#include <string>
+#include <vector>
+#include <cstdint>
+#include <cstddef>
+#include <sqlite3.h>
+
+/*
+ * Synthetic knowledge rows for testing the search at 10k-1M entries:
+ * district-level geography, filmographies and the like, written the
+ * way the seed questions are ("X जिले का मुख्यालय कहाँ है").
+ *
+ * Row n picks template n % templates and entity n / templates, so
+ * every entity is asked about several ways, as real entries are.
+ * Entity names are built from the rarer words of the seed questions
+ * (mostly place and person names) plus Hindi place-name suffixes, in
+ * a mixed radix over those parts: no two entities share a name. Slot
+ * values (years, states, people) are hashed from n, so the same n
+ * gives the same row on every machine.
+ */
+
+struct GeneratedRow {
+    std::string question;
+    std::string answer;
+    std::string category;
+};
+
+class KnowledgeGenerator {
+public:
+    // seed = a knowledge database to take name stems from; with none
+    // (or too few names in it) a built-in list is used
+    explicit KnowledgeGenerator(sqlite3* seed = nullptr);
+
+    GeneratedRow row(uint64_t n) const;
+    size_t       stemCount() const { return stems.size(); }
+
+private:
+    std::vector<std::string> stems;
+
+    std::string place(uint64_t i) const;
+    std::string title(uint64_t i) const;
+};
+
+// Writes a new database at out: the seed's knowledge rows, then
+// generated ones until there are `rows` in all. Schema and indexes as
+// in seed_knowledge_v3.sql; FTS is left for HindiAI to build
+bool generateKnowledge(const std::string& seedPath, const std::string& outPath,
+                       size_t rows, size_t* generated = nullptr);
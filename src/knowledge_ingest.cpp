@@ -0,0 +1,642 @@
+/*
+ * ============================================================
+ *  PRIMUS AI - Knowledge Ingest
+ *  Streaming CSV/TSV/SQL readers, hashed upserts into knowledge
+ * ============================================================
+ */
+
+#include "knowledge_ingest.h"
+#include "knowledge_snapshot.h"
+#include "hindi_ai.h"
+
+#include <iostream>
+#include <cctype>
+#include <cerrno>
+#include <cstring>
+
+using namespace std;
+
+static const char* DEFAULT_CATEGORY = "सामान्य";
+
+/* ===== HELPERS ===== */
+
+static string trim(const string& s){
+    size_t a = s.find_first_not_of(" \t\r\n");
+    if(a == string::npos) return "";
+    size_t b = s.find_last_not_of(" \t\r\n");
+    return s.substr(a, b - a + 1);
+}
+
+static string lower(string s){
+    for(char& c : s) c = (char)tolower((unsigned char)c);
+    return s;
+}
+
+static bool endsWith(const string& s, const char* suffix){
+    size_t n = strlen(suffix);
+    return s.size() >= n && lower(s.substr(s.size() - n)) == suffix;
+}
+
+// question/answer/category → 0/1/2, anything else -1
+static int columnOf(const string& name){
+    string n = lower(trim(name));
+    if(n == "question") return 0;
+    if(n == "answer")   return 1;
+    if(n == "category") return 2;
+    return -1;
+}
+
+// FNV-1a 64, continued across fields with a separator between them
+static uint64_t fnv(uint64_t h, const string& s){
+    for(unsigned char c : s){
+        h ^= c;
+        h *= 1099511628211ULL;
+    }
+    h ^= 0x1f;
+    return h * 1099511628211ULL;
+}
+
+static const uint64_t FNV_SEED = 1469598103934665603ULL;
+
+static uint64_t contentHash(const string& answer, const string& category){
+    return fnv(fnv(FNV_SEED, answer), category);
+}
+
+static long long scalarInt(sqlite3* db, const char* sql){
+    sqlite3_stmt* stmt;
+    long long v = -1;
+    if(sqlite3_prepare_v2(db, sql, -1, &stmt, nullptr) == SQLITE_OK &&
+       sqlite3_step(stmt) == SQLITE_ROW)
+        v = sqlite3_column_int64(stmt, 0);
+    sqlite3_finalize(stmt);
+    return v;
+}
+
+/* ================================================================
+   READER — buffered bytes
+================================================================ */
+
+IngestReader::~IngestReader(){
+    if(in && in != stdin) fclose(in);
+}
+
+bool IngestReader::open(const string& path, IngestFormat format){
+    name = path;
+    fmt  = format;
+    if(fmt == IngestFormat::Auto){
+        if(endsWith(path, ".csv"))                                fmt = IngestFormat::Csv;
+        else if(endsWith(path, ".tsv") || endsWith(path, ".tab")) fmt = IngestFormat::Tsv;
+        else if(endsWith(path, ".sql"))                           fmt = IngestFormat::Sql;
+        else {
+            err = path + ": unknown format, give --format csv|tsv|sql";
+            return false;
+        }
+    }
+    in = path == "-" ? stdin : fopen(path.c_str(), "rb");
+    if(!in){
+        err = path + ": " + strerror(errno);
+        return false;
+    }
+    // UTF-8 byte order mark, as spreadsheet exports write one
+    if(refill(3) && memcmp(buf + pos, "\xEF\xBB\xBF", 3) == 0)
+        pos += 3;
+    return true;
+}
+
+// At least need unread bytes, unless the source ends first. The last
+// byte read moves to the front with the unread ones, so unget() still
+// has it after a refill
+bool IngestReader::refill(size_t need){
+    if(len - pos >= need) return true;
+    size_t from = pos > 0 ? pos - 1 : 0;
+    memmove(buf, buf + from, len - from);
+    len -= from;
+    pos -= from;
+    while(len - pos < need){
+        size_t n = in ? fread(buf + len, 1, sizeof(buf) - len, in) : 0;
+        if(n == 0) return false;
+        len += n;
+    }
+    return true;
+}
+
+int IngestReader::peek(){
+    if(!refill(1)) return EOF;
+    return (unsigned char)buf[pos];
+}
+
+// The byte after peek()'s, without reading either
+int IngestReader::peek2(){
+    if(!refill(2)) return EOF;
+    return (unsigned char)buf[pos + 1];
+}
+
+int IngestReader::get(){
+    int c = peek();
+    if(c == EOF) return EOF;
+    pos++;
+    if(c == '\n') line++;
+    return c;
+}
+
+// Only straight after get(): the byte is still in the buffer, even
+// when a peek() since has refilled it
+void IngestReader::unget(int c){
+    if(c == EOF) return;
+    pos--;
+    if(c == '\n') line--;
+}
+
+void IngestReader::malformed(const char* what){
+    // The first few are enough to find the problem
+    if(++bad <= 5) cerr << name << ":" << recordLine << ": " << what << ", skipped\n";
+}
+
+bool IngestReader::fill(IngestRecord& out, const vector<string>& fields, const int* cols){
+    auto field = [&](int i){ return i >= 0 && i < (int)fields.size() ? trim(fields[i]) : string(); };
+    out.question = field(cols[0]);
+    out.answer   = field(cols[1]);
+    out.category = field(cols[2]);
+    if(out.question.empty() || out.answer.empty()){
+        malformed("no question or answer");
+        return false;
+    }
+    if(out.category.empty()) out.category = DEFAULT_CATEGORY;
+    return true;
+}
+
+bool IngestReader::next(IngestRecord& out){
+    if(!in) return false;
+    return fmt == IngestFormat::Sql ? nextSql(out) : nextDelimited(out);
+}
+
+/* ================================================================
+   CSV / TSV
+================================================================ */
+
+// One row into fields; false at the end of the source
+bool IngestReader::readRow(vector<string>& fields){
+    fields.clear();
+    recordLine = line;
+    int c = get();
+    if(c == EOF) return false;
+
+    char   sep = fmt == IngestFormat::Tsv ? '\t' : ',';
+    string f;
+    for(;;){
+        if(c == '\r' && peek() == '\n') c = get();
+        if(c == EOF || c == '\n'){
+            fields.push_back(move(f));
+            return true;
+        }
+        if(c == sep){
+            fields.push_back(move(f));
+            f.clear();
+        } else if(fmt == IngestFormat::Csv && c == '"' && f.empty()){
+            // Quoted: "" is a quote, anything else (newlines too) literal
+            for(;;){
+                c = get();
+                if(c == EOF){
+                    err = name + ":" + to_string(recordLine) + ": unterminated quote";
+                    return false;
+                }
+                if(c == '"'){
+                    if(peek() != '"') break;
+                    get();
+                }
+                f += (char)c;
+            }
+        } else if(fmt == IngestFormat::Tsv && c == '\\' && peek() != EOF){
+            c = get();
+            f += c == 't' ? '\t' : c == 'n' ? '\n' : c == 'r' ? '\r' : (char)c;
+        } else {
+            f += (char)c;
+        }
+        c = get();
+    }
+}
+
+bool IngestReader::nextDelimited(IngestRecord& out){
+    vector<string> fields;
+    while(readRow(fields)){
+        if(fields.size() == 1 && trim(fields[0]).empty()) continue;   // blank line
+
+        // A header names the columns; without one they are in order
+        if(firstRow){
+            firstRow = false;
+            bool header = false;
+            for(auto& f : fields) header = header || columnOf(f) == 0;
+            if(header){
+                col[0] = col[1] = col[2] = -1;
+                for(size_t i = 0; i < fields.size(); i++){
+                    int c = columnOf(fields[i]);
+                    if(c >= 0 && col[c] < 0) col[c] = (int)i;
+                }
+                if(col[0] < 0 || col[1] < 0){
+                    err = name + ": header has no question or answer column";
+                    return false;
+                }
+                continue;
+            }
+        }
+        if(fill(out, fields, col)) return true;
+    }
+    return false;
+}
+
+/* ================================================================
+   SQL — INSERT INTO knowledge(...) VALUES (...), (...);
+   Everything else (PRAGMA, CREATE, BEGIN, other tables) is skipped.
+================================================================ */
+
+void IngestReader::skipSpace(){
+    for(;;){
+        int c = peek();
+        if(c == EOF) return;
+        if(isspace(c)){
+            get();
+            continue;
+        }
+        // Both bytes are looked at before either is taken: "-1" is a value
+        if(c == '-' && peek2() == '-'){
+            while(c != EOF && c != '\n') c = get();
+            continue;
+        }
+        if(c == '/' && peek2() == '*'){
+            get();
+            get();
+            int prev = 0;
+            while((c = get()) != EOF && !(prev == '*' && c == '/')) prev = c;
+            continue;
+        }
+        return;
+    }
+}
+
+// 'text' with '' for a quote (or "name" with "")
+bool IngestReader::readQuoted(int quote, string& out){
+    out.clear();
+    for(;;){
+        int c = get();
+        if(c == EOF){
+            err = name + ":" + to_string(recordLine) + ": unterminated string";
+            return false;
+        }
+        if(c == quote){
+            if(peek() != quote) return true;
+            get();
+        }
+        out += (char)c;
+    }
+}
+
+string IngestReader::readWord(){
+    string w;
+    int c;
+    while((c = peek()) != EOF && (isalnum(c) || c == '_' || c == '.' || c == '-' || c == '+' || c >= 0x80))
+        w += (char)get();
+    return w;
+}
+
+// A table or column name, bare or quoted, without its schema
+string IngestReader::readName(){
+    string n;
+    int c = peek();
+    if(c == '"' || c == '`'){
+        get();
+        if(!readQuoted(c, n)) return "";
+    } else if(c == '['){
+        get();
+        while((c = get()) != EOF && c != ']') n += (char)c;
+    } else {
+        n = readWord();
+    }
+    if(peek() == '.'){
+        get();
+        return readName();
+    }
+    size_t dot = n.rfind('.');
+    return dot == string::npos ? n : n.substr(dot + 1);
+}
+
+// To just past the next ';' outside strings
+void IngestReader::skipStatement(){
+    string ignored;
+    for(;;){
+        skipSpace();
+        int c = get();
+        if(c == EOF || c == ';') return;
+        if((c == '\'' || c == '"') && !readQuoted(c, ignored)) return;
+    }
+}
+
+// Reads statements until an INSERT into knowledge, stopping after its
+// VALUES keyword; false at the end of the source
+bool IngestReader::readStatementHead(){
+    for(;;){
+        skipSpace();
+        recordLine = line;
+        if(peek() == EOF) return false;
+
+        string w = lower(readWord());
+        if(w != "insert"){
+            skipStatement();
+            continue;
+        }
+        skipSpace();
+        w = lower(readWord());
+        if(w == "or"){                                 // OR REPLACE / IGNORE
+            skipSpace(); readWord();
+            skipSpace(); w = lower(readWord());
+        }
+        skipSpace();
+        if(w != "into" || lower(readName()) != "knowledge"){
+            skipStatement();
+            continue;
+        }
+
+        // Without a column list the values are in table order
+        int order[4] = { -1, 0, 1, 2 };                // id, question, answer, category
+        vector<int> cols(order, order + 4);
+        skipSpace();
+        if(peek() == '('){
+            get();
+            cols.clear();
+            int c;
+            do {
+                skipSpace();
+                cols.push_back(columnOf(readName()));
+                skipSpace();
+            } while((c = get()) == ',');
+            if(c != ')'){
+                malformed("bad column list");
+                skipStatement();
+                continue;
+            }
+        }
+        skipSpace();
+        if(lower(readWord()) != "values"){
+            malformed("INSERT without VALUES");
+            skipStatement();
+            continue;
+        }
+
+        // sqlCol[k] = position of question/answer/category in a tuple
+        sqlCol[0] = sqlCol[1] = sqlCol[2] = -1;
+        for(size_t i = 0; i < cols.size(); i++)
+            if(cols[i] >= 0) sqlCol[cols[i]] = (int)i;
+        inValues = true;
+        return true;
+    }
+}
+
+// (value, ...) with the '(' already read; NULL reads as empty
+bool IngestReader::readTuple(vector<string>& values){
+    values.clear();
+    for(;;){
+        skipSpace();
+        string v;
+        int c = peek();
+        if(c == '\'' || c == '"'){
+            get();
+            if(!readQuoted(c, v)) return false;
+        } else {
+            v = readWord();
+            if(lower(v) == "null") v.clear();
+        }
+        values.push_back(move(v));
+        skipSpace();
+        c = get();
+        if(c == ')') return true;
+        if(c != ',') return false;
+    }
+}
+
+bool IngestReader::nextSql(IngestRecord& out){
+    vector<string> values;
+    for(;;){
+        if(!inValues && !readStatementHead()) return false;
+
+        skipSpace();
+        recordLine = line;
+        bool ok = get() == '(' && readTuple(values);
+        if(!err.empty()) return false;
+        if(!ok){
+            malformed("bad VALUES tuple");
+            inValues = false;
+            skipStatement();
+            continue;
+        }
+        // More tuples after a ',', the statement ends at ';'
+        skipSpace();
+        int c = get();
+        if(c != ','){
+            inValues = false;
+            if(c != ';' && c != EOF) skipStatement();
+        }
+        if(fill(out, values, sqlCol)) return true;
+    }
+}
+
+/* ================================================================
+   INGEST
+================================================================ */
+
+// Set outside any transaction
+static const char* PRAGMAS =
+    "PRAGMA journal_mode=WAL;"
+    "PRAGMA synchronous=NORMAL;";
+
+static const char* SCHEMA =
+    "CREATE TABLE IF NOT EXISTS knowledge ("
+    "id       INTEGER PRIMARY KEY AUTOINCREMENT,"
+    "question TEXT    NOT NULL,"
+    "answer   TEXT    NOT NULL,"
+    "category TEXT    NOT NULL DEFAULT 'सामान्य');"
+    "CREATE INDEX IF NOT EXISTS idx_category ON knowledge(category);"
+    "CREATE INDEX IF NOT EXISTS idx_cat_q    ON knowledge(category, question);";
+
+KnowledgeIngest::KnowledgeIngest(sqlite3* database, const IngestOptions& options)
+    : db(database), opt(options) {}
+
+KnowledgeIngest::~KnowledgeIngest(){
+    // Batches already committed stay; the one open is dropped
+    if(inTxn) sqlite3_exec(db, "ROLLBACK;", 0,0,0);
+    sqlite3_finalize(stmtInsert);
+    sqlite3_finalize(stmtUpdate);
+    sqlite3_finalize(stmtDelete);
+}
+
+bool KnowledgeIngest::exec(const char* sql){
+    char* err = nullptr;
+    if(sqlite3_exec(db, sql, 0,0, &err) != SQLITE_OK){
+        cerr << "Ingest failed: " << (err ? err : "?") << "\n";
+        sqlite3_free(err);
+        return false;
+    }
+    return true;
+}
+
+bool KnowledgeIngest::step(sqlite3_stmt* stmt){
+    int rc = sqlite3_step(stmt);
+    sqlite3_reset(stmt);
+    if(rc != SQLITE_DONE){
+        cerr << "Ingest failed: " << sqlite3_errmsg(db) << "\n";
+        return false;
+    }
+    pending++;
+    return true;
+}
+
+bool KnowledgeIngest::commitBatch(){
+    pending = 0;
+    return exec("COMMIT; BEGIN IMMEDIATE;");
+}
+
+bool KnowledgeIngest::begin(){
+    started = chrono::steady_clock::now();
+    // Schema changes go in the first transaction, so a dry run leaves
+    // the database as it found it
+    if(!exec(PRAGMAS) || !exec("BEGIN IMMEDIATE;")) return false;
+    inTxn = true;
+    if(!exec(SCHEMA) || !installKnowledgeVersion(db)) return false;
+
+    // No usable FTS table: load without it (no per-row trigger work)
+    // and build it in one pass at the end. Triggers left over from a
+    // dropped table would fail every insert
+    ftsMissing = scalarInt(db, "SELECT COUNT(*) FROM sqlite_master WHERE name='knowledge_fts' "
+                               "AND sql LIKE '%categories%';") <= 0;
+    if(ftsMissing){
+        if(!exec("DROP TRIGGER IF EXISTS knowledge_fts_ai;"
+                 "DROP TRIGGER IF EXISTS knowledge_fts_ad;"
+                 "DROP TRIGGER IF EXISTS knowledge_fts_au;"
+                 "DROP TABLE IF EXISTS knowledge_fts;"))
+            return false;
+    } else if(!installKnowledgeFts(db)){
+        return false;
+    }
+
+    KnowledgeVersion v;
+    ftsChecked = !ftsMissing && readKnowledgeVersion(db, v) &&
+                 scalarInt(db, "SELECT value FROM knowledge_meta WHERE key='fts_checked';") == v.version;
+
+    // Rows already there, by question; ids ascending within each
+    sqlite3_stmt* stmt = nullptr;
+    if(sqlite3_prepare_v2(db, "SELECT id, question, answer, category FROM knowledge ORDER BY id;",
+                          -1, &stmt, nullptr) != SQLITE_OK)
+    {
+        cerr << "Ingest failed: " << sqlite3_errmsg(db) << "\n";
+        return false;
+    }
+    auto text = [&](int i){ const char* s = (const char*)sqlite3_column_text(stmt, i); return string(s ? s : ""); };
+    while(sqlite3_step(stmt) == SQLITE_ROW){
+        Known k = { sqlite3_column_int64(stmt, 0), contentHash(text(2), text(3)), false };
+        known[text(1)].rows.push_back(k);
+    }
+    sqlite3_finalize(stmt);
+
+    if(sqlite3_prepare_v2(db, "INSERT INTO knowledge(question, answer, category) VALUES (?, ?, ?);",
+                          -1, &stmtInsert, nullptr) != SQLITE_OK ||
+       sqlite3_prepare_v2(db, "UPDATE knowledge SET answer = ?, category = ? WHERE id = ?;",
+                          -1, &stmtUpdate, nullptr) != SQLITE_OK ||
+       sqlite3_prepare_v2(db, "DELETE FROM knowledge WHERE id = ?;",
+                          -1, &stmtDelete, nullptr) != SQLITE_OK)
+    {
+        cerr << "Ingest failed: " << sqlite3_errmsg(db) << "\n";
+        return false;
+    }
+    return true;
+}
+
+bool KnowledgeIngest::add(const IngestRecord& r){
+    if(!inTxn) return false;
+    st.read++;
+    uint64_t content = contentHash(r.answer, r.category);
+
+    // The n-th record with this question takes the n-th row with it
+    auto it = known.find(r.question);
+    if(it != known.end() && it->second.claimed < it->second.rows.size()){
+        Known& k = it->second.rows[it->second.claimed++];
+        k.seen = true;
+        if(k.content == content){
+            st.unchanged++;
+            return true;
+        }
+        sqlite3_bind_text (stmtUpdate, 1, r.answer.c_str(),   -1, SQLITE_TRANSIENT);
+        sqlite3_bind_text (stmtUpdate, 2, r.category.c_str(), -1, SQLITE_TRANSIENT);
+        sqlite3_bind_int64(stmtUpdate, 3, k.id);
+        if(!step(stmtUpdate)) return false;
+        k.content = content;
+        st.updated++;
+    } else {
+        sqlite3_bind_text(stmtInsert, 1, r.question.c_str(), -1, SQLITE_TRANSIENT);
+        sqlite3_bind_text(stmtInsert, 2, r.answer.c_str(),   -1, SQLITE_TRANSIENT);
+        sqlite3_bind_text(stmtInsert, 3, r.category.c_str(), -1, SQLITE_TRANSIENT);
+        if(!step(stmtInsert)) return false;
+        st.inserted++;
+    }
+    // A dry run has to stay in one transaction to roll it all back
+    return pending < opt.batch || opt.dryRun || commitBatch();
+}
+
+bool KnowledgeIngest::addSource(const string& path, IngestFormat format){
+    IngestReader reader;
+    if(!reader.open(path, format)){
+        cerr << reader.error() << "\n";
+        return false;
+    }
+    IngestRecord r;
+    while(reader.next(r))
+        if(!add(r)) return false;
+    st.skipped += reader.skipped();
+    if(!reader.error().empty()){
+        cerr << reader.error() << "\n";
+        return false;
+    }
+    return true;
+}
+
+bool KnowledgeIngest::finish(){
+    if(!inTxn) return false;
+
+    if(opt.prune){
+        for(auto& entry : known){
+            for(Known& k : entry.second.rows){
+                if(k.seen) continue;
+                sqlite3_bind_int64(stmtDelete, 1, k.id);
+                if(!step(stmtDelete)) return false;
+                st.deleted++;
+            }
+        }
+    }
+
+    if(opt.dryRun){
+        if(!exec("ROLLBACK;")) return false;
+        inTxn = false;
+        st.seconds = chrono::duration<double>(chrono::steady_clock::now() - started).count();
+        return true;
+    }
+
+    if(ftsMissing){
+        if(!installKnowledgeFts(db) ||
+           !exec("INSERT INTO knowledge_fts(knowledge_fts) VALUES('rebuild');"))
+            return false;
+        st.ftsBuilt = true;
+    }
+
+    // knowledge_fts was in step and only the triggers have touched it
+    // since: spare the assistant its two full counts at startup
+    KnowledgeVersion v;
+    if((ftsChecked || st.ftsBuilt) && readKnowledgeVersion(db, v)){
+        string sql = "INSERT OR REPLACE INTO knowledge_meta VALUES ('fts_checked', " +
+                     to_string(v.version) + ");";
+        if(!exec(sql.c_str())) return false;
+    }
+
+    if(!exec("COMMIT;")) return false;
+    inTxn = false;
+    // Refreshes the planner's statistics where the data moved enough
+    if(st.written() > 0) exec("PRAGMA optimize;");
+    st.seconds = chrono::duration<double>(chrono::steady_clock::now() - started).count();
+    return true;
+}
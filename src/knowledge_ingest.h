@@ -0,0 +1,165 @@
+#pragma once
+#include <string>
+#include <vector>
+#include <unordered_map>
+#include <chrono>
+#include <cstdio>
+#include <cstdint>
+#include <cstddef>
+#include <sqlite3.h>
+
+/*
+ * Incremental knowledge loading for primus_ingest.
+ *
+ * Sources are streamed a record at a time: CSV (RFC 4180 quoting),
+ * TSV (\t \n \\ escapes) or the seed SQL files' INSERT statements,
+ * which are parsed, never executed. CSV and TSV take their columns
+ * from a header row naming question/answer/category, or else in that
+ * order; a missing category is 'सामान्य'.
+ *
+ * Rows are matched to the table by question: the n-th record with a
+ * question updates the n-th row with it (by id), so sources with
+ * repeated questions map the same way every run. A 64-bit content
+ * hash of answer + category decides whether a matched row is written
+ * at all, so reloading a 25k-row file that changed in a few hundred
+ * places writes a few hundred rows. Writes go through prepared
+ * statements in large transactions; the FTS and version triggers
+ * follow every written row, so knowledge_fts is never rebuilt and a
+ * running assistant sees the change at the next commit (WAL readers
+ * are not blocked).
+ */
+
+enum class IngestFormat { Auto, Csv, Tsv, Sql };
+
+struct IngestRecord {
+    std::string question;
+    std::string answer;
+    std::string category;
+};
+
+class IngestReader {
+public:
+    ~IngestReader();
+
+    // path "-" reads stdin; Auto goes by the extension (.csv, .tsv,
+    // .tab, .sql)
+    bool open(const std::string& path, IngestFormat format = IngestFormat::Auto);
+
+    // False at the end of the source or on a read error (error())
+    bool next(IngestRecord& out);
+
+    const std::string& error()   const { return err; }
+    size_t             skipped() const { return bad; }    // malformed or empty records
+
+private:
+    FILE*        in   = nullptr;
+    IngestFormat fmt  = IngestFormat::Csv;
+    char         buf[1 << 16];
+    size_t       pos  = 0, len = 0;
+    size_t       line = 1;
+    size_t       recordLine = 1;
+    size_t       bad  = 0;
+    std::string  err;
+    std::string  name;
+
+    // Column of question, answer and category in CSV/TSV rows
+    int          col[3]   = { 0, 1, 2 };
+    bool         firstRow = true;
+
+    // SQL: the same for the INSERT whose tuples are being read
+    int          sqlCol[3] = { -1, -1, -1 };
+    bool         inValues  = false;
+
+    bool refill(size_t need);
+    int  get();
+    int  peek();
+    int  peek2();
+    void unget(int c);
+    bool nextDelimited(IngestRecord& out);
+    bool nextSql(IngestRecord& out);
+    bool readRow(std::vector<std::string>& fields);
+    bool readStatementHead();
+    bool readTuple(std::vector<std::string>& values);
+    std::string readWord();
+    std::string readName();
+    bool readQuoted(int quote, std::string& out);
+    void skipSpace();
+    void skipStatement();
+    bool fill(IngestRecord& out, const std::vector<std::string>& fields, const int* cols);
+    void malformed(const char* what);
+};
+
+struct IngestOptions {
+    bool   prune  = false;     // delete rows no source mentions
+    bool   dryRun = false;     // count, then roll back
+    size_t batch  = 50000;     // written rows per transaction
+};
+
+struct IngestStats {
+    size_t read      = 0;      // records taken from the sources
+    size_t inserted  = 0;
+    size_t updated   = 0;
+    size_t unchanged = 0;
+    size_t deleted   = 0;
+    size_t skipped   = 0;      // malformed records
+    bool   ftsBuilt  = false;  // knowledge_fts was missing and built in full
+    double seconds   = 0;
+
+    size_t written() const { return inserted + updated + deleted; }
+};
+
+class KnowledgeIngest {
+public:
+    explicit KnowledgeIngest(sqlite3* db, const IngestOptions& options = IngestOptions());
+    ~KnowledgeIngest();
+
+    // Creates the table, indexes, version and FTS triggers if missing,
+    // hashes the rows already there and opens the first transaction
+    bool begin();
+
+    bool add(const IngestRecord& r);
+
+    // Streams every record of a source through add()
+    bool addSource(const std::string& path, IngestFormat format = IngestFormat::Auto);
+
+    // Prunes, commits (or rolls back a dry run) and builds FTS if it
+    // was missing
+    bool finish();
+
+    const IngestStats& stats() const { return st; }
+
+private:
+    struct Known {
+        long long id;
+        uint64_t  content;
+        bool      seen;
+    };
+
+    sqlite3*      db;
+    IngestOptions opt;
+    IngestStats   st;
+    bool          inTxn      = false;
+    bool          ftsMissing = false;
+    size_t        pending    = 0;     // written since the last commit
+    std::chrono::steady_clock::time_point started;
+
+    // question → its rows by id, and how many records have claimed
+    // one so far in this run. Keyed by the text itself: two questions
+    // sharing a hash must never update each other's rows
+    struct Slot {
+        std::vector<Known> rows;
+        size_t             claimed = 0;
+    };
+    std::unordered_map<std::string, Slot> known;
+
+    // fts_checked was current before the run: the triggers keep it so
+    bool ftsChecked = false;
+
+    sqlite3_stmt* stmtInsert = nullptr;
+    sqlite3_stmt* stmtUpdate = nullptr;
+    sqlite3_stmt* stmtDelete = nullptr;
+
+    bool  exec(const char* sql);
+    bool  step(sqlite3_stmt* stmt);
+    bool  commitBatch();
+};
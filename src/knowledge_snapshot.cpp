@@ -0,0 +1,210 @@
+/*
+ * ============================================================
+ *  PRIMUS AI - Knowledge Snapshot
+ *  mmap'ed keyword index tables, versioned against the DB
+ * ============================================================
+ */
+
+#include "knowledge_snapshot.h"
+
+#include <iostream>
+#include <cstdio>
+#include <cstring>
+#include <unistd.h>
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+
+using namespace std;
+
+/* ===== FILE FORMAT ===== */
+
+enum Section { POOL, ROWS, WORDS, POSTINGS, CATEGORIES, STATS, SECTIONS };
+
+struct FileHeader {
+    char     magic[8];          // "PRIMUSKS"
+    uint32_t format;
+    uint32_t indexVersion;      // KEYWORD_INDEX_VERSION
+    int64_t  instance;          // knowledge_meta at compile time
+    int64_t  version;
+    uint64_t normalizer;        // Enhancer::fingerprint of the questions
+    struct { uint64_t offset, count; } sections[SECTIONS];
+};
+
+static const uint32_t FILE_FORMAT = 2;
+
+static const size_t ELEMENT[SECTIONS] = {
+    1, sizeof(IndexRow), sizeof(IndexWord), sizeof(IndexPosting),
+    sizeof(IndexString), sizeof(IndexStats)
+};
+
+/* ===== VERSION TABLE =====
+   One counter per database, moved by every insert, update and
+   delete on knowledge. The instance id tells a re-created database
+   apart from the one a snapshot was compiled from. */
+
+static const char* VERSION_SCHEMA =
+    "CREATE TABLE IF NOT EXISTS knowledge_meta "
+    "(key TEXT PRIMARY KEY, value INTEGER NOT NULL);"
+
+    "INSERT OR IGNORE INTO knowledge_meta VALUES ('instance', random());"
+    "INSERT OR IGNORE INTO knowledge_meta VALUES ('version', 0);"
+
+    "CREATE TRIGGER IF NOT EXISTS knowledge_meta_ai AFTER INSERT ON knowledge BEGIN "
+    "UPDATE knowledge_meta SET value = value + 1 WHERE key = 'version'; END;"
+
+    "CREATE TRIGGER IF NOT EXISTS knowledge_meta_ad AFTER DELETE ON knowledge BEGIN "
+    "UPDATE knowledge_meta SET value = value + 1 WHERE key = 'version'; END;"
+
+    "CREATE TRIGGER IF NOT EXISTS knowledge_meta_au AFTER UPDATE ON knowledge BEGIN "
+    "UPDATE knowledge_meta SET value = value + 1 WHERE key = 'version'; END;";
+
+bool installKnowledgeVersion(sqlite3* db){
+    char* err = nullptr;
+    if(sqlite3_exec(db, VERSION_SCHEMA, 0,0, &err) != SQLITE_OK){
+        cerr << "Version table setup failed: " << (err ? err : "?") << "\n";
+        sqlite3_free(err);
+        return false;
+    }
+    return true;
+}
+
+bool readKnowledgeVersion(sqlite3* db, KnowledgeVersion& out){
+    out = KnowledgeVersion();
+    sqlite3_stmt* stmt;
+    if(sqlite3_prepare_v2(db, "SELECT key, value FROM knowledge_meta "
+                              "WHERE key IN ('instance', 'version');",
+                          -1, &stmt, nullptr) != SQLITE_OK)
+        return false;
+    while(sqlite3_step(stmt) == SQLITE_ROW){
+        const char* key = (const char*)sqlite3_column_text(stmt, 0);
+        long long   v   = sqlite3_column_int64(stmt, 1);
+        if(key && strcmp(key, "instance") == 0) out.instance = v;
+        if(key && strcmp(key, "version")  == 0) out.version  = v;
+    }
+    sqlite3_finalize(stmt);
+    return out.version >= 0;
+}
+
+/* ================================================================
+   READER
+================================================================ */
+
+KnowledgeSnapshot::~KnowledgeSnapshot(){
+    if(map) munmap(map, mapLen);
+}
+
+bool KnowledgeSnapshot::open(const string& path){
+    int fd = ::open(path.c_str(), O_RDONLY | O_CLOEXEC);
+    if(fd < 0) return false;
+
+    struct stat st;
+    if(fstat(fd, &st) != 0 || (size_t)st.st_size < sizeof(FileHeader)){
+        ::close(fd);
+        return false;
+    }
+    void* base = mmap(nullptr, st.st_size, PROT_READ, MAP_SHARED, fd, 0);
+    ::close(fd);
+    if(base == MAP_FAILED) return false;
+    map    = base;
+    mapLen = st.st_size;
+
+    FileHeader h;
+    memcpy(&h, base, sizeof(h));
+    bool ok = memcmp(h.magic, "PRIMUSKS", 8) == 0 && h.format == FILE_FORMAT &&
+              h.indexVersion == KEYWORD_INDEX_VERSION;
+
+    // Sections must lie inside the file, aligned for their element type
+    const void* at[SECTIONS] = {};
+    for(int s = 0; ok && s < SECTIONS; s++){
+        uint64_t off = h.sections[s].offset, n = h.sections[s].count;
+        ok = off >= sizeof(FileHeader) && off <= mapLen && off % 8 == 0 &&
+             n <= (mapLen - off) / ELEMENT[s];
+        at[s] = (const char*)base + off;
+    }
+    // Row numbers and string offsets are 32-bit
+    ok = ok && h.sections[ROWS].count <= UINT32_MAX && h.sections[POOL].count <= UINT32_MAX;
+    if(!ok){
+        munmap(map, mapLen);
+        map = nullptr;
+        return false;
+    }
+
+    t.pool       = (const char*)at[POOL];              t.poolBytes     = h.sections[POOL].count;
+    t.rows       = (const IndexRow*)at[ROWS];          t.rowCount      = h.sections[ROWS].count;
+    t.words      = (const IndexWord*)at[WORDS];        t.wordCount     = h.sections[WORDS].count;
+    t.postings   = (const IndexPosting*)at[POSTINGS];  t.postingCount  = h.sections[POSTINGS].count;
+    t.categories = (const IndexString*)at[CATEGORIES]; t.categoryCount = h.sections[CATEGORIES].count;
+    t.stats      = (const IndexStats*)at[STATS];       t.statsCount    = h.sections[STATS].count;
+    built        = { h.instance, h.version };
+    normalizerId = h.normalizer;
+
+    // Queries jump around the word and posting tables
+    madvise(map, mapLen, MADV_RANDOM);
+    return true;
+}
+
+/* ================================================================
+   WRITER (primus_snapshot)
+================================================================ */
+
+bool KnowledgeSnapshot::write(const string& path, const KeywordIndex& index,
+                              const KnowledgeVersion& source, uint64_t normalizer)
+{
+    const KeywordTables& x = index.tables();
+    const void* data[SECTIONS] = { x.pool, x.rows, x.words, x.postings,
+                                   x.categories, x.stats };
+    size_t count[SECTIONS] = { x.poolBytes, x.rowCount, x.wordCount, x.postingCount,
+                               x.categoryCount, x.statsCount };
+
+    FileHeader h = {};
+    memcpy(h.magic, "PRIMUSKS", 8);
+    h.format       = FILE_FORMAT;
+    h.indexVersion = KEYWORD_INDEX_VERSION;
+    h.instance     = source.instance;
+    h.version      = source.version;
+    h.normalizer   = normalizer;
+    uint64_t offset = sizeof(FileHeader);
+    for(int s = 0; s < SECTIONS; s++){
+        offset = (offset + 7) & ~uint64_t(7);
+        h.sections[s] = { offset, count[s] };
+        offset += count[s] * ELEMENT[s];
+    }
+
+    string tmp = path + ".tmp";
+    FILE* f = fopen(tmp.c_str(), "wb");
+    if(!f) return false;
+    bool ok = fwrite(&h, sizeof(h), 1, f) == 1;
+    for(int s = 0; s < SECTIONS && ok; s++){
+        static const char zeros[8] = {};
+        long pad = (long)h.sections[s].offset - ftell(f);
+        ok = (pad == 0 || fwrite(zeros, 1, pad, f) == (size_t)pad) &&
+             (count[s] == 0 || fwrite(data[s], ELEMENT[s], count[s], f) == count[s]);
+    }
+    ok = (fclose(f) == 0) && ok;
+
+    if(ok && rename(tmp.c_str(), path.c_str()) == 0) return true;
+    unlink(tmp.c_str());
+    return false;
+}
+
+bool KnowledgeSnapshot::compile(sqlite3* db, const string& path,
+                                const KeywordIndex::Normalizer& normalize, uint64_t normalizer,
+                                size_t* rows)
+{
+    if(!installKnowledgeVersion(db)) return false;
+
+    // Version and rows from the same read transaction, so a commit in
+    // between cannot leave the snapshot claiming a state it lacks
+    KeywordIndex     index;
+    KnowledgeVersion source;
+    sqlite3_exec(db, "BEGIN;", 0,0,0);
+    bool ok = readKnowledgeVersion(db, source) && index.build(db, normalize);
+    sqlite3_exec(db, "COMMIT;", 0,0,0);
+    if(!ok){
+        cerr << "Snapshot: cannot read knowledge: " << sqlite3_errmsg(db) << "\n";
+        return false;
+    }
+    if(rows) *rows = index.rowCount();
+    return write(path, index, source, normalizer);
+}
@@ -0,0 +1,72 @@
+#pragma once
+#include <string>
+#include <memory>
+#include <cstdint>
+#include <cstddef>
+#include <sqlite3.h>
+
+#include "keyword_index.h"
+
+/*
+ * Compiled knowledge search tables, built offline by primus_snapshot.
+ *
+ * One file, mmap'ed read-only:
+ *   header | pool | rows | words | postings | categories | stats
+ * i.e. the KeywordIndex tables byte for byte (interned UTF-8 strings,
+ * sorted token dictionary with precomputed IDF, posting lists with
+ * term counts, category ids, per-row token counts). Startup maps them instead of scanning the table, and pages
+ * are only read in as queries touch them.
+ *
+ * The header names the database state it was compiled from and the
+ * question normalizer's fingerprint (Enhancer::fingerprint). Triggers
+ * bump knowledge_meta's version on every change to knowledge, so a
+ * single-row read tells whether the snapshot is stale; a stale one is
+ * ignored and the index is built from SQLite as before.
+ */
+
+struct KnowledgeVersion {
+    long long instance = -1;   // random per database file
+    long long version  = -1;   // changes to knowledge since then
+
+    bool operator==(const KnowledgeVersion& o) const {
+        return instance == o.instance && version == o.version;
+    }
+    bool operator!=(const KnowledgeVersion& o) const { return !(*this == o); }
+};
+
+// Creates knowledge_meta and its triggers if missing (needs a
+// writable connection)
+bool installKnowledgeVersion(sqlite3* db);
+
+// False when knowledge_meta is missing
+bool readKnowledgeVersion(sqlite3* db, KnowledgeVersion& out);
+
+class KnowledgeSnapshot {
+public:
+    ~KnowledgeSnapshot();
+
+    // False if missing, corrupt, or built by another KEYWORD_INDEX_VERSION
+    bool open(const std::string& path);
+
+    const KnowledgeVersion& source()     const { return built; }
+    uint64_t                normalizer() const { return normalizerId; }
+    const KeywordTables&    tables() const { return t; }
+    size_t                  bytes()  const { return mapLen; }
+
+    // Writes index via a temp file + rename; normalizer identifies
+    // the function its questions were normalized with
+    static bool write(const std::string& path, const KeywordIndex& index,
+                      const KnowledgeVersion& source, uint64_t normalizer);
+
+    // Reads version and table in one transaction, then writes
+    static bool compile(sqlite3* db, const std::string& path,
+                        const KeywordIndex::Normalizer& normalize, uint64_t normalizer,
+                        size_t* rows = nullptr);
+
+private:
+    void*            map    = nullptr;
+    size_t           mapLen = 0;
+    KeywordTables    t;
+    KnowledgeVersion built;
+    uint64_t         normalizerId = 0;
+};
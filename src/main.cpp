@@ -7,6 +7,11 @@
 
 #include "hindi_ai.h"
 #include "tts.h"
+#include "ipc_server.h"
+#include "session_manager.h"
+#include "intent_router.h"
+#include "hindi_math.h"
+#include "trace.h"
 
 #include <iostream>
 #include <string>
@@ -14,6 +19,12 @@
 #include <sstream>
 #include <ctime>
 #include <cmath>
+#include <chrono>
+#include <cstdlib>
+#include <csignal>
+#include <thread>
+#include <mutex>
+#include <atomic>
 
 using namespace std;
 
@@ -25,15 +36,13 @@ string toLower(string text){
     return text;
 }
 
-bool contains(const string& text, const string& word){
-    return text.find(word) != string::npos;
-}
-
 /* ===== TIME ===== */
 
+// localtime_r: server workers call these concurrently
 string getCurrentTime(){
     time_t now = time(0);
-    tm *ltm = localtime(&now);
+    tm tmBuf;
+    tm *ltm = localtime_r(&now, &tmBuf);
     stringstream ss;
     ss << "वर्तमान समय है "
        << ltm->tm_hour << " बजकर "
@@ -47,7 +56,8 @@ string getCurrentTime(){
 
 string getCurrentDate(){
     time_t now = time(0);
-    tm *ltm = localtime(&now);
+    tm tmBuf;
+    tm *ltm = localtime_r(&now, &tmBuf);
 
     static const string months[] = {
         "जनवरी","फरवरी","मार्च","अप्रैल","मई","जून",
@@ -68,69 +78,177 @@ string getCurrentDate(){
 /* ===== SIMPLE MATH ===== */
 
 string evaluateMath(const string& input){
-    // Detect basic arithmetic in Hindi
-    // e.g. "25 और 30 का जोड़" / "100 में से 45 घटाओ"
-    double a = 0, b = 0;
-    char op = 0;
-
-    if(contains(input, "जोड़") || contains(input, "plus") || contains(input, "+")){
-        op = '+';
-    } else if(contains(input, "घटाओ") || contains(input, "minus") || contains(input, "-")){
-        op = '-';
-    } else if(contains(input, "गुणा") || contains(input, "multiply") || contains(input, "*")){
-        op = '*';
-    } else if(contains(input, "भाग") || contains(input, "divide") || contains(input, "/")){
-        op = '/';
+    // Spoken arithmetic: "25 और 30 का जोड़", "100 में से 45 घटाओ",
+    // "दो की घात दस", "200 का 15 प्रतिशत" (see hindi_math.h)
+    MathResult r = evaluateArithmetic(input);
+    switch(r.status){
+        case MathStatus::NotMath:      return "";
+        case MathStatus::DivideByZero: return "शून्य से भाग संभव नहीं है।";
+        case MathStatus::OutOfRange:   return "यह गणना संभव नहीं है।";
+        case MathStatus::Ok:           break;
     }
 
-    if(op == 0) return "";
-
-    // Extract numbers
-    istringstream ss(input);
-    string token;
-    vector<double> nums;
-    while(ss >> token){
-        try {
-            double n = stod(token);
-            nums.push_back(n);
-        } catch(...) {}
+    string result = formatHindiNumber(r.value);
+    string a = formatHindiNumber(r.lhs), b = formatHindiNumber(r.rhs);
+    switch(r.op){
+        case '+': return a + " और " + b + " का जोड़ है: " + result;
+        case '-': return a + " और " + b + " का अंतर है: " + result;
+        case '*': return a + " और " + b + " का गुणनफल है: " + result;
+        case '/': return a + " और " + b + " का भागफल है: " + result;
+        case '^': return a + " की घात " + b + " है: " + result;
     }
+    return "उत्तर है: " + result;
+}
 
-    if(nums.size() < 2) return "";
-
-    a = nums[0]; b = nums[1];
-    double result = 0;
-    string opName;
+/* ===== ROUTING ===== */
+
+// Intent table compiled once; every utterance is scanned once
+static const IntentRouter router;
+
+static const TraceStage TRACE_RESPOND("main.respond");
+static const TraceStage TRACE_ROUTE  ("main.route");
+static const TraceStage TRACE_MATH   ("main.math");
+
+// Shared by the console loop and server mode. answerId/answerLen
+// name the knowledge row the response starts with (-1 / 0 if none)
+string respond(HindiAI& ai, Session& session, const string& input,
+               long long& answerId, size_t& answerLen)
+{
+    TraceSpan span(TRACE_RESPOND);
+    string processed = toLower(input);
+    Route  route;
+    {
+        TraceSpan span(TRACE_ROUTE);
+        route = router.route(processed);
+    }
+    string response;
+
+    answerId  = -1;
+    answerLen = 0;
+    auto ask = [&](Intent intent){
+        string r  = ai.generateResponse(input, session, intent);
+        answerId  = session.answerId;
+        answerLen = session.answerLen;
+        return r;
+    };
+    auto math = [&]{
+        TraceSpan span(TRACE_MATH);
+        return evaluateMath(processed);
+    };
 
-    if(op == '+') { result = a+b; opName = "जोड़"; }
-    if(op == '-') { result = a-b; opName = "अंतर"; }
-    if(op == '*') { result = a*b; opName = "गुणनफल"; }
-    if(op == '/' && b != 0) { result = a/b; opName = "भागफल"; }
-    else if(op == '/' && b == 0) return "शून्य से भाग संभव नहीं है।";
+    switch(route.intent){
+
+    case Intent::Greeting:
+        response = "नमस्ते बॉस! मैं PRIMUS हूँ। भारतीय राजनीति, सिनेमा, "
+                   "भूगोल, कानून या तकनीक — किसी भी विषय पर पूछें।";
+        break;
+
+    case Intent::Time:
+        response = getCurrentTime();
+        break;
+
+    case Intent::Date:
+        response = getCurrentDate();
+        break;
+
+    case Intent::Math:
+        response = math();
+        if(response.empty())
+            response = ask(Intent::Knowledge);
+        break;
+
+    case Intent::Help:
+        response = "मैं इन विषयों में मदद कर सकता हूँ:\n"
+                   "• भारतीय राजनीति — नेता, दल, चुनाव, संसद\n"
+                   "• भारतीय सिनेमा — फिल्में, कलाकार, पुरस्कार\n"
+                   "• भारतीय भूगोल — राज्य, नदियाँ, पर्वत, राजधानियाँ\n"
+                   "• भारतीय कानून — धाराएँ, संविधान, न्यायालय\n"
+                   "• तकनीक — इंटरनेट, एआई, कंप्यूटर, मोबाइल\n"
+                   "• गणित — जोड़, घटाव, गुणा, भाग\n"
+                   "• समय और तारीख\n\n"
+                   "बस पूछिए!";
+        break;
+
+    /* --- AI KNOWLEDGE DB --- */
+    case Intent::FollowUp:
+        response = ask(route.intent);
+        break;
+
+    case Intent::Knowledge:
+        // Arithmetic without a trigger word: "दो और दो कितने होते हैं"
+        response = math();
+        if(response.empty())
+            response = ask(Intent::Knowledge);
+        break;
+    }
 
-    stringstream ans;
-    ans << a << " और " << b << " का " << opName << " है: " << result;
-    return ans.str();
+    return response;
 }
 
-/* ===== MAIN ===== */
+/* ===== TRACE ===== */
 
-int main(){
+// PREFIX.stages.json: p50/p95/p99 per stage; PREFIX.chrome.json: the
+// latest spans for chrome://tracing or ui.perfetto.dev
+static string tracePrefix;
 
-    const string dbPath = "/home/pi/primus/AI/knowledge.db";
+static void dumpTrace(){
+    if(!traceEnabled()){
+        cerr << "Tracing is off (start with --trace PREFIX)\n";
+        return;
+    }
+    string stages = tracePrefix + ".stages.json", chrome = tracePrefix + ".chrome.json";
+    if(traceDumpJson(stages) && traceDumpChrome(chrome))
+        cerr << "[trace] " << traceTotals().spans << " spans → " << stages << ", " << chrome << "\n";
+    else
+        cerr << "[trace] cannot write " << tracePrefix << ".*.json\n";
+}
 
-    HindiAI ai(dbPath);
+/* ===== SIGNALS ===== */
+
+// kill -USR1 dumps the trace without stopping, kill -HUP reloads the
+// knowledge base now. Every thread blocks both and one thread takes
+// them, so neither runs in a handler
+static sigset_t controlSignals(){
+    sigset_t set;
+    sigemptyset(&set);
+    sigaddset(&set, SIGUSR1);
+    sigaddset(&set, SIGHUP);
+    return set;
+}
 
-    // Deep Male Hindi Voice
-    TTS tts(1.0, 130, 22);
+static void blockSignals(){
+    sigset_t set = controlSignals();
+    pthread_sigmask(SIG_BLOCK, &set, nullptr);  // inherited by threads made after this
+}
 
-    cerr << "╔══════════════════════════════════════╗\n";
-    cerr << "║   PRIMUS AI v2.0 — Enhanced Hindi   ║\n";
-    cerr << "║   2000+ Facts: Politics, Cinema,    ║\n";
-    cerr << "║   Geography, Law, Technology        ║\n";
-    cerr << "╚══════════════════════════════════════╝\n";
-    cerr << "Type 'exit' to quit.\n\n";
+// Joined before the assistant it reloads goes away, so a SIGHUP during
+// shutdown cannot run a rebuild on a destroyed HindiAI
+class SignalThread {
+public:
+    explicit SignalThread(HindiAI& ai)
+        : worker([this, &ai]{
+              sigset_t set = controlSignals();
+              int sig;
+              while(sigwait(&set, &sig) == 0 && !stopping){
+                  if(sig == SIGUSR1) dumpTrace();
+                  else ai.reload(true);
+              }
+          }) {}
+    ~SignalThread(){
+        stopping = true;
+        pthread_kill(worker.native_handle(), SIGHUP);  // wakes sigwait
+        worker.join();
+    }
+private:
+    atomic<bool> stopping{false};
+    thread worker;
+};
 
+/* ===== CONSOLE ===== */
+
+// "@kitchen question" asks in session "kitchen" and makes it current;
+// "trace" writes the trace files, "reload" rebuilds from knowledge.db
+void console(HindiAI& ai, TTS& tts, SessionManager& sessions, string current){
     string input;
 
     while(true){
@@ -138,78 +256,229 @@ int main(){
         cout << "\nYou: ";
         cout.flush();
 
-        if(!getline(cin, input)) break;
-        if(input == "exit" || input == "बंद") break;
-        if(input.empty()) continue;
-
-        string processed = toLower(input);
-        string response;
-
-        /* --- GREETING --- */
-        if(contains(processed, "hello") ||
-           contains(processed, "hey")   ||
-           contains(processed, "नमस्ते")||
-           contains(processed, "हाय"))
-        {
-            response = "नमस्ते बॉस! मैं PRIMUS हूँ। भारतीय राजनीति, सिनेमा, "
-                       "भूगोल, कानून या तकनीक — किसी भी विषय पर पूछें।";
-        }
-
-        /* --- TIME --- */
-        else if(contains(processed, "समय") ||
-                contains(processed, "टाइम")||
-                contains(processed, "time"))
-        {
-            response = getCurrentTime();
+        if(!getline(cin, input)){
+            tts.flush();                   // end of input: let the last answer finish
+            break;
         }
+        if(input.empty()) continue;
 
-        /* --- DATE --- */
-        else if(contains(processed, "तारीख")  ||
-                contains(processed, "दिनांक") ||
-                contains(processed, "डेट")    ||
-                contains(processed, "date"))
-        {
-            response = getCurrentDate();
+        // A new query interrupts whatever is still being spoken
+        tts.cancel();
+        if(input == "exit" || input == "बंद") break;
+        if(input == "trace"){
+            dumpTrace();
+            continue;
         }
-
-        /* --- MATH --- */
-        else if(contains(processed, "जोड़")   ||
-                contains(processed, "घटाओ")   ||
-                contains(processed, "गुणा")   ||
-                contains(processed, "भाग")    ||
-                contains(processed, "calculate"))
-        {
-            response = evaluateMath(processed);
-            if(response.empty())
-                response = ai.generateResponse(input);
+        if(input == "reload"){
+            if(!ai.reload(true)) cerr << "Reload failed, still on the old knowledge base\n";
+            continue;
         }
 
-        /* --- HELP --- */
-        else if(contains(processed, "मदद") ||
-                contains(processed, "help"))
-        {
-            response = "मैं इन विषयों में मदद कर सकता हूँ:\n"
-                       "• भारतीय राजनीति — नेता, दल, चुनाव, संसद\n"
-                       "• भारतीय सिनेमा — फिल्में, कलाकार, पुरस्कार\n"
-                       "• भारतीय भूगोल — राज्य, नदियाँ, पर्वत, राजधानियाँ\n"
-                       "• भारतीय कानून — धाराएँ, संविधान, न्यायालय\n"
-                       "• तकनीक — इंटरनेट, एआई, कंप्यूटर, मोबाइल\n"
-                       "• गणित — जोड़, घटाव, गुणा, भाग\n"
-                       "• समय और तारीख\n\n"
-                       "बस पूछिए!";
+        if(input[0] == '@'){
+            size_t sp = input.find(' ');
+            current = input.substr(1, sp == string::npos ? sp : sp - 1);
+            input   = sp == string::npos ? "" : input.substr(sp + 1);
+            if(input.empty()) continue;
         }
 
-        /* --- AI KNOWLEDGE DB --- */
-        else{
-            response = ai.generateResponse(input);
-        }
+        long long answerId  = -1;
+        size_t    answerLen = 0;
+        string response = respond(ai, *sessions.acquire(current), input, answerId, answerLen);
 
         cout << "AI: " << response << "\n";
         cout.flush();
 
-        tts.speak(response);
+        tts.speakAnswer(response, answerId, answerLen);
+    }
+}
+
+/* ===== SERVER ===== */
+
+static volatile sig_atomic_t stopServing = 0;
+
+/* ===== MAIN ===== */
+
+int main(int argc, char** argv){
+
+    const string dbPath = "/home/pi/primus/AI/knowledge.db";
+
+    // --autocorrect            enable STT correction on search miss
+    // --correct-budget-us N    per-query correction time budget
+    // --correct-verbose        print each rewrite to stderr
+    // --audio SPEC             aplay (default) | null | - | out.wav
+    // --audio-cache DIR        keep rendered phrases on disk across runs
+    // --audio-cache-mb N       in-memory phrase cache size (0 = off)
+    // --answer-audio FILE      pre-rendered answers (primus_prerender)
+    // --snapshot FILE          compiled keyword index (primus_snapshot)
+    // --serve SOCKET           answer framed queries on a Unix socket
+    // --workers N              server threads (default: one per core)
+    // --answer-cache N         remembered searches (default 1024, 0 = off)
+    // --session ID             console conversation id (default "console")
+    // --session-idle S         forget a conversation after S idle seconds
+    // --session-mb N           memory cap over all conversations
+    // --trace PREFIX           per-stage latency tracing, dumped to
+    //                          PREFIX.stages.json / PREFIX.chrome.json
+    //                          on "trace", SIGUSR1 and exit
+    // --reload-ms N            check knowledge.db for a new version every
+    //                          N ms and swap it in (default 1000, 0 = off;
+    //                          "reload" and SIGHUP force one)
+    CorrectionOptions correction;
+    string audioSpec = "aplay";
+    string cacheDir;
+    int    cacheMb   = 16;
+    string answerAudio = dbPath.substr(0, dbPath.rfind('/') + 1) + "answer_audio.bin";
+    string snapshot    = dbPath.substr(0, dbPath.rfind('/') + 1) + "knowledge.snap";
+    string servePath;
+    int    workers = max(1u, thread::hardware_concurrency());
+    int    answerCache = 1024;
+    int    reloadMs    = 1000;
+    string sessionId = "console";
+    SessionOptions sessionOpts;
+    for(int i = 1; i < argc; i++){
+        string arg = argv[i];
+        if(arg == "--autocorrect")
+            correction.enabled = true;
+        else if(arg == "--correct-budget-us" && i + 1 < argc)
+            correction.budget = chrono::microseconds(atoi(argv[++i]));
+        else if(arg == "--correct-verbose")
+            correction.verbose = true;
+        else if(arg == "--audio" && i + 1 < argc)
+            audioSpec = argv[++i];
+        else if(arg == "--audio-cache" && i + 1 < argc)
+            cacheDir = argv[++i];
+        else if(arg == "--audio-cache-mb" && i + 1 < argc)
+            cacheMb = atoi(argv[++i]);
+        else if(arg == "--answer-audio" && i + 1 < argc)
+            answerAudio = argv[++i];
+        else if(arg == "--snapshot" && i + 1 < argc)
+            snapshot = argv[++i];
+        else if(arg == "--serve" && i + 1 < argc)
+            servePath = argv[++i];
+        else if(arg == "--workers" && i + 1 < argc)
+            workers = max(1, atoi(argv[++i]));
+        else if(arg == "--answer-cache" && i + 1 < argc)
+            answerCache = max(0, atoi(argv[++i]));
+        else if(arg == "--session" && i + 1 < argc)
+            sessionId = argv[++i];
+        else if(arg == "--session-idle" && i + 1 < argc)
+            sessionOpts.idleTimeout = chrono::seconds(atoi(argv[++i]));
+        else if(arg == "--session-mb" && i + 1 < argc)
+            sessionOpts.maxBytes = (size_t)atoi(argv[++i]) << 20;
+        else if(arg == "--trace" && i + 1 < argc)
+            tracePrefix = argv[++i];
+        else if(arg == "--reload-ms" && i + 1 < argc)
+            reloadMs = max(0, atoi(argv[++i]));
+    }
+
+    // Before any other thread exists, so all of them leave SIGUSR1 and
+    // SIGHUP alone
+    blockSignals();
+    // A player that dies mid-utterance must not take us down with it;
+    // spawned tools get the default back
+    signal(SIGPIPE, SIG_IGN);
+    if(!tracePrefix.empty()){
+        traceEnable(true);
+        traceNameThread("main");
+    }
+
+    HindiAI ai(dbPath, snapshot);
+    ai.setCorrection(correction);
+    ai.setAnswerCacheSize(answerCache);
+    ai.watchForReload(chrono::milliseconds(reloadMs));
+    SignalThread signals(ai);
+    SessionManager sessions(sessionOpts);
+
+    // Deep Male Hindi Voice
+    TTS tts(1.0, 130, 22);
+    tts.setSink(makeAudioSink(audioSpec));
+    if(cacheMb > 0){
+        auto cache = make_unique<PhraseCache>((size_t)cacheMb << 20);
+        if(!cache->setDirectory(cacheDir))
+            cerr << "TTS cache: cannot use " << cacheDir << ", memory only\n";
+        tts.setCache(move(cache));
+    } else {
+        tts.setCache(nullptr);
+    }
+    auto store = make_shared<AnswerAudio>();
+    if(store->open(answerAudio)){
+        if(tts.setAnswerAudio(store))
+            cerr << "Answer audio: " << store->count() << " answers pre-rendered\n";
+        else
+            cerr << "Answer audio: rendered with another voice, ignored\n";
+    }
+    tts.onSpoken([](const SpeakStats& ts){
+        cerr << "[tts] first audio " << (int)ts.firstAudioMs << " ms, total "
+             << (int)ts.totalMs << " ms\n";
+    });
+
+    cerr << "╔══════════════════════════════════════╗\n";
+    cerr << "║   PRIMUS AI v2.0 — Enhanced Hindi   ║\n";
+    cerr << "║   2000+ Facts: Politics, Cinema,    ║\n";
+    cerr << "║   Geography, Law, Technology        ║\n";
+    cerr << "╚══════════════════════════════════════╝\n";
+
+    if(!servePath.empty()){
+        IpcServer server(workers);
+        if(!server.listen(servePath)) return 1;
+        cerr << "Serving on " << servePath << " with " << workers
+             << " workers (Ctrl+C to stop)\n\n";
+
+        // Queries without a session id share one conversation per
+        // connection, forgotten when it closes. Named sessions (rooms,
+        // speakers) outlive connections until idle or evicted
+        auto connectionSession = [](uint64_t client){ return "#" + to_string(client); };
+        server.onDisconnect([&](uint64_t client){
+            sessions.erase(connectionSession(client));
+        });
+        mutex speakLock;
+
+        struct sigaction sa = {};
+        sa.sa_handler = [](int){ stopServing = 1; };
+        sigaction(SIGINT,  &sa, nullptr);
+        sigaction(SIGTERM, &sa, nullptr);
+
+        server.run([&](const IpcMessage& q, uint64_t client){
+            auto session = sessions.acquire(q.session.empty() ? connectionSession(client)
+                                                              : q.session);
+            IpcMessage reply;
+            long long answerId  = -1;
+            size_t    answerLen = 0;
+            reply.text     = respond(ai, *session, q.text, answerId, answerLen);
+            reply.answerId = answerId;
+            // Latest spoken query wins, as in the console loop
+            if(q.flags & IPC_SPEAK){
+                lock_guard<mutex> g(speakLock);
+                tts.cancel();
+                tts.speakAnswer(reply.text, answerId, answerLen);
+            }
+            return reply;
+        }, &stopServing);
+        tts.cancel();
+    } else {
+        cerr << "Type 'exit' to quit.\n\n";
+        console(ai, tts, sessions, sessionId);
     }
 
+    SessionStats ss = sessions.stats();
+    cerr << "\nSessions: " << ss.sessions << " open (" << ss.bytes / 1024 << " KiB), "
+         << ss.created << " created, " << ss.expired << " expired, "
+         << ss.evicted << " evicted\n";
+    cerr << "SQL: " << ai.sqlPrepares() << " prepares / "
+         << ai.sqlExecutions() << " executions\n";
+    AnswerCacheStats as = ai.answerCacheStats();
+    cerr << "Answer cache: " << as.hits << " hits / " << as.misses << " misses ("
+         << (int)(as.hitRate() * 100) << "%), " << as.entries << " entries, "
+         << as.invalidations << " invalidations\n";
+    ReloadStats rs = ai.reloadStats();
+    if(rs.reloads || rs.failures)
+        cerr << "Reloads: " << rs.reloads << " (" << rs.failures << " failed), last "
+             << (int)rs.lastMs << " ms, now at version " << rs.version.version << "\n";
+    PhraseCacheStats cs = tts.cacheStats();
+    cerr << "TTS cache: " << cs.hits << " hits + " << cs.diskHits << " disk / "
+         << cs.misses << " misses (" << (int)(cs.hitRate() * 100) << "%), "
+         << cs.entries << " phrases, " << cs.bytes / 1024 << " KiB in memory, "
+         << cs.diskBytes / 1024 << " KiB on disk\n";
+    if(traceEnabled()) dumpTrace();
     cerr << "\nPRIMUS AI बंद हो रहा है। अलविदा!\n";
     return 0;
 }
@@ -2,6 +2,7 @@
  * ============================================================
  *  PRIMUS AI v2.0 — Performer
  *  Vocabulary builder, Levenshtein fuzzy match, auto-correct
+ *  Distances are in code points; lookups go through a BK-tree
  * ============================================================
  */
 
@@ -14,6 +15,9 @@
 
 using namespace std;
 
+// autoCorrect accepts a vocabulary word above this similarity
+static const double MIN_SIMILARITY = 0.80;
+
 /* ================= CONSTRUCTOR ================= */
 
 Performer::Performer(){
@@ -48,45 +52,21 @@ void Performer::loadSynonyms(){
 
 /* ================= BUILD VOCAB ================= */
 
-void Performer::buildVocabulary(sqlite3* db){
-
-    vocabulary.clear();
+void Performer::buildVocabulary(const vector<string>& words){
 
-    sqlite3_stmt *stmt;
-    string sql = "SELECT question FROM knowledge;";
-    sqlite3_prepare_v2(db, sql.c_str(), -1, &stmt, 0);
-
-    while(sqlite3_step(stmt) == SQLITE_ROW){
-        string q = (const char*)sqlite3_column_text(stmt, 0);
-        stringstream ss(q);
-        string word;
-        while(ss >> word)
-            vocabulary.insert(word);
-    }
-
-    sqlite3_finalize(stmt);
+    vocabulary = set<string>(words.begin(), words.end());
+    fuzzyIndex.build(vector<string>(vocabulary.begin(), vocabulary.end()));
 }
 
 /* ================= FUZZY SIMILARITY ================= */
 
 double Performer::fuzzySimilarity(const string &a, const string &b){
 
-    int m = a.size(), n = b.size();
-    vector<vector<int>> dp(m + 1, vector<int>(n + 1));
-
-    for(int i = 0; i <= m; i++) dp[i][0] = i;
-    for(int j = 0; j <= n; j++) dp[0][j] = j;
-
-    for(int i = 1; i <= m; i++)
-        for(int j = 1; j <= n; j++)
-            dp[i][j] = min({
-                dp[i-1][j] + 1,
-                dp[i][j-1] + 1,
-                dp[i-1][j-1] + (a[i-1] != b[j-1] ? 1 : 0)
-            });
+    u32string ca = toCodePoints(a);
+    u32string cb = toCodePoints(b);
 
-    int lev    = dp[m][n];
-    int maxLen = max(m, n);
+    int lev    = editDistance(ca, cb);
+    int maxLen = max(ca.size(), cb.size());
 
     if(maxLen == 0) return 1.0;
     return 1.0 - (double)lev / maxLen;
@@ -94,24 +74,37 @@ double Performer::fuzzySimilarity(const string &a, const string &b){
 
 /* ================= AUTO CORRECT ================= */
 
-string Performer::autoCorrect(const string &word){
+string Performer::autoCorrect(const string &word) const {
+
+    if(word.size() < 3 || vocabulary.count(word))
+        return word;
+
+    // sim = 1 - d / max(m, n) and n ≤ m + d, so any word above the
+    // threshold lies within d < m·(1 - s)/s of the query
+    u32string cps = toCodePoints(word);
+    int m      = cps.size();
+    int radius = (int)floor(m * (1.0 - MIN_SIMILARITY) / MIN_SIMILARITY - 1e-9);
+    if(radius < 1) return word;
+
+    thread_local vector<FuzzyCandidate> candidates;
+    fuzzyIndex.lookup(cps, radius, candidates);
 
     double best      = 0.0;
     string bestMatch = word;
 
-    for(auto &v : vocabulary){
+    for(auto &c : candidates){
 
-        if(word.size() < 3) continue;
+        double sim = 1.0 - (double)c.distance / max(m, c.length);
 
-        double sim = fuzzySimilarity(word, v);
-
-        if(sim > best){
+        // Ties go to the lexicographically first word, as the old
+        // ordered scan over the vocabulary did
+        if(sim > best || (sim == best && *c.word < bestMatch)){
             best      = sim;
-            bestMatch = v;
+            bestMatch = *c.word;
         }
     }
 
-    if(best > 0.80)
+    if(best > MIN_SIMILARITY)
         return bestMatch;
 
     return word;
@@ -151,4 +144,37 @@ string Performer::normalizeQuery(const string &input){
     }
 
     return result;
-}
\ No newline at end of file
+}
+
+/* ================= CORRECT QUERY (time-bounded) ================= */
+
+string Performer::correctQuery(const string &input,
+                               chrono::microseconds budget,
+                               vector<pair<string,string>> &rewrites,
+                               bool *cutShort) const {
+
+    rewrites.clear();
+    if(cutShort) *cutShort = false;
+    auto deadline = chrono::steady_clock::now() + budget;
+
+    stringstream ss(input);
+    string word;
+    string result;
+
+    while(ss >> word){
+        // Out of time: keep the remaining tokens as they are
+        if(chrono::steady_clock::now() < deadline){
+            string fixed = autoCorrect(word);
+            if(fixed != word){
+                rewrites.push_back({word, fixed});
+                word = fixed;
+            }
+        } else if(cutShort){
+            *cutShort = true;
+        }
+        if(!result.empty()) result += ' ';
+        result += word;
+    }
+
+    return result;
+}
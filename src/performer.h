@@ -2,19 +2,32 @@
 #include <string>
 #include <set>
 #include <map>
-#include <sqlite3.h>
+#include <vector>
+#include <chrono>
+
+#include "fuzzy_index.h"
 
 class Performer {
 public:
     Performer();
 
-    void   buildVocabulary(sqlite3* db);
+    void   buildVocabulary(const std::vector<std::string>& words);      // already split
+    bool   hasVocabulary() const { return !vocabulary.empty(); }
     double fuzzySimilarity(const std::string& a, const std::string& b);
-    std::string autoCorrect(const std::string& word);
+    std::string autoCorrect(const std::string& word) const;
     std::string normalizeQuery(const std::string& input);
 
+    // Token-level auto-correct of an already preprocessed query.
+    // Stops correcting once budget is spent; rewrites gets (from, to).
+    // cutShort (optional) tells whether tokens were left unchecked.
+    std::string correctQuery(const std::string& input,
+                             std::chrono::microseconds budget,
+                             std::vector<std::pair<std::string, std::string>>& rewrites,
+                             bool* cutShort = nullptr) const;
+
 private:
     std::set<std::string>        vocabulary;
+    FuzzyIndex                   fuzzyIndex;   // BK-tree over vocabulary
     std::map<std::string,std::string> synonymMap;
 
     void loadSynonyms();
@@ -0,0 +1,280 @@
+/*
+ * ============================================================
+ *  PRIMUS AI - Phrase Audio Cache
+ *  LRU in memory + optional mmap'ed disk store
+ * ============================================================
+ */
+
+#include "phrase_cache.h"
+#include "dsp_chain.h"
+
+#include <algorithm>
+#include <cstdio>
+#include <cstdlib>
+#include <cerrno>
+#include <cstring>
+#include <unistd.h>
+#include <fcntl.h>
+#include <dirent.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+
+using namespace std;
+
+/* ===== KEY ===== */
+
+string PhraseKey::encode() const {
+    char head[64];
+    snprintf(head, sizeof(head), "dsp%d|g%.3f|s%d|p%d|", DSP_VERSION, gain, speed, pitch);
+    return head + text;
+}
+
+uint64_t phraseHash(const string& s){
+    uint64_t h = 1469598103934665603ULL;
+    for(unsigned char c : s){
+        h ^= c;
+        h *= 1099511628211ULL;
+    }
+    return h;
+}
+
+// The full key is compared too, so collisions only cost a miss
+static uint64_t hashKey(const string& k){ return phraseHash(k); }
+
+CachedPhrase::~CachedPhrase(){
+    if(map) munmap(map, mapLen);
+}
+
+/* ===== DISK FORMAT =====
+   header | key bytes | pad to 8 | int16 PCM */
+
+struct DiskHeader {
+    char     magic[8];      // "PRIMUSPC"
+    uint32_t format;
+    uint32_t rate;
+    uint64_t samples;
+    uint32_t keyLen;
+    uint32_t reserved;
+};
+
+static const uint32_t DISK_FORMAT = 1;
+
+static size_t pcmOffset(size_t keyLen){
+    return (sizeof(DiskHeader) + keyLen + 7) & ~size_t(7);
+}
+
+/* ================================================================
+   PHRASE CACHE
+================================================================ */
+
+PhraseCache::PhraseCache(size_t maxBytes) : maxBytes(maxBytes) {}
+
+bool PhraseCache::setDirectory(const string& d, size_t maxDisk){
+    lock_guard<mutex> g(lock);
+    dir          = d;
+    maxDiskBytes = maxDisk;
+    counts.diskBytes = 0;
+    diskLru.clear();
+    diskIndex.clear();
+    if(dir.empty()) return true;
+
+    if(mkdir(dir.c_str(), 0755) != 0 && errno != EEXIST){
+        dir.clear();
+        return false;
+    }
+
+    // Files we wrote ("%016llx.pcm"), newest first
+    struct Found { time_t used; uint64_t h; size_t bytes; };
+    vector<Found> found;
+    if(DIR* dp = opendir(dir.c_str())){
+        while(dirent* e = readdir(dp)){
+            struct stat st;
+            string p = dir + "/" + e->d_name;
+            char*  end = nullptr;
+            uint64_t h = strtoull(e->d_name, &end, 16);
+            if(end == e->d_name + 16 && strcmp(end, ".pcm") == 0 && stat(p.c_str(), &st) == 0)
+                found.push_back({ st.st_mtime, h, (size_t)st.st_size });
+        }
+        closedir(dp);
+    }
+    sort(found.begin(), found.end(), [](const Found& a, const Found& b){ return a.used > b.used; });
+    for(auto& f : found){
+        if(diskIndex.count(f.h)) continue;
+        diskLru.push_back(f.h);
+        diskIndex[f.h] = { f.bytes, prev(diskLru.end()) };
+        counts.diskBytes += f.bytes;
+    }
+
+    // A smaller budget than last run: trim now
+    while(counts.diskBytes > maxDiskBytes && !diskLru.empty()){
+        uint64_t old = diskLru.back();
+        forgetDisk(old);
+        unlink(pathFor(old).c_str());
+    }
+    return true;
+}
+
+void PhraseCache::touchDisk(uint64_t h){
+    auto it = diskIndex.find(h);
+    if(it != diskIndex.end()) diskLru.splice(diskLru.begin(), diskLru, it->second.use);
+}
+
+// Out of the count and the order; the caller deals with the file
+void PhraseCache::forgetDisk(uint64_t h){
+    auto it = diskIndex.find(h);
+    if(it == diskIndex.end()) return;
+    counts.diskBytes -= it->second.bytes;
+    diskLru.erase(it->second.use);
+    diskIndex.erase(it);
+}
+
+string PhraseCache::pathFor(uint64_t h) const {
+    char name[24];
+    snprintf(name, sizeof(name), "%016llx.pcm", (unsigned long long)h);
+    return dir + "/" + name;
+}
+
+shared_ptr<const CachedPhrase> PhraseCache::load(uint64_t h, const string& key) const {
+    int fd = ::open(pathFor(h).c_str(), O_RDONLY | O_CLOEXEC);
+    if(fd < 0) return nullptr;
+
+    struct stat st;
+    void* base = MAP_FAILED;
+    if(fstat(fd, &st) == 0 && (size_t)st.st_size >= sizeof(DiskHeader))
+        base = mmap(nullptr, st.st_size, PROT_READ, MAP_SHARED, fd, 0);
+    ::close(fd);
+    if(base == MAP_FAILED) return nullptr;
+
+    auto p = make_shared<CachedPhrase>();
+    p->map    = base;                  // unmapped by ~CachedPhrase
+    p->mapLen = st.st_size;
+
+    DiskHeader hd;
+    memcpy(&hd, base, sizeof(hd));
+    const char* bytes = (const char*)base;
+    size_t off = pcmOffset(hd.keyLen);
+    if(memcmp(hd.magic, "PRIMUSPC", 8) != 0 || hd.format != DISK_FORMAT ||
+       off > p->mapLen || hd.samples > (p->mapLen - off) / sizeof(int16_t) ||
+       hd.keyLen != key.size() ||
+       memcmp(bytes + sizeof(DiskHeader), key.data(), key.size()) != 0)
+        return nullptr;
+
+    p->rate    = hd.rate;
+    p->pcm     = (const int16_t*)(bytes + off);
+    p->samples = hd.samples;
+    return p;
+}
+
+// Written to a temp name and renamed, so readers never see half a file.
+// Least recently used files go first when the store is full (a mapped
+// one stays readable until its phrase is released)
+void PhraseCache::store(uint64_t h, const string& key, const CachedPhrase& p){
+    size_t off  = pcmOffset(key.size());
+    size_t size = off + p.bytes();
+    if(size > maxDiskBytes) return;
+
+    // A file being overwritten no longer counts with its old size
+    forgetDisk(h);
+    while(counts.diskBytes + size > maxDiskBytes && !diskLru.empty()){
+        uint64_t old = diskLru.back();
+        forgetDisk(old);
+        unlink(pathFor(old).c_str());
+    }
+
+    string path = pathFor(h);
+    string tmp  = path + ".tmp";
+    int fd = ::open(tmp.c_str(), O_WRONLY | O_CREAT | O_TRUNC | O_CLOEXEC, 0644);
+    if(fd < 0) return;
+
+    vector<char> head(off, 0);
+    DiskHeader hd = {};
+    memcpy(hd.magic, "PRIMUSPC", 8);
+    hd.format  = DISK_FORMAT;
+    hd.rate    = p.rate;
+    hd.samples = p.samples;
+    hd.keyLen  = key.size();
+    memcpy(head.data(), &hd, sizeof(hd));
+    memcpy(head.data() + sizeof(hd), key.data(), key.size());
+
+    bool ok = ::write(fd, head.data(), off) == (ssize_t)off &&
+              ::write(fd, p.pcm, p.bytes()) == (ssize_t)p.bytes();
+    ::close(fd);
+    if(ok && rename(tmp.c_str(), path.c_str()) == 0){
+        diskLru.push_front(h);
+        diskIndex[h] = { size, diskLru.begin() };
+        counts.diskBytes += size;
+    } else {
+        // An older copy is no longer counted either
+        unlink(tmp.c_str());
+        unlink(path.c_str());
+    }
+}
+
+void PhraseCache::remember(uint64_t h, const string& key, shared_ptr<const CachedPhrase> p){
+    auto it = index.find(h);
+    if(it != index.end()){
+        counts.bytes -= it->second->phrase->bytes();
+        lru.erase(it->second);
+        index.erase(it);
+    }
+    lru.push_front({ key, p });
+    index[h] = lru.begin();
+    counts.bytes += p->bytes();
+
+    while(counts.bytes > maxBytes && lru.size() > 1){
+        Slot& old = lru.back();
+        counts.bytes -= old.phrase->bytes();
+        index.erase(hashKey(old.key));
+        lru.pop_back();
+    }
+    counts.entries = lru.size();
+}
+
+shared_ptr<const CachedPhrase> PhraseCache::find(const PhraseKey& k){
+    string   key = k.encode();
+    uint64_t h   = hashKey(key);
+
+    lock_guard<mutex> g(lock);
+    auto it = index.find(h);
+    if(it != index.end() && it->second->key == key){
+        lru.splice(lru.begin(), lru, it->second);
+        touchDisk(h);
+        counts.hits++;
+        return it->second->phrase;
+    }
+    if(!dir.empty()){
+        if(auto p = load(h, key)){
+            // mtime is the use order the next run starts from
+            touchDisk(h);
+            utimensat(AT_FDCWD, pathFor(h).c_str(), nullptr, 0);
+            if(p->bytes() <= maxBytes) remember(h, key, p);
+            counts.diskHits++;
+            return p;
+        }
+    }
+    counts.misses++;
+    return nullptr;
+}
+
+void PhraseCache::insert(const PhraseKey& k, int rate, vector<int16_t> pcm){
+    // One long answer must not flush every common phrase
+    if(pcm.empty() || pcm.size() * sizeof(int16_t) > maxBytes / 4) return;
+
+    auto p = make_shared<CachedPhrase>();
+    p->rate    = rate;
+    p->owned   = move(pcm);
+    p->pcm     = p->owned.data();
+    p->samples = p->owned.size();
+
+    string   key = k.encode();
+    uint64_t h   = hashKey(key);
+
+    lock_guard<mutex> g(lock);
+    remember(h, key, p);
+    if(!dir.empty()) store(h, key, *p);
+}
+
+PhraseCacheStats PhraseCache::stats() const {
+    lock_guard<mutex> g(lock);
+    return counts;
+}
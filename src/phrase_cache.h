@@ -0,0 +1,110 @@
+#pragma once
+#include <string>
+#include <vector>
+#include <list>
+#include <unordered_map>
+#include <memory>
+#include <mutex>
+#include <cstdint>
+#include <cstddef>
+
+/*
+ * Finished PCM (after the DSP chain) for sentences already spoken,
+ * keyed by text + voice parameters + DSP_VERSION.
+ *
+ * Memory: LRU bounded by total sample bytes.
+ * Disk (optional): one file per phrase, named by the key hash,
+ * written via rename and mmap'ed back on a memory miss, so common
+ * phrases survive a restart without going through espeak-ng again.
+ * Bounded too: the least recently used files make room for new ones
+ * (file mtimes carry the order across restarts).
+ */
+
+struct PhraseKey {
+    std::string text;
+    float       gain;
+    int         speed;
+    int         pitch;
+
+    std::string encode() const;    // canonical form, stored on disk too
+};
+
+struct CachedPhrase {
+    int            rate    = 0;
+    const int16_t* pcm     = nullptr;
+    size_t         samples = 0;
+
+    std::vector<int16_t> owned;    // rendered this run
+    void*          map     = nullptr;   // or loaded from disk
+    size_t         mapLen  = 0;
+    std::shared_ptr<const void> keep;   // or inside someone else's mapping
+
+    CachedPhrase() = default;
+    CachedPhrase(const CachedPhrase&) = delete;
+    CachedPhrase& operator=(const CachedPhrase&) = delete;
+    ~CachedPhrase();
+    size_t bytes() const { return samples * sizeof(int16_t); }
+};
+
+// FNV-1a 64 — cache keys and answer text fingerprints
+uint64_t phraseHash(const std::string& s);
+
+struct PhraseCacheStats {
+    size_t hits      = 0;   // served from memory
+    size_t diskHits  = 0;   // mapped from the disk store
+    size_t misses    = 0;
+    size_t entries   = 0;
+    size_t bytes     = 0;   // PCM held in memory (owned + mapped)
+    size_t diskBytes = 0;
+
+    double hitRate() const {
+        size_t all = hits + diskHits + misses;
+        return all ? double(hits + diskHits) / all : 0.0;
+    }
+};
+
+class PhraseCache {
+public:
+    explicit PhraseCache(size_t maxBytes = 16u << 20);
+
+    // Enables the disk store; creates dir if needed. Empty = memory only
+    bool setDirectory(const std::string& dir, size_t maxDiskBytes = 256u << 20);
+
+    // Counts a hit or a miss. The returned phrase stays valid after
+    // eviction for as long as the caller holds it.
+    std::shared_ptr<const CachedPhrase> find(const PhraseKey& key);
+    void insert(const PhraseKey& key, int rate, std::vector<int16_t> pcm);
+
+    PhraseCacheStats stats() const;
+
+private:
+    struct Slot {
+        std::string                         key;
+        std::shared_ptr<const CachedPhrase> phrase;
+    };
+
+    size_t maxBytes;
+    size_t maxDiskBytes = 0;
+    std::string dir;
+
+    mutable std::mutex lock;
+    std::list<Slot> lru;                           // front = most recent
+    std::unordered_map<uint64_t, std::list<Slot>::iterator> index;
+    PhraseCacheStats counts;
+
+    // Files in the disk store by key hash, front = most recent
+    struct DiskEntry {
+        size_t                        bytes;
+        std::list<uint64_t>::iterator use;
+    };
+    std::list<uint64_t>                     diskLru;
+    std::unordered_map<uint64_t, DiskEntry> diskIndex;
+
+    std::string pathFor(uint64_t h) const;
+    std::shared_ptr<const CachedPhrase> load(uint64_t h, const std::string& key) const;
+    void store(uint64_t h, const std::string& key, const CachedPhrase& p);
+    void touchDisk(uint64_t h);
+    void forgetDisk(uint64_t h);
+    void remember(uint64_t h, const std::string& key,
+                  std::shared_ptr<const CachedPhrase> p);
+};
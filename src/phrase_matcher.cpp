@@ -0,0 +1,155 @@
+/*
+ * ============================================================
+ *  PRIMUS AI - Phrase Matcher
+ *  Aho–Corasick DFA, leftmost-longest, word-boundary aware
+ * ============================================================
+ */
+
+#include "phrase_matcher.h"
+
+#include <algorithm>
+#include <queue>
+
+using namespace std;
+
+/* ===== WORD BOUNDARIES (UTF-8) ===== */
+
+static char32_t decodeAt(const string& s, size_t i){
+    unsigned char c = s[i];
+    if(c < 0x80) return c;
+    int extra = (c >= 0xF0) ? 3 : (c >= 0xE0) ? 2 : 1;
+    char32_t cp = c & (0x3F >> extra);
+    for(int k = 1; k <= extra && i + k < s.size(); k++)
+        cp = (cp << 6) | (s[i + k] & 0x3F);
+    return cp;
+}
+
+static bool isWordChar(char32_t cp){
+    if(cp < 0x80)  return (cp >= '0' && cp <= '9') ||
+                          (cp >= 'a' && cp <= 'z') ||
+                          (cp >= 'A' && cp <= 'Z');
+    if(cp == 0x964 || cp == 0x965) return false;           // । ॥
+    if(cp == 0xA0)                 return false;           // nbsp
+    if(cp >= 0x2000 && cp <= 0x206F) return false;         // general punctuation
+    return true;
+}
+
+// Word character immediately before byte offset pos?
+static bool wordBefore(const string& s, size_t pos){
+    if(pos == 0) return false;
+    size_t i = pos - 1;
+    while(i > 0 && ((unsigned char)s[i] & 0xC0) == 0x80) i--;
+    return isWordChar(decodeAt(s, i));
+}
+
+// Word character starting at byte offset pos?
+static bool wordAt(const string& s, size_t pos){
+    if(pos >= s.size()) return false;
+    return isWordChar(decodeAt(s, pos));
+}
+
+/* ================================================================
+   BUILD
+================================================================ */
+
+void PhraseMatcher::add(const string& key, int id){
+    if(!key.empty())
+        keys.push_back({key, id});
+}
+
+void PhraseMatcher::clear(){
+    keys.clear();
+    delta.clear();
+    output.clear();
+    dictLink.clear();
+    fill(begin(byteClass), end(byteClass), 0);
+    classes = 1;
+}
+
+void PhraseMatcher::compile(){
+
+    // Byte classes: only bytes that appear in some key get a column
+    fill(begin(byteClass), end(byteClass), 0);
+    classes = 1;
+    for(auto& k : keys)
+        for(unsigned char c : k.text)
+            if(byteClass[c] == 0) byteClass[c] = classes++;
+
+    // Trie
+    delta.assign(classes, -1);
+    output.assign(1, -1);
+    for(size_t ki = 0; ki < keys.size(); ki++){
+        int state = 0;
+        for(unsigned char c : keys[ki].text){
+            int32_t& next = delta[state * classes + byteClass[c]];
+            if(next < 0){
+                next = output.size();
+                output.push_back(-1);
+                delta.resize(delta.size() + classes, -1);
+            }
+            state = delta[state * classes + byteClass[c]];
+        }
+        if(output[state] < 0) output[state] = ki;   // first duplicate wins
+    }
+
+    // Failure links folded into the DFA, breadth first
+    size_t states = output.size();
+    vector<int32_t> fail(states, 0);
+    dictLink.assign(states, -1);
+    queue<int> bfs;
+
+    for(int c = 0; c < classes; c++){
+        int32_t& next = delta[c];
+        if(next < 0) next = 0;
+        else         bfs.push(next);
+    }
+    while(!bfs.empty()){
+        int s = bfs.front(); bfs.pop();
+        int f = fail[s];
+        dictLink[s] = (output[f] >= 0) ? f : dictLink[f];
+        for(int c = 0; c < classes; c++){
+            int32_t& next = delta[s * classes + c];
+            if(next < 0){
+                next = delta[f * classes + c];
+            } else {
+                fail[next] = delta[f * classes + c];
+                bfs.push(next);
+            }
+        }
+    }
+}
+
+/* ================================================================
+   FIND ALL — leftmost-longest, non-overlapping
+================================================================ */
+
+void PhraseMatcher::findAll(const string& text, vector<PhraseMatch>& out) const {
+    out.clear();
+    if(keys.empty()) return;
+
+    // 1. Every key occurrence that sits on word boundaries
+    int state = 0;
+    for(size_t j = 0; j < text.size(); j++){
+        state = delta[state * classes + byteClass[(unsigned char)text[j]]];
+        int t = (output[state] >= 0) ? state : dictLink[state];
+        for(; t >= 0; t = dictLink[t]){
+            const Key& k = keys[output[t]];
+            size_t start = j + 1 - k.text.size();
+            if(wordBefore(text, start) || wordAt(text, j + 1)) continue;
+            out.push_back({k.id, start, k.text.size()});
+        }
+    }
+    if(out.size() < 2) return;
+
+    // 2. Leftmost first, longest first at the same start; drop overlaps
+    sort(out.begin(), out.end(), [](const PhraseMatch& a, const PhraseMatch& b){
+        return a.start != b.start ? a.start < b.start : a.length > b.length;
+    });
+    size_t kept = 0, end = 0;
+    for(auto& m : out){
+        if(kept > 0 && m.start < end) continue;
+        out[kept++] = m;
+        end = m.start + m.length;
+    }
+    out.resize(kept);
+}
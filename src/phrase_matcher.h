@@ -0,0 +1,42 @@
+#pragma once
+#include <string>
+#include <vector>
+#include <cstdint>
+
+/*
+ * Aho–Corasick phrase matcher over UTF-8 bytes.
+ * Keys are compiled into a dense DFA (byte classes × states), so a
+ * scan is one table lookup per input byte. Matches are reported
+ * leftmost-longest, non-overlapping, and only when they start and
+ * end on a word boundary — "ai" does not fire inside "main", nor
+ * "आप" inside "आपका".
+ */
+
+struct PhraseMatch {
+    int    id;      // value passed to add()
+    size_t start;   // byte offset into the text
+    size_t length;  // byte length of the key
+};
+
+class PhraseMatcher {
+public:
+    void add(const std::string& key, int id);
+    void compile();
+    void clear();
+
+    bool   empty()   const { return keys.empty(); }
+    size_t size()    const { return keys.size(); }
+
+    // Fills out (cleared first); reuses its capacity across calls
+    void findAll(const std::string& text, std::vector<PhraseMatch>& out) const;
+
+private:
+    struct Key { std::string text; int id; };
+
+    std::vector<Key>      keys;
+    uint8_t               byteClass[256] = {};
+    int                   classes = 1;       // class 0 = byte in no key
+    std::vector<int32_t>  delta;             // state * classes + class → state
+    std::vector<int32_t>  output;            // state → key index ending here, -1
+    std::vector<int32_t>  dictLink;          // state → next state with output, -1
+};
@@ -0,0 +1,147 @@
+/*
+ * ============================================================
+ *  PRIMUS AI v2.0 — Answer Pre-renderer
+ *  Usage: ./primus_prerender knowledge.db answer_audio.bin
+ *           [--limit N] [--ids FILE] [--adpcm] [-j N]
+ *
+ *  Speaks every knowledge answer through the same TTS path the
+ *  assistant uses (espeak-ng → DSP chain) into memory and writes
+ *  the results as one blob store keyed by knowledge.id.
+ *
+ *  --ids FILE   knowledge ids, most asked first, one per line
+ *  --limit N    only the first N answers (by --ids order, else id)
+ *  --adpcm      IMA ADPCM, 4x smaller than PCM
+ *  -j N         parallel espeak-ng workers (default 2)
+ * ============================================================
+ */
+
+#include "tts.h"
+#include "answer_audio.h"
+
+#include <sqlite3.h>
+#include <iostream>
+#include <fstream>
+#include <string>
+#include <vector>
+#include <unordered_map>
+#include <thread>
+#include <atomic>
+#include <mutex>
+#include <cstdlib>
+
+using namespace std;
+
+// Same voice as main.cpp
+static const AnswerVoice VOICE = { 1.0f, 130, 22 };
+
+struct Job {
+    long long id;
+    string    answer;
+};
+
+static bool loadJobs(const string& dbPath, const string& idsFile, size_t limit, vector<Job>& jobs){
+    sqlite3* db = nullptr;
+    if(sqlite3_open_v2(dbPath.c_str(), &db, SQLITE_OPEN_READONLY, nullptr) != SQLITE_OK){
+        cerr << "DB Error: " << sqlite3_errmsg(db) << "\n";
+        sqlite3_close(db);
+        return false;
+    }
+    sqlite3_stmt* stmt = nullptr;
+    sqlite3_prepare_v2(db, "SELECT id, answer FROM knowledge ORDER BY id;", -1, &stmt, nullptr);
+    vector<Job> all;
+    while(stmt && sqlite3_step(stmt) == SQLITE_ROW)
+        all.push_back({ sqlite3_column_int64(stmt, 0),
+                        (const char*)sqlite3_column_text(stmt, 1) });
+    sqlite3_finalize(stmt);
+    sqlite3_close(db);
+
+    if(idsFile.empty()){
+        jobs = move(all);
+    } else {
+        unordered_map<long long, size_t> at;
+        for(size_t i = 0; i < all.size(); i++) at[all[i].id] = i;
+        ifstream in(idsFile);
+        long long id;
+        while(in >> id){
+            auto it = at.find(id);
+            if(it == at.end()) continue;
+            jobs.push_back(all[it->second]);
+            at.erase(it);                  // first mention wins
+        }
+    }
+    if(limit > 0 && jobs.size() > limit) jobs.resize(limit);
+    return true;
+}
+
+int main(int argc, char** argv){
+    if(argc < 3){
+        cerr << "Usage: " << argv[0] << " knowledge.db answer_audio.bin"
+                " [--limit N] [--ids FILE] [--adpcm] [-j N]\n";
+        return 2;
+    }
+    string dbPath = argv[1], outPath = argv[2], idsFile;
+    size_t limit   = 0;
+    int    workers = 2;
+    AnswerAudio::Encoding enc = AnswerAudio::PCM16;
+    for(int i = 3; i < argc; i++){
+        string arg = argv[i];
+        if(arg == "--limit" && i + 1 < argc)    limit   = atol(argv[++i]);
+        else if(arg == "--ids" && i + 1 < argc) idsFile = argv[++i];
+        else if(arg == "--adpcm")               enc     = AnswerAudio::IMA_ADPCM;
+        else if(arg == "-j" && i + 1 < argc)    workers = max(1, atoi(argv[++i]));
+    }
+
+    vector<Job> jobs;
+    if(!loadJobs(dbPath, idsFile, limit, jobs)) return 1;
+    cerr << "Rendering " << jobs.size() << " answers with " << workers << " workers...\n";
+
+    vector<AnswerAudio::Rendered> done;
+    atomic<size_t> next{0};
+    mutex          doneLock;
+    int            rate = 0;
+    size_t         failed = 0;
+
+    auto work = [&]{
+        TTS tts(VOICE.gain, VOICE.speed, VOICE.pitch);
+        auto sink = make_unique<BufferSink>();
+        BufferSink* buf = sink.get();
+        tts.setSink(move(sink));
+        tts.setCache(nullptr);
+
+        for(size_t i; (i = next++) < jobs.size(); ){
+            tts.speak(jobs[i].answer);
+            tts.flush();
+
+            lock_guard<mutex> g(doneLock);
+            if(buf->audio.empty()){
+                failed++;
+                continue;
+            }
+            rate = buf->rate;
+            done.push_back({ jobs[i].id, phraseHash(jobs[i].answer), move(buf->audio) });
+            buf->audio.clear();         // the sink keeps audio across reopens
+            if(done.size() % 100 == 0)
+                cerr << "  " << done.size() << " / " << jobs.size() << "\n";
+        }
+    };
+    vector<thread> pool;
+    for(int w = 0; w < workers; w++) pool.emplace_back(work);
+    for(auto& t : pool) t.join();
+
+    if(done.empty()){
+        cerr << "Nothing rendered — is espeak-ng installed?\n";
+        return 1;
+    }
+    size_t samples = 0;
+    for(auto& r : done) samples += r.pcm.size();
+
+    if(!AnswerAudio::write(outPath, VOICE, rate, done, enc)){
+        cerr << "Cannot write " << outPath << "\n";
+        return 1;
+    }
+    cerr << "✅ " << done.size() << " answers, " << samples / rate / 60 << " min of audio"
+         << (enc == AnswerAudio::IMA_ADPCM ? " (ADPCM)" : " (PCM)") << " → " << outPath;
+    if(failed) cerr << ", " << failed << " failed";
+    cerr << "\n";
+    return 0;
+}
@@ -0,0 +1,130 @@
+/*
+ * ============================================================
+ *  PRIMUS AI - Session Manager
+ *  Per-speaker conversation contexts, idle expiry, LRU memory cap
+ * ============================================================
+ */
+
+#include "session_manager.h"
+
+using namespace std;
+
+struct SessionManager::Entry {
+    string            id;
+    Session           session;
+    mutex             busy;          // held by the Lease
+    size_t            bytes = 0;     // as measured at the last release
+    int               users = 0;     // leases handed out, under manager lock
+    Clock::time_point lastUsed;
+};
+
+SessionManager::SessionManager(SessionOptions o) : opts(o) {}
+
+/* ================================================================
+   LEASE
+================================================================ */
+
+SessionManager::Lease::Lease(SessionManager* m, shared_ptr<Entry> e)
+    : owner(m), entry(move(e)), hold(entry->busy) {}
+
+SessionManager::Lease::Lease(Lease&& o) noexcept
+    : owner(o.owner), entry(move(o.entry)), hold(move(o.hold)) {}
+
+SessionManager::Lease::~Lease(){
+    if(!entry) return;
+    size_t bytes = entry->session.memoryBytes();   // still ours to read
+    hold.unlock();
+    owner->release(*entry, bytes);
+}
+
+Session& SessionManager::Lease::operator*()  const { return entry->session; }
+Session* SessionManager::Lease::operator->() const { return &entry->session; }
+
+/* ================================================================
+   ACQUIRE / RELEASE
+================================================================ */
+
+SessionManager::Lease SessionManager::acquire(const string& id){
+    shared_ptr<Entry> e;
+    {
+        lock_guard<mutex> g(lock);
+        Clock::time_point now = Clock::now();
+        expireIdle(now);
+
+        auto it = index.find(id);
+        if(it != index.end()){
+            lru.splice(lru.begin(), lru, it->second);
+        } else {
+            auto fresh = make_shared<Entry>();
+            fresh->id    = id;
+            fresh->bytes = fresh->session.memoryBytes() + id.size();
+            counts.bytes += fresh->bytes;
+            counts.created++;
+            lru.push_front(move(fresh));
+            index[id] = lru.begin();
+        }
+        e = lru.front();
+        e->users++;
+        e->lastUsed = now;
+    }
+    // Lock the session outside the manager lock: a slow query on one
+    // session must not stall lookups of the others
+    return Lease(this, move(e));
+}
+
+void SessionManager::release(Entry& e, size_t bytes){
+    lock_guard<mutex> g(lock);
+    bytes += e.id.size();
+    counts.bytes += bytes;
+    counts.bytes -= e.bytes;
+    e.bytes    = bytes;
+    e.users--;
+    e.lastUsed = Clock::now();
+    enforceCap();
+}
+
+bool SessionManager::erase(const string& id){
+    lock_guard<mutex> g(lock);
+    auto it = index.find(id);
+    if(it == index.end() || (*it->second)->users > 0) return false;
+    drop(it->second);
+    return true;
+}
+
+SessionStats SessionManager::stats() const {
+    lock_guard<mutex> g(lock);
+    SessionStats s = counts;
+    s.sessions = index.size();
+    return s;
+}
+
+/* ================================================================
+   EXPIRY / EVICTION (manager lock held)
+================================================================ */
+
+void SessionManager::drop(list<shared_ptr<Entry>>::iterator it){
+    counts.bytes -= (*it)->bytes;
+    index.erase((*it)->id);
+    lru.erase(it);
+}
+
+void SessionManager::expireIdle(Clock::time_point now){
+    // Oldest first; stop at the first session still in use or fresh
+    while(!lru.empty()){
+        auto it = prev(lru.end());
+        if((*it)->users > 0 || now - (*it)->lastUsed < opts.idleTimeout) break;
+        drop(it);
+        counts.expired++;
+    }
+}
+
+void SessionManager::enforceCap(){
+    auto it = lru.end();
+    while(counts.bytes > opts.maxBytes && it != lru.begin()){
+        --it;
+        if((*it)->users > 0) continue;
+        auto victim = it++;
+        drop(victim);
+        counts.evicted++;
+    }
+}
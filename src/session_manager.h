@@ -0,0 +1,83 @@
+#pragma once
+#include <string>
+#include <list>
+#include <unordered_map>
+#include <memory>
+#include <mutex>
+#include <chrono>
+#include <cstddef>
+
+#include "hindi_ai.h"
+
+/*
+ * Conversation contexts by session id (room, speaker, client).
+ *
+ * Sessions are created on first use and leave when idle longer than
+ * idleTimeout, or — least recently used first — when all of them
+ * together exceed maxBytes. A Lease locks its session, so two queries
+ * for the same id run one after the other; leased sessions are never
+ * evicted.
+ */
+
+struct SessionOptions {
+    std::chrono::seconds idleTimeout { 600 };
+    size_t               maxBytes    = 4u << 20;
+};
+
+struct SessionStats {
+    size_t sessions = 0;
+    size_t bytes    = 0;
+    size_t created  = 0;
+    size_t expired  = 0;   // idle timeout
+    size_t evicted  = 0;   // memory cap
+};
+
+class SessionManager {
+    struct Entry;
+
+public:
+    explicit SessionManager(SessionOptions opts = {});
+
+    class Lease {
+    public:
+        Lease(Lease&& o) noexcept;
+        Lease(const Lease&)            = delete;
+        Lease& operator=(const Lease&) = delete;
+        ~Lease();
+
+        Session& operator*()  const;
+        Session* operator->() const;
+
+    private:
+        friend class SessionManager;
+        Lease(SessionManager* m, std::shared_ptr<Entry> e);
+
+        SessionManager*              owner;
+        std::shared_ptr<Entry>       entry;
+        std::unique_lock<std::mutex> hold;
+    };
+
+    // Creates the session on first use; blocks while another query
+    // holds the same id
+    Lease acquire(const std::string& id);
+
+    // Drops a session unless it is leased; true if it was removed
+    bool erase(const std::string& id);
+
+    SessionStats stats() const;
+
+private:
+    using Clock = std::chrono::steady_clock;
+
+    SessionOptions opts;
+
+    mutable std::mutex lock;
+    std::list<std::shared_ptr<Entry>> lru;     // front = most recent
+    std::unordered_map<std::string, std::list<std::shared_ptr<Entry>>::iterator> index;
+    SessionStats counts;
+
+    void release(Entry& e, size_t bytes);
+    void expireIdle(Clock::time_point now);
+    void enforceCap();
+    void drop(std::list<std::shared_ptr<Entry>>::iterator it);
+};
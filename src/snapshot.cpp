@@ -0,0 +1,63 @@
+/*
+ * ============================================================
+ *  PRIMUS AI v2.0 — Knowledge Snapshot Compiler
+ *  Usage: ./primus_snapshot knowledge.db knowledge.snap
+ *
+ *  Compiles the keyword index tables into one file that
+ *  hindi_ai maps at startup (--snapshot). Run again after
+ *  changing the knowledge table; until then the assistant
+ *  notices the snapshot is stale and builds from SQLite.
+ * ============================================================
+ */
+
+#include "knowledge_snapshot.h"
+#include "enhancer.h"
+
+#include <sqlite3.h>
+#include <iostream>
+#include <string>
+#include <chrono>
+
+using namespace std;
+
+int main(int argc, char** argv){
+    if(argc < 3){
+        cerr << "Usage: " << argv[0] << " knowledge.db knowledge.snap\n";
+        return 2;
+    }
+    string dbPath = argv[1], out = argv[2];
+
+    // Writable: the version table and its triggers may not exist yet
+    sqlite3* db = nullptr;
+    if(sqlite3_open_v2(dbPath.c_str(), &db, SQLITE_OPEN_READWRITE, nullptr) != SQLITE_OK){
+        cerr << "DB Error: " << sqlite3_errmsg(db) << "\n";
+        sqlite3_close(db);
+        return 1;
+    }
+    sqlite3_busy_timeout(db, 5000);
+
+    auto t0 = chrono::steady_clock::now();
+    // Questions normalized exactly as hindi_ai does (see HindiAI)
+    Enhancer enhancer;
+    size_t rows = 0;
+    bool ok = KnowledgeSnapshot::compile(db, out,
+                                         [&](const string& q){ return enhancer.preprocess(q); },
+                                         enhancer.fingerprint(), &rows);
+    sqlite3_close(db);
+    if(!ok){
+        cerr << "Snapshot write failed: " << out << "\n";
+        return 1;
+    }
+    double ms = chrono::duration<double, milli>(chrono::steady_clock::now() - t0).count();
+
+    KnowledgeSnapshot snap;
+    if(!snap.open(out)){
+        cerr << "Snapshot written but unreadable: " << out << "\n";
+        return 1;
+    }
+    const KeywordTables& t = snap.tables();
+    cout << "✅ " << out << ": " << rows << " rows, " << t.wordCount << " words, "
+         << t.categoryCount << " categories, " << snap.bytes() / 1024 << " KiB ("
+         << (int)ms << " ms), version " << snap.source().version << "\n";
+    return 0;
+}
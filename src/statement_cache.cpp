@@ -0,0 +1,46 @@
+/*
+ * ============================================================
+ *  PRIMUS AI - Statement Cache
+ *  Prepare once, reset + rebind per query
+ * ============================================================
+ */
+
+#include "statement_cache.h"
+
+using namespace std;
+
+StatementCache::~StatementCache(){
+    finalizeAll();
+}
+
+int StatementCache::prepare(sqlite3* db, const char* sql){
+    if(!db) return -1;
+
+    sqlite3_stmt* stmt = nullptr;
+    prepares.fetch_add(1, memory_order_relaxed);
+    if(sqlite3_prepare_v3(db, sql, -1, SQLITE_PREPARE_PERSISTENT,
+                          &stmt, nullptr) != SQLITE_OK)
+    {
+        sqlite3_finalize(stmt);
+        return -1;
+    }
+    stmts.push_back(stmt);
+    return (int)stmts.size() - 1;
+}
+
+void StatementCache::finalizeAll(){
+    for(auto* s : stmts) sqlite3_finalize(s);
+    stmts.clear();
+}
+
+StatementCache::Lease StatementCache::acquire(int slot){
+    if(slot < 0 || slot >= (int)stmts.size()) return Lease(nullptr);
+    executions.fetch_add(1, memory_order_relaxed);
+    return Lease(stmts[slot]);
+}
+
+StatementCache::Lease::~Lease(){
+    if(!stmt) return;
+    sqlite3_reset(stmt);
+    sqlite3_clear_bindings(stmt);
+}
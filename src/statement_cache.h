@@ -0,0 +1,50 @@
+#pragma once
+#include <vector>
+#include <atomic>
+#include <sqlite3.h>
+
+/*
+ * Prepared statements compiled once per connection.
+ * acquire() hands out a statement and counts one execution; the
+ * Lease resets it and clears its bindings when it goes out of
+ * scope, so no read transaction stays open between queries.
+ */
+
+class StatementCache {
+public:
+    StatementCache() = default;
+    ~StatementCache();
+
+    StatementCache(const StatementCache&)            = delete;
+    StatementCache& operator=(const StatementCache&) = delete;
+
+    // Compile sql on db; returns a slot id, or -1 if prepare failed
+    int  prepare(sqlite3* db, const char* sql);
+    void finalizeAll();
+
+    class Lease {
+    public:
+        explicit Lease(sqlite3_stmt* s) : stmt(s) {}
+        ~Lease();
+        Lease(Lease&& o) noexcept : stmt(o.stmt) { o.stmt = nullptr; }
+        Lease(const Lease&)            = delete;
+        Lease& operator=(const Lease&) = delete;
+
+        sqlite3_stmt* get() const { return stmt; }
+        explicit operator bool() const { return stmt != nullptr; }
+
+    private:
+        sqlite3_stmt* stmt;
+    };
+
+    Lease acquire(int slot);
+
+    long long prepareCount()   const { return prepares; }
+    long long executionCount() const { return executions; }
+
+private:
+    std::vector<sqlite3_stmt*> stmts;
+    // Atomic so totals can be read while another thread runs queries
+    std::atomic<long long> prepares   { 0 };
+    std::atomic<long long> executions { 0 };
+};
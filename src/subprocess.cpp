@@ -0,0 +1,88 @@
+/*
+ * ============================================================
+ *  PRIMUS AI - Subprocess
+ *  posix_spawnp + pipe, replaces system() for audio tools
+ * ============================================================
+ */
+
+#include "subprocess.h"
+
+#include <spawn.h>
+#include <unistd.h>
+#include <fcntl.h>
+#include <sys/wait.h>
+#include <csignal>
+
+using namespace std;
+
+extern char** environ;
+
+// childFd = the child's end (0 = stdin, 1 = stdout)
+static bool spawnWithPipe(const vector<string>& argv, int childFd, Subprocess& out){
+    out = Subprocess();
+    if(argv.empty()) return false;
+
+    int fds[2];
+    if(pipe2(fds, O_CLOEXEC) != 0) return false;
+
+    int ours   = (childFd == 0) ? fds[1] : fds[0];
+    int theirs = (childFd == 0) ? fds[0] : fds[1];
+
+    posix_spawn_file_actions_t fa;
+    posix_spawn_file_actions_init(&fa);
+    posix_spawn_file_actions_adddup2(&fa, theirs, childFd);
+    posix_spawn_file_actions_addopen(&fa, 2, "/dev/null", O_WRONLY, 0);
+
+    // The child starts with nothing blocked and default handlers, not
+    // with the mask main() sets for its signal thread
+    posix_spawnattr_t attr;
+    posix_spawnattr_init(&attr);
+    sigset_t none, reset;
+    sigemptyset(&none);
+    sigemptyset(&reset);
+    sigaddset(&reset, SIGPIPE);
+    sigaddset(&reset, SIGUSR1);
+    sigaddset(&reset, SIGHUP);
+    posix_spawnattr_setsigmask(&attr, &none);
+    posix_spawnattr_setsigdefault(&attr, &reset);
+    posix_spawnattr_setflags(&attr, POSIX_SPAWN_SETSIGMASK | POSIX_SPAWN_SETSIGDEF);
+
+    vector<char*> args;
+    for(auto& a : argv) args.push_back(const_cast<char*>(a.c_str()));
+    args.push_back(nullptr);
+
+    pid_t pid;
+    int rc = posix_spawnp(&pid, args[0], &fa, &attr, args.data(), environ);
+    posix_spawn_file_actions_destroy(&fa);
+    posix_spawnattr_destroy(&attr);
+    close(theirs);
+
+    if(rc != 0){
+        close(ours);
+        return false;
+    }
+    out.pid = pid;
+    out.fd  = ours;
+    return true;
+}
+
+bool spawnReader(const vector<string>& argv, Subprocess& out){
+    return spawnWithPipe(argv, 1, out);
+}
+
+bool spawnWriter(const vector<string>& argv, Subprocess& out){
+    return spawnWithPipe(argv, 0, out);
+}
+
+int finish(Subprocess& p){
+    if(p.fd >= 0) close(p.fd);
+    int status = -1;
+    if(p.pid > 0) waitpid(p.pid, &status, 0);
+    p = Subprocess();
+    return status;
+}
+
+void terminate(Subprocess& p){
+    if(p.pid > 0) kill(p.pid, SIGTERM);
+    finish(p);
+}
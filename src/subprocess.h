@@ -0,0 +1,25 @@
+#pragma once
+#include <string>
+#include <vector>
+#include <sys/types.h>
+
+/*
+ * Child process with one pipe end, spawned without a shell, so
+ * text never needs quoting. The child's stderr goes to /dev/null.
+ */
+
+struct Subprocess {
+    pid_t pid = -1;
+    int   fd  = -1;    // child's stdout (reader) or stdin (writer)
+
+    bool running() const { return pid > 0; }
+};
+
+bool spawnReader(const std::vector<std::string>& argv, Subprocess& out);
+bool spawnWriter(const std::vector<std::string>& argv, Subprocess& out);
+
+// Close our pipe end and reap the child; returns its exit status
+int  finish(Subprocess& p);
+
+// SIGTERM the child, then finish()
+void terminate(Subprocess& p);
@@ -0,0 +1,254 @@
+/*
+ * ============================================================
+ *  PRIMUS AI - Trace
+ *  Lock-free span ring and per-stage latency histograms
+ * ============================================================
+ */
+
+#include "trace.h"
+
+#include <algorithm>
+#include <cmath>
+#include <cstring>
+#include <fstream>
+#include <iomanip>
+#include <mutex>
+#include <unistd.h>
+
+using namespace std;
+
+static const size_t   RING_SIZE   = 1 << 14;    // spans kept for the Chrome trace
+static const uint32_t MAX_STAGES  = 64;
+static const uint32_t MAX_THREADS = 256;        // named ones, that is
+static const int      BUCKETS     = 252;        // 4 per power of two up to 2^63 ns
+
+/* ===== STAGES ===== */
+
+// No initializers: zero-filled before any TraceStage in another file
+// registers, whatever the order of static construction
+struct StageSlot {
+    const char*      name;
+    atomic<uint64_t> sumNs, maxNs;
+    atomic<uint32_t> buckets[BUCKETS];
+};
+
+static StageSlot        stages[MAX_STAGES];
+static atomic<uint32_t> stageCount{0};
+static mutex            registry;
+
+// Same name, same stage: a TraceStage may be defined in several files
+TraceStage::TraceStage(const char* name) : label(name), index(MAX_STAGES) {
+    lock_guard<mutex> g(registry);
+    uint32_t n = stageCount.load(memory_order_relaxed);
+    for(uint32_t i = 0; i < n; i++){
+        if(strcmp(stages[i].name, name) == 0){
+            index = i;
+            return;
+        }
+    }
+    if(n == MAX_STAGES) return;                  // untraced
+    stages[n].name = name;
+    index = n;
+    stageCount.store(n + 1, memory_order_release);
+}
+
+/* ===== RING =====
+   A slot's seq is its claim number + 1 once written and 0 while a
+   writer is inside; readers keep a slot only if seq is the same
+   before and after copying it. */
+
+struct Slot {
+    atomic<uint64_t> seq;
+    atomic<uint64_t> start, duration;
+    atomic<uint32_t> stage, thread;
+};
+
+static Slot                ring[RING_SIZE];
+static atomic<uint64_t>    head{0};
+static atomic<uint64_t>    epoch{0};            // first traceEnable(true)
+static atomic<const char*> threadNames[MAX_THREADS];
+static atomic<uint32_t>    nextThread{1};
+
+static uint32_t threadId(){
+    thread_local uint32_t id = nextThread.fetch_add(1, memory_order_relaxed);
+    return id;
+}
+
+// 0-3 exact, then 4 linear steps per power of two
+static int bucketOf(uint64_t ns){
+    if(ns < 4) return (int)ns;
+    int e = 63 - __builtin_clzll(ns);
+    return 4 * (e - 1) + (int)((ns >> (e - 2)) & 3);
+}
+
+static double bucketLow(int b){
+    if(b < 4) return b;
+    int e = b / 4 + 1;
+    return ldexp(4 + b % 4, e - 2);
+}
+
+void traceRecord(const TraceStage& stage, uint64_t startNs, uint64_t endNs){
+    uint32_t id = stage.id();
+    if(id >= MAX_STAGES) return;
+    uint64_t ns = endNs > startNs ? endNs - startNs : 0;
+
+    StageSlot& st = stages[id];
+    st.sumNs.fetch_add(ns, memory_order_relaxed);
+    st.buckets[bucketOf(ns)].fetch_add(1, memory_order_relaxed);
+    uint64_t seen = st.maxNs.load(memory_order_relaxed);
+    while(ns > seen && !st.maxNs.compare_exchange_weak(seen, ns, memory_order_relaxed)){}
+
+    uint64_t n = head.fetch_add(1, memory_order_relaxed);
+    Slot& s = ring[n & (RING_SIZE - 1)];
+    s.seq.store(0, memory_order_relaxed);
+    atomic_thread_fence(memory_order_release);
+    s.start.store(startNs, memory_order_relaxed);
+    s.duration.store(ns, memory_order_relaxed);
+    s.stage.store(id, memory_order_relaxed);
+    s.thread.store(threadId(), memory_order_relaxed);
+    s.seq.store(n + 1, memory_order_release);
+}
+
+void traceEnable(bool on){
+    if(on){
+        uint64_t none = 0;
+        epoch.compare_exchange_strong(none, traceNow());
+    }
+    traceOn.store(on, memory_order_relaxed);
+}
+
+void traceNameThread(const char* name){
+    uint32_t id = threadId();
+    if(id < MAX_THREADS) threadNames[id].store(name, memory_order_relaxed);
+}
+
+/* ================================================================
+   SUMMARY — percentiles from the histograms
+================================================================ */
+
+// Middle of the bucket holding the q-th span, never above the maximum
+static double percentileUs(const uint32_t* counts, uint64_t total, double q, double maxNs){
+    uint64_t rank = max<uint64_t>(1, (uint64_t)ceil(q * total));
+    uint64_t seen = 0;
+    for(int b = 0; b < BUCKETS; b++){
+        seen += counts[b];
+        if(seen >= rank){
+            double mid = b + 1 < BUCKETS ? (bucketLow(b) + bucketLow(b + 1)) / 2 : bucketLow(b);
+            return min(mid, maxNs) / 1000;
+        }
+    }
+    return maxNs / 1000;
+}
+
+vector<TraceStageStats> traceStats(){
+    vector<TraceStageStats> out;
+    uint32_t n = stageCount.load(memory_order_acquire);
+    uint32_t counts[BUCKETS];
+    for(uint32_t i = 0; i < n; i++){
+        StageSlot& st = stages[i];
+        uint64_t total = 0;
+        for(int b = 0; b < BUCKETS; b++)
+            total += counts[b] = st.buckets[b].load(memory_order_relaxed);
+        if(total == 0) continue;
+
+        double maxNs = st.maxNs.load(memory_order_relaxed);
+        TraceStageStats s;
+        s.stage  = st.name;
+        s.count  = total;
+        s.meanUs = st.sumNs.load(memory_order_relaxed) / 1000.0 / total;
+        s.p50Us  = percentileUs(counts, total, 0.50, maxNs);
+        s.p95Us  = percentileUs(counts, total, 0.95, maxNs);
+        s.p99Us  = percentileUs(counts, total, 0.99, maxNs);
+        s.maxUs  = maxNs / 1000;
+        out.push_back(s);
+    }
+    return out;
+}
+
+TraceTotals traceTotals(){
+    TraceTotals t;
+    t.spans       = head.load(memory_order_relaxed);
+    t.overwritten = t.spans > RING_SIZE ? t.spans - RING_SIZE : 0;
+    return t;
+}
+
+/* ================================================================
+   DUMPS — written to a temp name and renamed
+================================================================ */
+
+static bool finish(ofstream& out, const string& tmp, const string& path){
+    out.close();
+    if(out && rename(tmp.c_str(), path.c_str()) == 0) return true;
+    unlink(tmp.c_str());
+    return false;
+}
+
+bool traceDumpJson(const string& path){
+    string tmp = path + ".tmp";
+    ofstream out(tmp);
+    if(!out) return false;
+
+    TraceTotals t = traceTotals();
+    out << fixed << setprecision(1)
+        << "{\n  \"spans\": " << t.spans << ",\n  \"overwritten\": " << t.overwritten
+        << ",\n  \"stages\": [";
+    bool first = true;
+    for(auto& s : traceStats()){
+        out << (first ? "\n" : ",\n")
+            << "    { \"stage\": \"" << s.stage << "\", \"count\": " << s.count
+            << ", \"mean_us\": " << s.meanUs << ", \"p50_us\": " << s.p50Us
+            << ", \"p95_us\": " << s.p95Us << ", \"p99_us\": " << s.p99Us
+            << ", \"max_us\": " << s.maxUs << " }";
+        first = false;
+    }
+    out << "\n  ]\n}\n";
+    return finish(out, tmp, path);
+}
+
+bool traceDumpChrome(const string& path){
+    struct Span { uint64_t start, duration; uint32_t stage, thread; };
+    vector<Span> spans;
+    spans.reserve(RING_SIZE);
+    for(Slot& s : ring){
+        uint64_t before = s.seq.load(memory_order_acquire);
+        if(before == 0) continue;
+        Span sp = { s.start.load(memory_order_relaxed), s.duration.load(memory_order_relaxed),
+                    s.stage.load(memory_order_relaxed), s.thread.load(memory_order_relaxed) };
+        atomic_thread_fence(memory_order_acquire);
+        if(s.seq.load(memory_order_relaxed) == before) spans.push_back(sp);
+    }
+    sort(spans.begin(), spans.end(), [](const Span& a, const Span& b){ return a.start < b.start; });
+
+    string tmp = path + ".tmp";
+    ofstream out(tmp);
+    if(!out) return false;
+
+    int      pid  = getpid();
+    uint64_t zero = epoch.load(memory_order_relaxed);
+    uint32_t named = min(nextThread.load(memory_order_relaxed), MAX_THREADS);
+    uint32_t known = stageCount.load(memory_order_acquire);
+    out << fixed << setprecision(3) << "{\"displayTimeUnit\":\"ms\",\"traceEvents\":[\n";
+    bool first = true;
+    for(uint32_t id = 1; id < named; id++){
+        const char* name = threadNames[id].load(memory_order_relaxed);
+        if(!name) continue;
+        out << (first ? "" : ",\n")
+            << "{\"name\":\"thread_name\",\"ph\":\"M\",\"pid\":" << pid << ",\"tid\":" << id
+            << ",\"args\":{\"name\":\"" << name << "\"}}";
+        first = false;
+    }
+    for(auto& sp : spans){
+        if(sp.stage >= known) continue;
+        const char* name = stages[sp.stage].name;
+        const char* dot  = strchr(name, '.');
+        out << (first ? "" : ",\n")
+            << "{\"name\":\"" << name << "\",\"cat\":\""
+            << string(name, dot ? dot - name : strlen(name))
+            << "\",\"ph\":\"X\",\"ts\":" << (sp.start >= zero ? sp.start - zero : 0) / 1000.0
+            << ",\"dur\":" << sp.duration / 1000.0
+            << ",\"pid\":" << pid << ",\"tid\":" << sp.thread << "}";
+        first = false;
+    }
+    out << "\n]}\n";
+    return finish(out, tmp, path);
+}
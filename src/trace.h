@@ -0,0 +1,94 @@
+#pragma once
+#include <atomic>
+#include <chrono>
+#include <cstdint>
+#include <cstddef>
+#include <string>
+#include <vector>
+
+/*
+ * Per-stage latency tracing, query to speech.
+ *
+ * Each stage is a TraceStage defined once at file scope; a TraceSpan
+ * on the stack times the scope it lives in:
+ *
+ *     static const TraceStage FTS("ai.fts");
+ *     ...
+ *     { TraceSpan span(FTS); ... }
+ *
+ * A finished span claims a slot in a fixed ring with one fetch_add and
+ * is written there without locks or allocation; once the ring wraps
+ * the oldest spans are overwritten. Every stage also counts its spans
+ * into a log-linear histogram (4 buckets per power of two, so within
+ * ~19%), which keeps p50/p95/p99 over the whole run.
+ *
+ * Off until traceEnable(). A span then costs one relaxed load and a
+ * branch in the constructor and a test in the destructor.
+ *
+ * traceDumpJson() writes the per-stage summary, traceDumpChrome() the
+ * spans still in the ring as Chrome trace events (chrome://tracing,
+ * ui.perfetto.dev). Both can run while spans are being recorded.
+ * Stage and thread names are code literals and are written unescaped.
+ */
+
+inline std::atomic<bool> traceOn{false};
+
+inline uint64_t traceNs(std::chrono::steady_clock::time_point t){
+    return std::chrono::duration_cast<std::chrono::nanoseconds>(t.time_since_epoch()).count();
+}
+
+inline uint64_t traceNow(){ return traceNs(std::chrono::steady_clock::now()); }
+
+class TraceStage {
+public:
+    explicit TraceStage(const char* name);      // name must outlive the process
+
+    const char* name() const { return label; }
+    uint32_t    id()   const { return index; }
+
+private:
+    const char* label;
+    uint32_t    index;
+};
+
+// A span from startNs to endNs on the traceNow() clock, for stages
+// that do not map onto one scope. Callers check traceEnabled()
+void traceRecord(const TraceStage& stage, uint64_t startNs, uint64_t endNs);
+
+class TraceSpan {
+public:
+    explicit TraceSpan(const TraceStage& s)
+        : stage(s), start(traceOn.load(std::memory_order_relaxed) ? traceNow() : 0) {}
+    ~TraceSpan(){ if(start) traceRecord(stage, start, traceNow()); }
+
+    TraceSpan(const TraceSpan&)            = delete;
+    TraceSpan& operator=(const TraceSpan&) = delete;
+
+private:
+    const TraceStage& stage;
+    uint64_t          start;
+};
+
+void traceEnable(bool on);
+inline bool traceEnabled(){ return traceOn.load(std::memory_order_relaxed); }
+
+// Shown for this thread in the Chrome trace ("speech", "worker")
+void traceNameThread(const char* name);
+
+struct TraceStageStats {
+    const char* stage = "";
+    uint64_t    count = 0;
+    double      meanUs = 0, p50Us = 0, p95Us = 0, p99Us = 0, maxUs = 0;
+};
+
+struct TraceTotals {
+    uint64_t spans       = 0;     // recorded since the start
+    uint64_t overwritten = 0;     // no longer in the ring
+};
+
+// Stages with at least one span, in definition order
+std::vector<TraceStageStats> traceStats();
+TraceTotals traceTotals();
+
+bool traceDumpJson(const std::string& path);
+bool traceDumpChrome(const std::string& path);
@@ -1,14 +1,20 @@
 /*
  * ============================================================
  *  PRIMUS AI v2.0 — TTS with Litter Smoother
- *  espeak-ng → WAV → DSP chain → aplay
+ *  speak() → sentence queue → speech thread:
+ *  espeak-ng --stdout → pipe → DSP chain → AudioSink
  *
- *  DSP Chain:
+ *  No temp files and no shell: PCM is read from the synthesizer
+ *  pipe in fixed blocks and pushed through VoiceChain as it
+ *  arrives, so audio starts after the chain's look-ahead rather
+ *  than after the whole sentence.
+ *
+ *  DSP Chain (dsp_chain.cpp):
  *   1. Litter Smoother   — removes tiny noise spikes
  *   2. Gaussian Smooth   — softens harshness
  *   3. Bass Boost        — deeper male voice
  *   4. Noise Gate        — clears silence gaps
- *   5. Normalize         — consistent volume
+ *   5. Normalize         — look-ahead peak normalize
  *   6. Soft Limiter      — tanh, no clipping
  *   7. Normalize         — final level
  *   8. Fade In/Out       — removes click/pop
@@ -16,273 +22,429 @@
  */
 
 #include "tts.h"
+#include "subprocess.h"
+#include "dsp_chain.h"
+#include "dsp_kernels.h"
+#include "trace.h"
+
 #include <iostream>
-#include <fstream>
 #include <vector>
-#include <cmath>
 #include <cstdlib>
+#include <cstring>
+#include <cstdint>
 #include <algorithm>
-#include <numeric>
+#include <chrono>
+#include <unistd.h>
+#include <csignal>
 
 using namespace std;
 
 #define SAMPLE_RATE 22050
+#define BLOCK_SIZE  256
+
+/* ===== TRACE STAGES ===== */
+
+static const TraceStage TRACE_ENQUEUE    ("tts.enqueue");      // incl. waiting for queue room
+static const TraceStage TRACE_SPAWN      ("tts.spawn");
+static const TraceStage TRACE_PLAY       ("tts.play");         // one sentence through espeak-ng
+static const TraceStage TRACE_CACHED     ("tts.cached");       // one sentence from memory
+static const TraceStage TRACE_READ       ("tts.read");         // blocked on the espeak-ng pipe
+static const TraceStage TRACE_DSP        ("tts.dsp");
+static const TraceStage TRACE_SINK       ("tts.sink");
+static const TraceStage TRACE_FIRST_AUDIO("tts.first_audio");  // speak() → first sample out
+static const TraceStage TRACE_SPOKEN     ("tts.spoken");       // speak() → last sample out
 
 /* =========================
    CONSTRUCTOR
 ========================= */
 
 TTS::TTS(float g, int s, int p){
-    gain  = g;
-    speed = s;
-    pitch = p;
+    gain   = g;
+    speed  = s;
+    pitch  = p;
+    sink   = makeAudioSink("aplay");
+    cache  = make_unique<PhraseCache>();
+    worker = thread(&TTS::run, this);
+}
+
+TTS::~TTS(){
+    cancel();
+    {
+        lock_guard<mutex> g(lock);
+        stopping = true;
+    }
+    changed.notify_all();
+    worker.join();
+}
+
+void TTS::setSink(unique_ptr<AudioSink> s){
+    cancel();
+    flush();
+    lock_guard<mutex> g(lock);
+    sink = move(s);
 }
 
 void TTS::setTone(float g, int s, int p){
+    lock_guard<mutex> l(lock);
     gain  = g;
     speed = s;
     pitch = p;
 }
 
-/* =========================
-   READ WAV
-========================= */
-
-static vector<double> readWav(const string& filename){
-    ifstream file(filename, ios::binary);
-    if(!file) return {};
-    file.seekg(44);
-    vector<double> samples;
-    int16_t s;
-    while(file.read(reinterpret_cast<char*>(&s), sizeof(s)))
-        samples.push_back(s / 32768.0);
-    return samples;
+void TTS::onSpoken(function<void(const SpeakStats&)> cb){
+    lock_guard<mutex> g(lock);
+    spoken = move(cb);
 }
 
-/* =========================
-   WRITE WAV
-========================= */
+void TTS::setCache(unique_ptr<PhraseCache> c){
+    cancel();
+    flush();
+    lock_guard<mutex> g(lock);
+    cache = move(c);
+}
 
-static void writeWav(const string& filename, const vector<double>& samples){
-    fstream file(filename, ios::in | ios::out | ios::binary);
-    if(!file) return;
-    file.seekp(44);
-    for(double s : samples){
-        s = max(-1.0, min(1.0, s));
-        int16_t out = static_cast<int16_t>(s * 32767);
-        file.write(reinterpret_cast<char*>(&out), sizeof(out));
-    }
-    file.close();
+PhraseCacheStats TTS::cacheStats() const {
+    lock_guard<mutex> g(lock);
+    return cache ? cache->stats() : PhraseCacheStats();
 }
 
 /* =========================
-   0. LITTER SMOOTHER
-   Removes tiny random noise
-   spikes (litter) that are
-   shorter than minDuration
-   samples and smaller than
-   threshold — without
-   touching the real voice.
-
-   Algorithm:
-   - Scan for isolated spikes
-   - If spike width < window
-     AND neighbors are near 0
-     → zero it out (it's litter)
-   - Real voice has sustained
-     energy so it passes through
+   SENTENCES
+   Split after । ॥ ? ! and
+   line breaks, so the first
+   sentence plays while the
+   rest synthesize
 ========================= */
 
-static vector<double> litterSmoother(const vector<double>& in,
-                                      int    window    = 8,
-                                      double threshold = 0.04)
-{
-    vector<double> out = in;
-    int n = in.size();
-
-    for(int i = window; i < n - window; i++){
-
-        double cur = fabs(in[i]);
-
-        // Only look at samples above threshold
-        if(cur < threshold) continue;
-
-        // Check if neighbors (window samples each side) are quiet
-        double leftEnergy  = 0.0;
-        double rightEnergy = 0.0;
-
-        for(int j = 1; j <= window; j++){
-            leftEnergy  += fabs(in[i - j]);
-            rightEnergy += fabs(in[i + j]);
+static vector<string> splitSentences(const string& text){
+    static const char* ENDS[] = { "।", "॥", "?", "!", "\n" };
+    vector<string> out;
+    string cur;
+    auto push = [&]{
+        size_t a = cur.find_first_not_of(" \t\r\n");
+        size_t b = cur.find_last_not_of(" \t\r\n");
+        string t = a == string::npos ? "" : cur.substr(a, b - a + 1);
+        bool   marksOnly = true;
+        for(size_t i = 0; i < t.size() && marksOnly; ){
+            size_t len = 0;
+            for(const char* e : ENDS)
+                if(t.compare(i, strlen(e), e) == 0){ len = strlen(e); break; }
+            if(len == 0) marksOnly = false;
+            i += len;
         }
-
-        leftEnergy  /= window;
-        rightEnergy /= window;
-
-        // If both sides are near silence → isolated spike = litter
-        if(leftEnergy < threshold * 0.5 &&
-           rightEnergy < threshold * 0.5)
-        {
-            // Smooth it out with neighbors instead of hard zero
-            out[i] = (in[i-1] + in[i+1]) * 0.5;
+        // "उत्तर।। बढ़िया" must not queue a lone "।"
+        if(!marksOnly) out.push_back(t);
+        cur.clear();
+    };
+    for(size_t i = 0; i < text.size(); ){
+        size_t len = 0;
+        for(const char* e : ENDS)
+            if(text.compare(i, strlen(e), e) == 0){ len = strlen(e); break; }
+        if(len){
+            cur.append(text, i, len);
+            push();
+            i += len;
+        } else {
+            cur += text[i++];
         }
     }
-
+    push();
     return out;
 }
 
 /* =========================
-   1. GAUSSIAN SMOOTH
-   Removes harshness
+   QUEUE
 ========================= */
 
-static vector<double> gaussianSmooth(const vector<double>& in, int radius = 2){
-    int n = in.size();
-    vector<double> out = in;
+void TTS::speak(const string& text){
+    enqueue(splitSentences(text), nullptr);
+}
 
-    vector<double> kernel(2*radius+1);
-    double sigma = radius / 2.0;
-    double sum   = 0;
-    for(int i = -radius; i <= radius; i++){
-        kernel[i+radius] = exp(-(i*i)/(2.0*sigma*sigma));
-        sum += kernel[i+radius];
+void TTS::speakAnswer(const string& text, long long answerId, size_t answerLen){
+    shared_ptr<const AnswerAudio> store;
+    {
+        lock_guard<mutex> g(lock);
+        store = answers;
     }
-    for(auto& k : kernel) k /= sum;
-
-    for(int i = radius; i < n - radius; i++){
-        double val = 0;
-        for(int j = -radius; j <= radius; j++)
-            val += in[i+j] * kernel[j+radius];
-        out[i] = val;
+    shared_ptr<const CachedPhrase> lead;
+    if(store && answerId >= 0 && answerLen <= text.size())
+        lead = store->find(answerId, text.substr(0, answerLen));
+    if(!lead){
+        speak(text);
+        return;
     }
-    return out;
+    enqueue(splitSentences(text.substr(answerLen)), lead);
 }
 
-/* =========================
-   2. BASS BOOST
-   Deeper male voice
-========================= */
+bool TTS::setAnswerAudio(shared_ptr<const AnswerAudio> store){
+    lock_guard<mutex> g(lock);
+    AnswerVoice mine = { gain, speed, pitch };
+    answers = (store && store->voice() == mine) ? store : nullptr;
+    return answers != nullptr;
+}
 
-static vector<double> bassBoost(const vector<double>& in, double amount = 0.28){
-    vector<double> lowpass = in;
-    double alpha = 0.15;
-    for(size_t i = 1; i < in.size(); i++)
-        lowpass[i] = alpha * in[i] + (1.0 - alpha) * lowpass[i-1];
-    vector<double> out(in.size());
-    for(size_t i = 0; i < in.size(); i++)
-        out[i] = in[i] + amount * lowpass[i];
-    return out;
+// lead = audio already rendered for the start of the answer
+void TTS::enqueue(const vector<string>& parts, shared_ptr<const CachedPhrase> lead){
+    TraceSpan span(TRACE_ENQUEUE);
+    auto queued = Clock::now();
+    size_t total = parts.size() + (lead ? 1 : 0);
+
+    unique_lock<mutex> l(lock);
+    unsigned gen = generation;
+    for(size_t i = 0; i < total; i++){
+        changed.wait(l, [&]{ return queue.size() < MAX_QUEUE || generation != gen; });
+        if(generation != gen) return;            // cancelled while waiting
+        Utterance u;
+        u.gain   = gain;
+        u.speed  = speed;
+        u.pitch  = pitch;
+        u.queued = queued;
+        u.first  = i == 0;
+        u.last   = i + 1 == total;
+        if(lead && i == 0){
+            u.prepared = true;
+            u.cached   = lead;
+        } else {
+            u.text = parts[i - (lead ? 1 : 0)];
+        }
+        queue.push_back(move(u));
+        changed.notify_all();
+    }
 }
 
-/* =========================
-   3. NOISE GATE
-   Cuts silence hiss
-========================= */
+void TTS::cancel(){
+    {
+        lock_guard<mutex> g(lock);
+        for(auto& u : queue) terminate(u.synth);
+        queue.clear();
+        generation++;
+        if(sink) sink->interrupt();
+    }
+    changed.notify_all();
+}
 
-static vector<double> noiseGate(const vector<double>& in, double threshold = 0.012){
-    vector<double> out = in;
-    for(size_t i = 0; i < in.size(); i++)
-        if(fabs(in[i]) < threshold)
-            out[i] = 0.0;
-    return out;
+void TTS::flush(){
+    unique_lock<mutex> l(lock);
+    changed.wait(l, [&]{ return queue.empty() && !playing; });
 }
 
-/* =========================
-   4. NORMALIZE
-========================= */
+bool TTS::startSynth(Utterance& u){
+    TraceSpan span(TRACE_SPAWN);
+    return spawnReader({ "espeak-ng", "-v", "hi",
+                         "-s", to_string(u.speed),
+                         "-p", to_string(u.pitch),
+                         "-a", "180", "-g", "6",
+                         "--stdout", "--", u.text }, u.synth);
+}
 
-static vector<double> normalize(const vector<double>& in, double target = 0.92){
-    double peak = 0.0;
-    for(double s : in) peak = max(peak, fabs(s));
-    if(peak < 1e-9) return in;
-    vector<double> out(in.size());
-    double g = target / peak;
-    for(size_t i = 0; i < in.size(); i++)
-        out[i] = in[i] * g;
-    return out;
+// Cached audio, else start espeak-ng; once per sentence, under lock
+void TTS::prepare(Utterance& u){
+    if(u.prepared) return;
+    u.prepared = true;
+    if(cache) u.cached = cache->find(u.key());
+    if(!u.cached && !startSynth(u))
+        cerr << "TTS: espeak-ng not available\n";
 }
 
 /* =========================
-   5. SOFT LIMITER
-   tanh saturation, no clip
+   SPEECH THREAD
 ========================= */
 
-static vector<double> softLimit(const vector<double>& in, double drive = 1.8){
-    vector<double> out(in.size());
-    double td = tanh(drive);
-    for(size_t i = 0; i < in.size(); i++)
-        out[i] = tanh(drive * in[i]) / td;
-    return out;
+void TTS::run(){
+    traceNameThread("speech");
+    while(true){
+        Utterance u;
+        unsigned  gen;
+        {
+            unique_lock<mutex> l(lock);
+            changed.wait(l, [&]{ return stopping || !queue.empty(); });
+            if(stopping) break;
+            u   = move(queue.front());
+            queue.pop_front();
+            gen = generation;
+            playing = true;
+
+            prepare(u);
+            // Next sentence synthesizes while this one plays
+            if(!queue.empty()) prepare(queue.front());
+        }
+        changed.notify_all();                    // room in the queue
+
+        bool done = u.cached          ? playCached(u, gen)
+                  : u.synth.running() ? play(u, gen)
+                  : false;
+
+        bool idle;
+        {
+            lock_guard<mutex> g(lock);
+            idle = queue.empty() || generation != gen;
+        }
+        // Draining takes as long as the audio still buffered: outside
+        // the lock, so cancel() can interrupt it. playing stays set,
+        // so setSink() waits for it.
+        if(idle && sinkOpen){
+            sink->close();
+            sinkOpen = false;
+        }
+
+        function<void(const SpeakStats&)> cb;
+        {
+            lock_guard<mutex> g(lock);
+            if(done && u.last){
+                auto now = Clock::now();
+                stats.totalMs = chrono::duration<double, milli>(now - u.queued).count();
+                if(traceEnabled()) traceRecord(TRACE_SPOKEN, traceNs(u.queued), traceNs(now));
+                if(stats.samples > 0) cb = spoken;
+            }
+            playing = !queue.empty();
+        }
+        if(cb) cb(stats);
+        changed.notify_all();
+    }
 }
 
 /* =========================
-   6. FADE IN/OUT
-   Removes click at edges
+   WAV STREAM HEADER
+   Skips RIFF chunks up to
+   "data"; returns bytes
+   consumed, 0 = need more
 ========================= */
 
-static vector<double> fadeInOut(const vector<double>& in, int fadeMs = 15){
-    vector<double> out = in;
-    int fadeSamples = (SAMPLE_RATE * fadeMs) / 1000;
-    fadeSamples = min(fadeSamples, (int)in.size() / 4);
-    for(int i = 0; i < fadeSamples; i++){
-        double env = (double)i / fadeSamples;
-        out[i]                  *= env;
-        out[out.size()-1-i]     *= env;
+static size_t parseWavHeader(const vector<unsigned char>& b, int& rate){
+    if(b.size() < 12) return 0;
+    if(memcmp(b.data(), "RIFF", 4) != 0 || memcmp(b.data() + 8, "WAVE", 4) != 0)
+        return SIZE_MAX;
+
+    size_t pos = 12;
+    while(pos + 8 <= b.size()){
+        uint32_t size = b[pos+4] | (b[pos+5] << 8) | (b[pos+6] << 16) | ((uint32_t)b[pos+7] << 24);
+        if(memcmp(b.data() + pos, "data", 4) == 0)
+            return pos + 8;                      // size is bogus on a pipe
+        if(memcmp(b.data() + pos, "fmt ", 4) == 0){
+            if(pos + 16 > b.size()) return 0;
+            rate = b[pos+12] | (b[pos+13] << 8) | (b[pos+14] << 16) | ((uint32_t)b[pos+15] << 24);
+        }
+        pos += 8 + size + (size & 1);
     }
-    return out;
+    return 0;
 }
 
 /* =========================
-   PROCESS WAV — Full chain
+   OUTPUT
+   One place opens the sink
+   and keeps the stats
 ========================= */
 
-void TTS::processWav(const string& filename){
-
-    vector<double> samples = readWav(filename);
-    if(samples.empty()) return;
-
-    // Full DSP chain
-    samples = litterSmoother(samples, 8,   0.04);  // 0. litter smoother
-    samples = gaussianSmooth(samples, 2);           // 1. smooth harshness
-    samples = bassBoost     (samples, 0.28);        // 2. deeper voice
-    samples = noiseGate     (samples, 0.012);       // 3. kill hiss
-    samples = normalize     (samples, 0.90);        // 4. normalize
-    samples = softLimit     (samples, 1.8);         // 5. soft limit
-    samples = normalize     (samples, 0.92);        // 6. final normalize
-    samples = fadeInOut     (samples, 15);          // 7. clean edges
+bool TTS::write(const int16_t* pcm, size_t n, int rate, const Utterance& u){
+    if(n == 0) return true;
+    if(!sinkOpen) sinkOpen = sink && sink->open(rate);
+    if(!sinkOpen) return false;
+    if(stats.samples == 0){
+        auto now = Clock::now();
+        stats.firstAudioMs = chrono::duration<double, milli>(now - u.queued).count();
+        if(traceEnabled()) traceRecord(TRACE_FIRST_AUDIO, traceNs(u.queued), traceNs(now));
+    }
+    stats.samples += n;
+    TraceSpan span(TRACE_SINK);
+    return sink->write(pcm, n);
+}
 
-    writeWav(filename, samples);
+bool TTS::playCached(Utterance& u, unsigned gen){
+    TraceSpan span(TRACE_CACHED);
+    if(u.first) stats = SpeakStats();
+    const CachedPhrase& p = *u.cached;
+    for(size_t at = 0; at < p.samples; at += 4096){
+        if(generation != gen) return false;
+        write(p.pcm + at, min<size_t>(4096, p.samples - at), p.rate, u);
+    }
+    return generation == gen;
 }
 
 /* =========================
-   SPEAK
+   PLAY
+   espeak-ng writes WAV to
+   a pipe; every block goes
+   through the chain and on
+   to the sink immediately.
+   Returns false if cancelled
 ========================= */
 
-void TTS::speak(const string& text){
-
-    string safeText = text;
-    for(char& c : safeText)
-        if(c == '"' || c == '`') c = '\'';
-
-    string wavFile = "/tmp/primus_tts.wav";
-
-    string cmd =
-        "espeak-ng -v hi"
-        " -s " + to_string(speed) +
-        " -p " + to_string(pitch) +
-        " -a 180"
-        " -g 6"
-        " -w " + wavFile +
-        " \"" + safeText + "\" 2>/dev/null";
-
-    system(cmd.c_str());
-
-    processWav(wavFile);
+bool TTS::play(Utterance& u, unsigned gen){
+    TraceSpan span(TRACE_PLAY);
+
+    if(u.first) stats = SpeakStats();
+    Subprocess& synth = u.synth;
+
+    int    rate       = SAMPLE_RATE;
+    bool   headerDone = false;
+    size_t rawUsed    = 0;
+    size_t fill       = 0;
+    vector<unsigned char> raw;
+    vector<float>         block(BLOCK_SIZE);
+    vector<int16_t>       in16(BLOCK_SIZE), pcm;   // pcm = whole sentence, for the cache
+    const DspKernels&     k = dspKernels();
+
+    chain.reset();
+
+    auto process = [&](size_t n){
+        TraceSpan span(TRACE_DSP);
+        return chain.process(block.data(), n);
+    };
+    auto emit = [&](const float* s, size_t n){
+        size_t at = pcm.size();
+        pcm.resize(at + n);
+        k.floatToS16(s, pcm.data() + at, n);
+        write(pcm.data() + at, n, rate, u);
+    };
+
+    unsigned char buf[8192];
+    auto next = [&]{
+        TraceSpan span(TRACE_READ);
+        return read(synth.fd, buf, sizeof(buf));
+    };
+    ssize_t n;
+    while((n = next()) > 0){
+        if(generation != gen){
+            terminate(synth);
+            return false;
+        }
+        raw.insert(raw.end(), buf, buf + n);
+
+        if(!headerDone){
+            size_t used = parseWavHeader(raw, rate);
+            if(used == SIZE_MAX) break;          // not a WAV stream
+            if(used == 0) continue;
+            rawUsed    = used;
+            headerDone = true;
+        }
 
-    string playCmd =
-        "aplay -q -f S16_LE -r " +
-        to_string(SAMPLE_RATE) +
-        " -c 1 " + wavFile + " 2>/dev/null";
+        // espeak-ng writes S16_LE; the Pi and x86 hosts are little-endian
+        while(rawUsed + 1 < raw.size()){
+            size_t take = min(BLOCK_SIZE - fill, (raw.size() - rawUsed) / 2);
+            memcpy(in16.data(), raw.data() + rawUsed, take * 2);
+            k.s16ToFloat(in16.data(), block.data() + fill, take);
+            rawUsed += take * 2;
+            fill    += take;
+            if(fill == BLOCK_SIZE){
+                emit(block.data(), process(fill));
+                fill = 0;
+            }
+        }
+        raw.erase(raw.begin(), raw.begin() + rawUsed);
+        rawUsed = 0;
+    }
+    bool clean = finish(synth) == 0;             // a killed synth leaves a partial sentence
+
+    size_t done = process(fill);
+    emit(block.data(), done);
+    block.clear();
+    {
+        TraceSpan span(TRACE_DSP);
+        chain.flush(block);
+    }
+    emit(block.data(), block.size());
 
-    system(playCmd.c_str());
-}
\ No newline at end of file
+    if(generation != gen) return false;
+    if(cache && headerDone && clean) cache->insert(u.key(), rate, move(pcm));
+    return true;
+}
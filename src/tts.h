@@ -1,15 +1,112 @@
 #pragma once
 #include <string>
+#include <vector>
+#include <memory>
+#include <deque>
+#include <mutex>
+#include <condition_variable>
+#include <thread>
+#include <atomic>
+#include <chrono>
+#include <functional>
 
+#include "audio_sink.h"
+#include "dsp_chain.h"
+#include "subprocess.h"
+#include "phrase_cache.h"
+#include "answer_audio.h"
+
+struct SpeakStats {
+    double firstAudioMs = 0;   // speak() → first block handed to the sink
+    double totalMs      = 0;   // speak() → last sentence written (sink closed if idle)
+    size_t samples      = 0;
+};
+
+/*
+ * Speech runs on its own thread. speak() splits the text into
+ * sentences, queues them and returns; the worker plays them in order
+ * and starts the next sentence's espeak-ng while the current one is
+ * still playing. cancel() is the barge-in path for a new query.
+ */
 class TTS {
 public:
     TTS(float gain = 1.0, int speed = 130, int pitch = 22);
+    ~TTS();
+    TTS(const TTS&) = delete;
+    TTS& operator=(const TTS&) = delete;
+
+    // Blocks only while the queue is full
     void speak(const std::string& text);
+    // text starts with the knowledge answer `answerId` (answerLen
+    // bytes); pre-rendered audio plays for it and only the rest is
+    // synthesized. Falls back to speak(text).
+    void speakAnswer(const std::string& text, long long answerId, size_t answerLen);
+    // Stops the current sentence and drops everything queued
+    void cancel();
+    // Returns once everything queued has played
+    void flush();
     void setTone(float gain, int speed, int pitch);
 
+    // Default is aplay; see makeAudioSink() for the others.
+    // Cancels anything queued on the old sink.
+    void setSink(std::unique_ptr<AudioSink> sink);
+    // Called on the speech thread after each answer plays in full
+    void onSpoken(std::function<void(const SpeakStats&)> cb);
+
+    // Finished sentences are cached by text + voice; default is a
+    // 16 MiB memory-only cache, nullptr disables it
+    void setCache(std::unique_ptr<PhraseCache> cache);
+    PhraseCacheStats cacheStats() const;
+
+    // Store from primus_prerender; ignored unless rendered with this
+    // voice. Returns whether it will be used.
+    bool setAnswerAudio(std::shared_ptr<const AnswerAudio> store);
+
 private:
+    using Clock = std::chrono::steady_clock;
+
+    struct Utterance {
+        std::string       text;
+        float             gain;
+        int               speed, pitch;
+        Clock::time_point queued;
+        bool              first, last;   // sentence position in its answer
+        bool              prepared = false;
+        std::shared_ptr<const CachedPhrase> cached;   // or:
+        Subprocess        synth;         // espeak-ng, once started
+
+        PhraseKey key() const { return { text, gain, speed, pitch }; }
+    };
+
+    static const size_t MAX_QUEUE = 32;  // sentences
+
     float gain;
     int   speed;
     int   pitch;
-    void  processWav(const std::string& filename);
+    std::unique_ptr<AudioSink> sink;
+    std::unique_ptr<PhraseCache> cache;
+    std::shared_ptr<const AnswerAudio> answers;
+    std::function<void(const SpeakStats&)> spoken;
+
+    // Speech thread only
+    VoiceChain chain;
+    SpeakStats stats;
+    bool       sinkOpen = false;
+
+    mutable std::mutex      lock;
+    std::condition_variable changed;
+    std::deque<Utterance>   queue;
+    bool                    playing  = false;
+    bool                    stopping = false;
+    std::atomic<unsigned>   generation{0};   // bumped by cancel()
+    std::thread             worker;
+
+    void enqueue(const std::vector<std::string>& parts,
+                 std::shared_ptr<const CachedPhrase> lead);
+    void run();
+    void prepare(Utterance& u);
+    bool play(Utterance& u, unsigned gen);
+    bool playCached(Utterance& u, unsigned gen);
+    bool write(const int16_t* pcm, size_t n, int rate, const Utterance& u);
+    static bool startSynth(Utterance& u);
 };